@@ -0,0 +1,133 @@
+#include "application/context_assembler.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace colabb {
+namespace application {
+
+ContextAssembler::ContextAssembler(size_t threads, std::chrono::milliseconds deadline)
+    : deadline_(deadline) {
+    for (size_t i = 0; i < std::max<size_t>(1, threads); ++i) {
+        workers_.emplace_back(&ContextAssembler::worker_loop, this);
+    }
+}
+
+ContextAssembler::~ContextAssembler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void ContextAssembler::add_provider(ProviderPtr provider) {
+    if (!provider) {
+        return;
+    }
+    auto registered = std::make_shared<Registered>();
+    registered->name = provider->name();
+    registered->provider = std::move(provider);
+    std::lock_guard<std::mutex> lock(mutex_);
+    providers_.push_back(std::move(registered));
+}
+
+void ContextAssembler::set_deadline(std::chrono::milliseconds deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    deadline_ = deadline;
+}
+
+std::vector<std::string> ContextAssembler::provider_names() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    for (const auto& registered : providers_) {
+        names.push_back(registered->name);
+    }
+    return names;
+}
+
+ContextAssembler::Result ContextAssembler::assemble(const domain::ContextRequest& request) {
+    std::vector<std::shared_ptr<Registered>> providers;
+    std::chrono::milliseconds deadline;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        providers = providers_;
+        deadline = deadline_;
+    }
+    const auto until = std::chrono::steady_clock::now() + deadline;
+
+    auto batch = std::make_shared<Batch>();
+    batch->sections.resize(providers.size());
+    batch->done.resize(providers.size(), false);
+    auto shared_request = std::make_shared<const domain::ContextRequest>(request);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < providers.size(); ++i) {
+            // Still stuck on an earlier request: counts as missed
+            if (providers[i]->busy.exchange(true)) continue;
+            {
+                std::lock_guard<std::mutex> batch_lock(batch->mutex);
+                ++batch->remaining;
+            }
+            tasks_.push_back([registered = providers[i], batch, shared_request, i] {
+                std::string section;
+                try {
+                    section = registered->provider->provide(*shared_request);
+                } catch (const std::exception& e) {
+                    std::cerr << "Context provider " << registered->name << " failed: " << e.what() << std::endl;
+                } catch (...) {
+                    std::cerr << "Context provider " << registered->name << " failed" << std::endl;
+                }
+                registered->busy = false;
+
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->sections[i] = std::move(section);
+                batch->done[i] = true;
+                if (--batch->remaining == 0) {
+                    batch->cv.notify_all();
+                }
+            });
+        }
+    }
+    cv_.notify_all();
+
+    Result result;
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->cv.wait_until(lock, until, [&batch] { return batch->remaining == 0; });
+    for (size_t i = 0; i < providers.size(); ++i) {
+        if (!batch->done[i]) {
+            result.missed.push_back(providers[i]->name);
+            continue;
+        }
+        std::string& section = batch->sections[i];
+        while (!section.empty() && section.back() == '\n') section.pop_back();
+        if (section.empty()) continue;
+        if (!result.context.empty()) result.context += "\n\n";
+        result.context += section;
+    }
+    return result;
+}
+
+void ContextAssembler::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (stop_) {
+                break;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace application
+} // namespace colabb
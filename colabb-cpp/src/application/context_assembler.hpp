@@ -0,0 +1,83 @@
+#ifndef COLABB_CONTEXT_ASSEMBLER_HPP
+#define COLABB_CONTEXT_ASSEMBLER_HPP
+
+#include "domain/context/context_provider.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace colabb {
+namespace application {
+
+/**
+ * @brief Builds the prediction context from every registered provider.
+ *
+ * Providers run concurrently on a small thread pool. assemble() waits until
+ * they have all finished or the deadline passes, whichever comes first;
+ * sections that are not ready by then are left out rather than delaying
+ * the suggestion. A provider still running from an earlier request is not
+ * started again, so one that hangs costs at most one pool thread.
+ */
+class ContextAssembler {
+public:
+    using ProviderPtr = std::shared_ptr<domain::IContextProvider>;
+
+    struct Result {
+        std::string context;             // sections in registration order
+        std::vector<std::string> missed; // providers left out by the deadline
+    };
+
+    explicit ContextAssembler(size_t threads = 4,
+                              std::chrono::milliseconds deadline = std::chrono::milliseconds(100));
+    ~ContextAssembler();
+
+    ContextAssembler(const ContextAssembler&) = delete;
+    ContextAssembler& operator=(const ContextAssembler&) = delete;
+
+    void add_provider(ProviderPtr provider);
+    void set_deadline(std::chrono::milliseconds deadline);
+    std::vector<std::string> provider_names() const;
+
+    // Blocks for up to the deadline; call it off the UI thread
+    Result assemble(const domain::ContextRequest& request);
+
+private:
+    struct Registered {
+        ProviderPtr provider;
+        std::string name;
+        std::atomic<bool> busy{false};
+    };
+
+    // Results of one assemble() call, shared with its tasks so a late
+    // provider can still report into it after the caller has moved on
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::string> sections;
+        std::vector<bool> done;
+        size_t remaining = 0;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<Registered>> providers_;
+    std::chrono::milliseconds deadline_;
+
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+
+    void worker_loop();
+};
+
+} // namespace application
+} // namespace colabb
+
+#endif // COLABB_CONTEXT_ASSEMBLER_HPP
@@ -0,0 +1,228 @@
+#include "application/context_providers.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace colabb {
+namespace application {
+
+namespace {
+
+constexpr std::streamoff kHistoryTailBytes = 16 * 1024;
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    const auto end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+// stamp changes with the mtime or the size (appends within one tick)
+bool file_exists(const std::string& path, std::int64_t* stamp = nullptr) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    if (stamp) {
+        *stamp = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec +
+                 static_cast<std::int64_t>(st.st_size);
+    }
+    return true;
+}
+
+std::string read_tail(const std::string& path, std::streamoff max_bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return "";
+    const std::streamoff size = file.tellg();
+    const std::streamoff start = std::max<std::streamoff>(0, size - max_bytes);
+    file.seekg(start);
+    std::string content(static_cast<size_t>(size - start), '\0');
+    file.read(&content[0], static_cast<std::streamsize>(content.size()));
+    if (start > 0) {
+        // Drop the partial first line
+        const auto newline = content.find('\n');
+        content.erase(0, newline == std::string::npos ? content.size() : newline + 1);
+    }
+    return content;
+}
+
+} // namespace
+
+ProjectContextProvider::ProjectContextProvider(infrastructure::ContextService& context)
+    : context_(context) {}
+
+std::string ProjectContextProvider::provide(const domain::ContextRequest& request) {
+    return *context_.get_cached_context_prompt(request.cwd);
+}
+
+DirectoryListingProvider::DirectoryListingProvider(infrastructure::DirectoryCache& directories, size_t max_names)
+    : directories_(directories)
+    , max_names_(max_names) {}
+
+std::string DirectoryListingProvider::provide(const domain::ContextRequest& request) {
+    auto listing = directories_.get(request.cwd);
+    if (!listing) {
+        return "";
+    }
+
+    std::string section = "Directory Listing:\n";
+    size_t shown = 0;
+    size_t hidden = 0;
+    for (const auto& entry : listing->entries) {
+        if (entry.name[0] == '.') continue;
+        if (shown == max_names_) {
+            ++hidden;
+            continue;
+        }
+        if (shown > 0) section += "  ";
+        section += entry.name;
+        if (entry.type == infrastructure::DirectoryCache::Type::Directory) section += '/';
+        ++shown;
+    }
+    if (shown == 0) {
+        return "";
+    }
+    if (hidden > 0 || listing->truncated) {
+        section += "  (+" + std::to_string(hidden) + (listing->truncated ? "+ more)" : " more)");
+    }
+    return section;
+}
+
+ShellHistoryProvider::ShellHistoryProvider(std::string history_path, size_t max_commands)
+    : history_path_(std::move(history_path))
+    , max_commands_(max_commands) {}
+
+std::string ShellHistoryProvider::resolve_history_path() const {
+    if (!history_path_.empty()) return history_path_;
+    if (const char* histfile = std::getenv("HISTFILE")) {
+        if (file_exists(histfile)) return histfile;
+    }
+    const char* home = std::getenv("HOME");
+    if (!home) return "";
+    for (const char* name : {"/.bash_history", "/.zsh_history", "/.local/share/fish/fish_history"}) {
+        const std::string path = std::string(home) + name;
+        if (file_exists(path)) return path;
+    }
+    return "";
+}
+
+std::vector<std::string> ShellHistoryProvider::parse_history(const std::string& content, size_t max_commands) {
+    std::vector<std::string> commands;
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::string command;
+        if (line.rfind("- cmd: ", 0) == 0) {
+            command = line.substr(7); // fish
+        } else if (line.rfind(": ", 0) == 0 && line.find(';') != std::string::npos) {
+            command = line.substr(line.find(';') + 1); // zsh extended history
+        } else if (line.empty() || line[0] == ' ' ||
+                   (line[0] == '#' && line.size() > 1 && std::isdigit(static_cast<unsigned char>(line[1])))) {
+            continue; // fish metadata, bash timestamps
+        } else {
+            command = line;
+        }
+        command = trim(command);
+        if (command.empty() || (!commands.empty() && commands.back() == command)) continue;
+        commands.push_back(std::move(command));
+    }
+    if (commands.size() > max_commands) {
+        commands.erase(commands.begin(), commands.end() - static_cast<long>(max_commands));
+    }
+    return commands;
+}
+
+std::string ShellHistoryProvider::provide(const domain::ContextRequest&) {
+    const std::string path = resolve_history_path();
+    std::int64_t stamp = -1;
+    if (path.empty() || !file_exists(path, &stamp)) {
+        return "";
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (path == cached_path_ && stamp == cached_stamp_) {
+            return cached_section_;
+        }
+    }
+
+    std::string section;
+    const auto commands = parse_history(read_tail(path, kHistoryTailBytes), max_commands_);
+    if (!commands.empty()) {
+        section = "Recent Commands:\n";
+        for (const auto& command : commands) {
+            section += "- " + command + "\n";
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    cached_path_ = path;
+    cached_stamp_ = stamp;
+    cached_section_ = section;
+    return section;
+}
+
+RecentErrorsProvider::RecentErrorsProvider(size_t max_lines)
+    : max_lines_(max_lines) {}
+
+std::string RecentErrorsProvider::provide(const domain::ContextRequest& request) {
+    static const char* kPatterns[] = {
+        "error", "failed", "fatal", "not found", "no such file", "permission denied",
+        "traceback", "exception", "segmentation fault", "command not found",
+    };
+
+    std::vector<std::string> errors;
+    std::istringstream stream(request.terminal_output);
+    std::string line;
+    while (std::getline(stream, line)) {
+        const std::string lower = lowercase(line);
+        const bool matches = std::any_of(std::begin(kPatterns), std::end(kPatterns),
+                                         [&lower](const char* pattern) { return lower.find(pattern) != std::string::npos; });
+        line = trim(line);
+        if (matches && !line.empty() && std::find(errors.begin(), errors.end(), line) == errors.end()) {
+            errors.push_back(line);
+        }
+    }
+    if (errors.empty()) {
+        return "";
+    }
+    if (errors.size() > max_lines_) {
+        errors.erase(errors.begin(), errors.end() - static_cast<long>(max_lines_));
+    }
+
+    std::string section = "Recent Errors:\n";
+    for (const auto& error : errors) {
+        section += "- " + error + "\n";
+    }
+    return section;
+}
+
+std::string LastFailureProvider::provide(const domain::ContextRequest& request) {
+    if (request.failed_command.empty()) {
+        return "";
+    }
+    std::string section = "Last Failed Command (exit status " + std::to_string(request.failed_exit_code) +
+                          "):\n$ " + request.failed_command + "\n" + request.failed_output;
+    if (!request.failed_output.empty() && request.failed_output.back() != '\n') {
+        section += '\n';
+    }
+    return section;
+}
+
+std::string TerminalOutputProvider::provide(const domain::ContextRequest& request) {
+    if (trim(request.terminal_output).empty()) {
+        return "";
+    }
+    return "Recent Terminal Output:\n" + request.terminal_output;
+}
+
+} // namespace application
+} // namespace colabb
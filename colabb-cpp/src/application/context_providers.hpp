@@ -0,0 +1,97 @@
+#ifndef COLABB_CONTEXT_PROVIDERS_HPP
+#define COLABB_CONTEXT_PROVIDERS_HPP
+
+#include "domain/context/context_provider.hpp"
+#include "infrastructure/context/context_service.hpp"
+#include "infrastructure/filesystem/directory_cache.hpp"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace colabb {
+namespace application {
+
+/**
+ * @brief Built-in context providers registered with the ContextAssembler.
+ *
+ * Each renders one prompt section from memory or from a small, cached file
+ * read, so all of them normally finish well within the assembly deadline.
+ */
+
+// Project name, build markers, git state and toolchain from ContextService
+// (detected on its prefetch thread; a miss yields the name-only prompt)
+class ProjectContextProvider : public domain::IContextProvider {
+public:
+    explicit ProjectContextProvider(infrastructure::ContextService& context);
+    std::string name() const override { return "project"; }
+    std::string provide(const domain::ContextRequest& request) override;
+
+private:
+    infrastructure::ContextService& context_;
+};
+
+// Names in the cwd, from the DirectoryCache listing only
+class DirectoryListingProvider : public domain::IContextProvider {
+public:
+    explicit DirectoryListingProvider(infrastructure::DirectoryCache& directories, size_t max_names = 40);
+    std::string name() const override { return "directory"; }
+    std::string provide(const domain::ContextRequest& request) override;
+
+private:
+    infrastructure::DirectoryCache& directories_;
+    size_t max_names_;
+};
+
+// Last commands of the shell history file ($HISTFILE, bash, zsh or fish)
+class ShellHistoryProvider : public domain::IContextProvider {
+public:
+    // history_path overrides the lookup (tests)
+    explicit ShellHistoryProvider(std::string history_path = "", size_t max_commands = 10);
+    std::string name() const override { return "history"; }
+    std::string provide(const domain::ContextRequest& request) override;
+
+    // Commands from the tail of a history file, oldest first
+    static std::vector<std::string> parse_history(const std::string& content, size_t max_commands);
+
+private:
+    std::string history_path_;
+    size_t max_commands_;
+    std::mutex mutex_;
+    std::int64_t cached_stamp_ = -1;
+    std::string cached_path_;
+    std::string cached_section_;
+
+    std::string resolve_history_path() const;
+};
+
+// Error-looking lines of the recent terminal output
+class RecentErrorsProvider : public domain::IContextProvider {
+public:
+    explicit RecentErrorsProvider(size_t max_lines = 5);
+    std::string name() const override { return "errors"; }
+    std::string provide(const domain::ContextRequest& request) override;
+
+private:
+    size_t max_lines_;
+};
+
+// The command that just failed and its output, when shell integration
+// reported one (see TerminalWidget::commands())
+class LastFailureProvider : public domain::IContextProvider {
+public:
+    std::string name() const override { return "failure"; }
+    std::string provide(const domain::ContextRequest& request) override;
+};
+
+// The recent terminal output itself
+class TerminalOutputProvider : public domain::IContextProvider {
+public:
+    std::string name() const override { return "terminal"; }
+    std::string provide(const domain::ContextRequest& request) override;
+};
+
+} // namespace application
+} // namespace colabb
+
+#endif // COLABB_CONTEXT_PROVIDERS_HPP
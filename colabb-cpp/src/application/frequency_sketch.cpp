@@ -0,0 +1,84 @@
+#include "application/frequency_sketch.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace colabb {
+namespace application {
+
+namespace {
+constexpr uint64_t kRowSeeds[] = {
+    0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+    0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+};
+
+uint64_t mix(uint64_t x) {
+    // splitmix64 finalizer: cheap and good enough to decorrelate rows
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+}
+
+FrequencySketch::FrequencySketch(size_t expected_entries)
+    : width_mask_(0)
+    , sample_size_(0)
+    , additions_(0)
+    , resets_(0) {
+    size_t width = 16;
+    while (width < expected_entries) {
+        width <<= 1;
+    }
+    table_.assign(width * kDepth, 0);
+    width_mask_ = width - 1;
+    // Aging period as in TinyLFU: roughly 10 accesses per cached entry
+    sample_size_ = std::max<size_t>(expected_entries, 1) * 10;
+}
+
+size_t FrequencySketch::index_of(uint64_t hash, int row) const {
+    const size_t width = width_mask_ + 1;
+    return static_cast<size_t>(row) * width + (mix(hash ^ kRowSeeds[row]) & width_mask_);
+}
+
+void FrequencySketch::increment(const std::string& key) {
+    const uint64_t hash = std::hash<std::string>{}(key);
+    bool added = false;
+    for (int row = 0; row < kDepth; ++row) {
+        uint8_t& counter = table_[index_of(hash, row)];
+        if (counter < kMaxCount) {
+            ++counter;
+            added = true;
+        }
+    }
+
+    if (added && ++additions_ >= sample_size_) {
+        reset();
+    }
+}
+
+int FrequencySketch::frequency(const std::string& key) const {
+    const uint64_t hash = std::hash<std::string>{}(key);
+    uint8_t estimate = kMaxCount;
+    for (int row = 0; row < kDepth; ++row) {
+        estimate = std::min(estimate, table_[index_of(hash, row)]);
+    }
+    return estimate;
+}
+
+void FrequencySketch::clear() {
+    std::fill(table_.begin(), table_.end(), 0);
+    additions_ = 0;
+}
+
+void FrequencySketch::reset() {
+    for (auto& counter : table_) {
+        counter >>= 1;
+    }
+    additions_ /= 2;
+    ++resets_;
+}
+
+} // namespace application
+} // namespace colabb
@@ -0,0 +1,51 @@
+#ifndef COLABB_FREQUENCY_SKETCH_HPP
+#define COLABB_FREQUENCY_SKETCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace colabb {
+namespace application {
+
+/**
+ * @brief Count-min sketch used as the TinyLFU frequency filter.
+ *
+ * Four rows of saturating 4-bit counters (stored one per byte). Once the
+ * number of recorded accesses reaches the sample size every counter is
+ * halved, so stale popularity decays instead of pinning old entries forever.
+ */
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t expected_entries = 100);
+
+    // Record one access to key
+    void increment(const std::string& key);
+
+    // Estimated access count (0..15) for key
+    int frequency(const std::string& key) const;
+
+    void clear();
+
+    // Number of halvings performed so far (useful for tests/diagnostics)
+    size_t resets() const { return resets_; }
+
+private:
+    static constexpr int kDepth = 4;
+    static constexpr uint8_t kMaxCount = 15;
+
+    std::vector<uint8_t> table_;
+    size_t width_mask_;
+    size_t sample_size_;
+    size_t additions_;
+    size_t resets_;
+
+    size_t index_of(uint64_t hash, int row) const;
+    void reset();
+};
+
+} // namespace application
+} // namespace colabb
+
+#endif // COLABB_FREQUENCY_SKETCH_HPP
@@ -1,5 +1,7 @@
 #include "application/prediction_service.hpp"
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 namespace colabb {
 namespace application {
@@ -27,15 +29,38 @@ PredictionService::~PredictionService() {
 
 void PredictionService::predict_async(const std::string& query,
                                       const std::string& context,
-                                      PredictionCallback callback) {
+                                      PredictionCallback callback,
+                                      Priority priority,
+                                      OwnerId owner) {
+    predict_async(query, context,
+        [callback = std::move(callback)](std::optional<domain::Suggestion> suggestion, Outcome) {
+            callback(std::move(suggestion));
+        },
+        priority, owner);
+}
+
+void PredictionService::predict_async(const std::string& query,
+                                      const std::string& context,
+                                      OutcomeCallback callback,
+                                      Priority priority,
+                                      OwnerId owner) {
+    predict_async(query, ContextBuilder([context] { return context; }), std::move(callback), priority, owner);
+}
+
+void PredictionService::predict_async(const std::string& query,
+                                      ContextBuilder build_context,
+                                      OutcomeCallback callback,
+                                      Priority priority,
+                                      OwnerId owner) {
     // If queue size limit is reached, reject immediately
     bool rejected = false;
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
-        if (request_queue_.size() >= max_queue_size_) {
+        auto& queue = priority == Priority::Background ? background_queue_ : request_queue_;
+        if (queue.size() >= max_queue_size_) {
             rejected = true;
         } else {
-            request_queue_.push({query, context, callback});
+            queue.push_back({query, "", callback, owner, std::move(build_context)});
             queue_cv_.notify_one();
         }
     }
@@ -43,7 +68,7 @@ void PredictionService::predict_async(const std::string& query,
     if (rejected) {
         // Notify caller immediately that request was rejected
         try {
-            callback(std::nullopt);
+            callback(std::nullopt, Outcome::Rejected);
         } catch (...) {
             // Swallow to avoid exceptions crossing boundaries
         }
@@ -52,40 +77,84 @@ void PredictionService::predict_async(const std::string& query,
 
 void PredictionService::cancel_pending() {
     std::lock_guard<std::mutex> lock(queue_mutex_);
-    while (!request_queue_.empty()) {
-        request_queue_.pop();
+    request_queue_.clear();
+}
+
+void PredictionService::cancel_pending(OwnerId owner) {
+    const auto owned = [owner](const PredictionRequest& r) { return r.owner == owner; };
+    std::vector<OutcomeCallback> dropped;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        request_queue_.erase(std::remove_if(request_queue_.begin(), request_queue_.end(), owned),
+                             request_queue_.end());
+        auto first = std::stable_partition(background_queue_.begin(), background_queue_.end(),
+                                           [&owned](const PredictionRequest& r) { return !owned(r); });
+        for (auto it = first; it != background_queue_.end(); ++it) {
+            dropped.push_back(std::move(it->callback));
+        }
+        background_queue_.erase(first, background_queue_.end());
     }
+
+    // Outside the lock: a callback may queue a new request
+    for (auto& callback : dropped) {
+        try {
+            callback(std::nullopt, Outcome::Rejected);
+        } catch (...) {
+            // Swallow to avoid exceptions crossing boundaries
+        }
+    }
+}
+
+void PredictionService::set_provider(std::unique_ptr<domain::IAIProvider> provider) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    ai_provider_ = std::move(provider);
 }
 
 void PredictionService::worker_loop() {
     while (true) {
         PredictionRequest request;
+        std::shared_ptr<domain::IAIProvider> provider;
         
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             queue_cv_.wait(lock, [this] {
-                return stop_worker_ || !request_queue_.empty();
+                return stop_worker_ || !request_queue_.empty() || !background_queue_.empty();
             });
             
+            // Pending background refreshes are dropped on shutdown
             if (stop_worker_ && request_queue_.empty()) {
                 break;
             }
             
             if (!request_queue_.empty()) {
                 request = std::move(request_queue_.front());
-                request_queue_.pop();
+                request_queue_.pop_front();
+            } else if (!background_queue_.empty()) {
+                request = std::move(background_queue_.front());
+                background_queue_.pop_front();
             } else {
                 continue;
             }
+            provider = ai_provider_;
         }
         
         // Process request
+        std::optional<domain::Suggestion> suggestion;
+        Outcome outcome = Outcome::Failed;
         try {
-            auto suggestion = ai_provider_->predict(request.query, request.context);
-            request.callback(suggestion);
+            if (request.build_context) {
+                request.context = request.build_context();
+            }
+            suggestion = provider->predict(request.query, request.context);
+            outcome = suggestion ? Outcome::Suggested : Outcome::Empty;
         } catch (const std::exception& e) {
             std::cerr << "Prediction error: " << e.what() << std::endl;
-            request.callback(std::nullopt);
+        }
+
+        try {
+            request.callback(std::move(suggestion), outcome);
+        } catch (...) {
+            // Swallow to avoid exceptions crossing boundaries
         }
     }
 }
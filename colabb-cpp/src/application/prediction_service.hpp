@@ -8,14 +8,29 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
+#include <cstdint>
+#include <deque>
 
 namespace colabb {
 namespace application {
 
 class PredictionService {
 public:
+    // Why a request produced (or did not produce) a suggestion
+    enum class Outcome { Suggested, Empty, Failed, Rejected };
+
     using PredictionCallback = std::function<void(std::optional<domain::Suggestion>)>;
+    using OutcomeCallback = std::function<void(std::optional<domain::Suggestion>, Outcome)>;
+    // Produces the context on the worker thread, right before the request
+    using ContextBuilder = std::function<std::string()>;
+
+    // Background requests (e.g. cache revalidation) only run when no
+    // interactive request is waiting and survive cancel_pending().
+    enum class Priority { Interactive, Background };
+
+    // Identifies the window (or other client) that issued a request so a
+    // shared service can cancel one client's work without touching others.
+    using OwnerId = std::uint64_t;
     
     explicit PredictionService(std::unique_ptr<domain::IAIProvider> provider,
                                size_t max_queue_size = 10);
@@ -24,21 +39,46 @@ public:
     // Async prediction
     void predict_async(const std::string& query,
                       const std::string& context,
-                      PredictionCallback callback);
+                      PredictionCallback callback,
+                      Priority priority = Priority::Interactive,
+                      OwnerId owner = 0);
+    void predict_async(const std::string& query,
+                      const std::string& context,
+                      OutcomeCallback callback,
+                      Priority priority = Priority::Interactive,
+                      OwnerId owner = 0);
+    // Context gathered lazily: a request cancelled while queued never pays for it
+    void predict_async(const std::string& query,
+                      ContextBuilder build_context,
+                      OutcomeCallback callback,
+                      Priority priority = Priority::Interactive,
+                      OwnerId owner = 0);
     
-    // Cancel pending predictions
+    // Cancel pending interactive predictions
     void cancel_pending();
+    // Cancel every pending prediction issued by owner only (e.g. a window
+    // that is closing), background ones included. Dropped background
+    // requests are reported as Rejected so the caller can release whatever
+    // it kept for them; interactive ones are dropped silently.
+    void cancel_pending(OwnerId owner);
+
+    // Swap the provider (e.g. after a config change). Requests already
+    // running finish on the previous provider.
+    void set_provider(std::unique_ptr<domain::IAIProvider> provider);
     
 private:
     struct PredictionRequest {
         std::string query;
         std::string context;
-        PredictionCallback callback;
+        OutcomeCallback callback;
+        OwnerId owner = 0;
+        ContextBuilder build_context;
     };
     
-    std::unique_ptr<domain::IAIProvider> ai_provider_;
+    std::shared_ptr<domain::IAIProvider> ai_provider_;
     std::thread worker_thread_;
-    std::queue<PredictionRequest> request_queue_;
+    std::deque<PredictionRequest> request_queue_;
+    std::deque<PredictionRequest> background_queue_;
     std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
     bool stop_worker_;
@@ -0,0 +1,103 @@
+#include "application/service_container.hpp"
+#include "application/context_providers.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace colabb {
+namespace application {
+
+ServiceContainer::ServiceContainer()
+    : settings_manager_(std::make_unique<infrastructure::SettingsManager>())
+    , directory_cache_(std::make_unique<infrastructure::DirectoryCache>())
+    , context_service_(std::make_unique<infrastructure::ContextService>())
+    , suggestion_cache_(std::make_unique<SuggestionCache>(100,
+          settings_manager_->get_suggestion_fresh_ttl(),
+          settings_manager_->get_suggestion_stale_window())) {
+    context_service_->set_directory_cache(directory_cache_.get());
+    suggestion_cache_->set_negative_ttls(settings_manager_->get_negative_empty_ttl(),
+                                         settings_manager_->get_negative_failure_ttl());
+    context_assembler_ = std::make_unique<ContextAssembler>();
+    register_context_providers();
+    prediction_service_ = std::make_unique<PredictionService>(create_ai_provider());
+
+    memory_governor_ = std::make_unique<infrastructure::MemoryGovernor>(settings_manager_->get_memory_budget_bytes());
+    memory_governor_->set_rss_limit(settings_manager_->get_rss_limit_bytes());
+    memory_governor_->register_component("context_cache", kContextCachePriority,
+        [this] { return context_service_->memory_usage(); },
+        [this](size_t target) { return context_service_->trim_to(target); });
+    memory_governor_->register_component("directory_cache", kDirectoryCachePriority,
+        [this] { return directory_cache_->memory_usage(); },
+        [this](size_t target) { return directory_cache_->trim_to(target); });
+    memory_governor_->register_component("suggestion_cache", kSuggestionCachePriority,
+        [this] { return suggestion_cache_->memory_usage(); },
+        [this](size_t target) { return suggestion_cache_->trim_to(target); });
+}
+
+ServiceContainer::~ServiceContainer() = default;
+
+void ServiceContainer::reload_ai_provider() {
+    prediction_service_->set_provider(create_ai_provider());
+}
+
+void ServiceContainer::register_context_providers() {
+    // Registration order is the order of sections in the prompt
+    context_assembler_->add_provider(std::make_shared<ProjectContextProvider>(*context_service_));
+    context_assembler_->add_provider(std::make_shared<DirectoryListingProvider>(*directory_cache_));
+    if (settings_manager_->get_share_shell_history()) {
+        context_assembler_->add_provider(std::make_shared<ShellHistoryProvider>());
+    }
+    context_assembler_->add_provider(std::make_shared<RecentErrorsProvider>());
+    context_assembler_->add_provider(std::make_shared<LastFailureProvider>());
+
+    // Only plugins enabled in the settings, and only if the file still has
+    // the hash the user approved
+    const fs::path plugin_dir = settings_manager_->get_context_plugin_dir();
+    const auto enabled = settings_manager_->get_enabled_context_plugins();
+    std::vector<std::string> names;
+    for (const auto& [name, sha256] : enabled) {
+        names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names) {
+        const fs::path path = plugin_dir / fs::path(name).filename();
+        if (!infrastructure::plugins::PluginLoader::matches_sha256(path.string(), enabled.at(name))) {
+            std::cerr << "Skipping context plugin (missing or hash mismatch): " << path << std::endl;
+            continue;
+        }
+        if (auto provider = plugin_loader_.loadContextProvider(path.string(), "{}")) {
+            context_assembler_->add_provider(ContextAssembler::ProviderPtr(std::move(provider)));
+        } else {
+            std::cerr << "Skipping context plugin: " << path << std::endl;
+        }
+    }
+
+    // Terminal output last, closest to the query
+    context_assembler_->add_provider(std::make_shared<TerminalOutputProvider>());
+}
+
+std::unique_ptr<domain::IAIProvider> ServiceContainer::create_ai_provider() {
+    std::string provider = settings_manager_->get_ai_provider();
+    std::string api_key = settings_manager_->get_api_key(provider);
+    
+    domain::GenericHttpAiProvider::Config config;
+    config.api_key = api_key;
+    
+    if (provider == "openai") {
+        config.endpoint_url = "https://api.openai.com/v1/chat/completions";
+        config.model = "gpt-3.5-turbo";
+        config.system_prompt = "You are a Linux terminal expert. Return ONLY the suggested bash command, without explanations or markdown formatting.";
+    } else {
+        // Default to Groq
+        config.endpoint_url = "https://api.groq.com/openai/v1/chat/completions";
+        config.model = "llama-3.1-8b-instant";
+        config.system_prompt = "Eres un experto en terminal Linux. Devuelve SOLO el comando bash sugerido, sin explicaciones ni formato markdown.";
+    }
+    
+    return std::make_unique<domain::GenericHttpAiProvider>(config);
+}
+
+} // namespace application
+} // namespace colabb
@@ -0,0 +1,76 @@
+#ifndef COLABB_SERVICE_CONTAINER_HPP
+#define COLABB_SERVICE_CONTAINER_HPP
+
+#include "application/context_assembler.hpp"
+#include "application/prediction_service.hpp"
+#include "application/suggestion_cache.hpp"
+#include "infrastructure/config/settings_manager.hpp"
+#include "infrastructure/context/context_service.hpp"
+#include "infrastructure/filesystem/directory_cache.hpp"
+#include "infrastructure/memory/memory_governor.hpp"
+#include "infrastructure/plugins/plugin_loader.hpp"
+#include <atomic>
+#include <memory>
+
+namespace colabb {
+namespace application {
+
+/**
+ * @brief Process-wide services shared by every MainWindow.
+ *
+ * Owns a single settings writer, directory cache, context service,
+ * context assembler, suggestion cache and prediction engine (one worker thread, one HTTP
+ * connection pool), so the cost of opening another window is only its widgets and per-window state.
+ * Must outlive all windows and is only used from the GTK main thread,
+ * except for the PredictionService worker.
+ */
+class ServiceContainer {
+public:
+    ServiceContainer();
+    ~ServiceContainer();
+
+    ServiceContainer(const ServiceContainer&) = delete;
+    ServiceContainer& operator=(const ServiceContainer&) = delete;
+
+    infrastructure::SettingsManager& settings() { return *settings_manager_; }
+    infrastructure::ContextService& context() { return *context_service_; }
+    infrastructure::DirectoryCache& directories() { return *directory_cache_; }
+    ContextAssembler& context_assembler() { return *context_assembler_; }
+    PredictionService& prediction() { return *prediction_service_; }
+    SuggestionCache& suggestion_cache() { return *suggestion_cache_; }
+    infrastructure::MemoryGovernor& memory() { return *memory_governor_; }
+
+    // Trim priorities: lower values give memory back first. Caches go
+    // before the scrollback users see.
+    static constexpr int kDirectoryCachePriority = 0;
+    static constexpr int kContextCachePriority = 0;
+    static constexpr int kSuggestionCachePriority = 1;
+    static constexpr int kIdleScrollbackPriority = 2;
+
+    // Rebuild the AI provider from current settings (after ConfigDialog)
+    void reload_ai_provider();
+
+    // Unique id for a window so it can cancel only its own requests
+    PredictionService::OwnerId register_client() { return ++last_client_id_; }
+
+private:
+    std::unique_ptr<infrastructure::SettingsManager> settings_manager_;
+    // Before context_service_, which holds a pointer to it
+    std::unique_ptr<infrastructure::DirectoryCache> directory_cache_;
+    std::unique_ptr<infrastructure::ContextService> context_service_;
+    std::unique_ptr<SuggestionCache> suggestion_cache_;
+    infrastructure::plugins::PluginLoader plugin_loader_;
+    // Before prediction_service_, whose queued requests may still assemble
+    std::unique_ptr<ContextAssembler> context_assembler_;
+    std::unique_ptr<PredictionService> prediction_service_;
+    std::unique_ptr<infrastructure::MemoryGovernor> memory_governor_;
+    std::atomic<PredictionService::OwnerId> last_client_id_{0};
+
+    std::unique_ptr<domain::IAIProvider> create_ai_provider();
+    void register_context_providers();
+};
+
+} // namespace application
+} // namespace colabb
+
+#endif // COLABB_SERVICE_CONTAINER_HPP
@@ -5,81 +5,298 @@
 namespace colabb {
 namespace application {
 
-SuggestionCache::SuggestionCache(size_t max_size, std::chrono::minutes ttl)
-    : max_size_(max_size)
-    , ttl_(ttl) {
+constexpr std::chrono::seconds SuggestionCache::kRevalidationTimeout;
+
+SuggestionCache::SuggestionCache(size_t max_size,
+                                 std::chrono::milliseconds fresh_ttl,
+                                 std::chrono::milliseconds stale_window)
+    : max_size_(std::max<size_t>(max_size, 1))
+    , window_max_(std::max<size_t>(max_size_ / 100, 1))
+    , main_max_(max_size_ - window_max_)
+    , protected_max_(main_max_ * 80 / 100)
+    , fresh_ttl_(fresh_ttl)
+    , stale_window_(stale_window)
+    , sketch_(max_size_) {
 }
 
 void SuggestionCache::put(const std::string& query, const domain::Suggestion& suggestion) {
     std::string normalized = normalize_query(query);
+    sketch_.increment(normalized);
+
+    // A real answer supersedes any negative entry
+    auto negative = negative_.find(normalized);
+    if (negative != negative_.end()) {
+        erase_negative(negative);
+    }
+
     auto it = cache_.find(normalized);
 
     // Update existing entry
     if (it != cache_.end()) {
+        bytes_ -= entry_bytes(it->first, it->second);
         it->second.suggestion = suggestion;
-        it->second.timestamp = std::chrono::system_clock::now();
-        // Move key to front (most recently used)
-        lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_it);
-        it->second.lru_it = lru_list_.begin();
+        it->second.timestamp = std::chrono::steady_clock::now();
+        it->second.revalidating = false;
+        bytes_ += entry_bytes(it->first, it->second);
+        on_hit(it->second);
+        if (max_bytes_ > 0 && bytes_ > max_bytes_) {
+            trim_to(max_bytes_);
+        }
         return;
     }
 
-    // Evict if cache is full
-    if (cache_.size() >= max_size_) {
-        evict_oldest();
-    }
-
-    // Insert new entry at front
-    lru_list_.push_front(normalized);
+    // Insert new entry at the front of the admission window
+    window_list_.push_front(normalized);
     CacheEntry entry;
     entry.suggestion = suggestion;
-    entry.timestamp = std::chrono::system_clock::now();
-    entry.lru_it = lru_list_.begin();
+    entry.timestamp = std::chrono::steady_clock::now();
+    entry.segment = Segment::Window;
+    entry.lru_it = window_list_.begin();
+    bytes_ += entry_bytes(normalized, entry);
     cache_[normalized] = std::move(entry);
+
+    if (window_list_.size() > window_max_) {
+        evict();
+    }
+    if (max_bytes_ > 0 && bytes_ > max_bytes_) {
+        trim_to(max_bytes_);
+    }
 }
 
 std::optional<domain::Suggestion> SuggestionCache::get(const std::string& query) {
     std::string normalized = normalize_query(query);
     auto it = cache_.find(normalized);
     if (it == cache_.end()) {
+        ++stats_.misses;
         return std::nullopt;
     }
 
-    // Check if expired
-    if (is_expired(it->second)) {
-        // remove from lru list and map
-        lru_list_.erase(it->second.lru_it);
-        cache_.erase(it);
+    // Stale entries are kept for lookup(); only drop them once fully expired
+    auto age = age_of(it->second);
+    if (age > fresh_ttl_) {
+        if (age > fresh_ttl_ + stale_window_) {
+            erase_entry(it);
+        }
+        ++stats_.misses;
         return std::nullopt;
     }
 
-    // Move to front as most recently used
-    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_it);
-    it->second.lru_it = lru_list_.begin();
+    sketch_.increment(normalized);
+    on_hit(it->second);
+    ++stats_.hits;
 
     return it->second.suggestion;
 }
 
+std::optional<SuggestionCache::Lookup> SuggestionCache::lookup(const std::string& query) {
+    std::string normalized = normalize_query(query);
+    auto it = cache_.find(normalized);
+    if (it == cache_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+
+    auto age = age_of(it->second);
+    if (age > fresh_ttl_ + stale_window_) {
+        erase_entry(it);
+        ++stats_.misses;
+        return std::nullopt;
+    }
+
+    sketch_.increment(normalized);
+    on_hit(it->second);
+
+    Lookup result;
+    result.suggestion = it->second.suggestion;
+    if (age > fresh_ttl_) {
+        result.stale = true;
+        const auto now = std::chrono::steady_clock::now();
+        result.needs_revalidation = !it->second.revalidating ||
+                                    now - it->second.revalidation_started > kRevalidationTimeout;
+        if (result.needs_revalidation) {
+            it->second.revalidating = true;
+            it->second.revalidation_started = now;
+        }
+        ++stats_.stale_hits;
+    } else {
+        ++stats_.hits;
+    }
+
+    return result;
+}
+
+void SuggestionCache::abandon_revalidation(const std::string& query) {
+    auto it = cache_.find(normalize_query(query));
+    if (it != cache_.end()) {
+        it->second.revalidating = false;
+    }
+}
+
+void SuggestionCache::put_negative(const std::string& query, NegativeKind kind) {
+    std::string normalized = normalize_query(query);
+    auto ttl = kind == NegativeKind::TransportFailure ? negative_failure_ttl_ : negative_empty_ttl_;
+    auto expires_at = std::chrono::steady_clock::now() + ttl;
+
+    auto it = negative_.find(normalized);
+    if (it != negative_.end()) {
+        it->second.kind = kind;
+        it->second.expires_at = expires_at;
+        negative_order_.splice(negative_order_.begin(), negative_order_, it->second.order_it);
+        it->second.order_it = negative_order_.begin();
+        return;
+    }
+
+    if (negative_.size() >= max_size_) {
+        erase_negative(negative_.find(negative_order_.back()));
+    }
+
+    negative_order_.push_front(normalized);
+    bytes_ += negative_entry_bytes(normalized);
+    negative_[normalized] = NegativeEntry{kind, expires_at, negative_order_.begin()};
+}
+
+std::optional<SuggestionCache::NegativeKind> SuggestionCache::get_negative(const std::string& query) {
+    auto it = negative_.find(normalize_query(query));
+    if (it == negative_.end()) {
+        return std::nullopt;
+    }
+
+    if (std::chrono::steady_clock::now() >= it->second.expires_at) {
+        erase_negative(it);
+        return std::nullopt;
+    }
+
+    ++stats_.negative_hits;
+    return it->second.kind;
+}
+
+void SuggestionCache::set_negative_ttls(std::chrono::milliseconds empty_ttl,
+                                        std::chrono::milliseconds failure_ttl) {
+    negative_empty_ttl_ = empty_ttl;
+    negative_failure_ttl_ = failure_ttl;
+}
+
+void SuggestionCache::set_max_bytes(size_t max_bytes) {
+    max_bytes_ = max_bytes;
+    if (max_bytes_ > 0 && bytes_ > max_bytes_) {
+        trim_to(max_bytes_);
+    }
+}
+
+size_t SuggestionCache::trim_to(size_t target_bytes) {
+    const size_t before = bytes_;
+
+    while (bytes_ > target_bytes && !negative_order_.empty()) {
+        erase_negative(negative_.find(negative_order_.back()));
+    }
+    for (auto* list : {&probation_list_, &window_list_, &protected_list_}) {
+        while (bytes_ > target_bytes && !list->empty()) {
+            erase_entry(cache_.find(list->back()));
+        }
+    }
+
+    return before - bytes_;
+}
+
 void SuggestionCache::clear() {
+    bytes_ = 0;
     cache_.clear();
-    lru_list_.clear();
+    negative_.clear();
+    negative_order_.clear();
+    window_list_.clear();
+    probation_list_.clear();
+    protected_list_.clear();
+    sketch_.clear();
+}
+
+std::list<std::string>& SuggestionCache::list_for(Segment segment) {
+    switch (segment) {
+        case Segment::Window: return window_list_;
+        case Segment::Probation: return probation_list_;
+        case Segment::Protected: break;
+    }
+    return protected_list_;
 }
 
-void SuggestionCache::evict_oldest() {
-    if (lru_list_.empty()) {
+void SuggestionCache::on_hit(CacheEntry& entry) {
+    if (entry.segment != Segment::Probation) {
+        // Window and protected entries just move to the front of their segment
+        auto& list = list_for(entry.segment);
+        list.splice(list.begin(), list, entry.lru_it);
+        entry.lru_it = list.begin();
         return;
     }
 
-    // Least recently used is at the back of the list
-    std::string key = lru_list_.back();
-    lru_list_.pop_back();
-    cache_.erase(key);
+    // Second access while on probation: promote to protected
+    protected_list_.splice(protected_list_.begin(), probation_list_, entry.lru_it);
+    entry.lru_it = protected_list_.begin();
+    entry.segment = Segment::Protected;
+
+    if (protected_list_.size() > protected_max_) {
+        // Demote the protected LRU back to probation instead of dropping it
+        auto& demoted = cache_.find(protected_list_.back())->second;
+        probation_list_.splice(probation_list_.begin(), protected_list_, demoted.lru_it);
+        demoted.lru_it = probation_list_.begin();
+        demoted.segment = Segment::Probation;
+    }
+}
+
+void SuggestionCache::evict() {
+    // Least recently used window entry becomes the admission candidate
+    auto candidate = cache_.find(window_list_.back());
+
+    if (main_max_ == 0) {
+        erase_entry(candidate);
+        return;
+    }
+
+    if (probation_list_.size() + protected_list_.size() < main_max_) {
+        probation_list_.splice(probation_list_.begin(), window_list_, candidate->second.lru_it);
+        candidate->second.lru_it = probation_list_.begin();
+        candidate->second.segment = Segment::Probation;
+        return;
+    }
+
+    // Main region is full: the candidate must beat the probation victim.
+    // Ties go to the candidate so uniform (all one-off) traffic degrades to LRU.
+    auto& victim_list = probation_list_.empty() ? protected_list_ : probation_list_;
+    auto victim = cache_.find(victim_list.back());
+    if (sketch_.frequency(candidate->first) >= sketch_.frequency(victim->first)) {
+        erase_entry(victim);
+        probation_list_.splice(probation_list_.begin(), window_list_, candidate->second.lru_it);
+        candidate->second.lru_it = probation_list_.begin();
+        candidate->second.segment = Segment::Probation;
+    } else {
+        erase_entry(candidate);
+        ++stats_.rejected_admissions;
+    }
+}
+
+void SuggestionCache::erase_entry(std::unordered_map<std::string, CacheEntry>::iterator it) {
+    bytes_ -= entry_bytes(it->first, it->second);
+    list_for(it->second.segment).erase(it->second.lru_it);
+    cache_.erase(it);
+}
+
+void SuggestionCache::erase_negative(std::unordered_map<std::string, NegativeEntry>::iterator it) {
+    bytes_ -= negative_entry_bytes(it->first);
+    negative_order_.erase(it->second.order_it);
+    negative_.erase(it);
+}
+
+size_t SuggestionCache::entry_bytes(const std::string& key, const CacheEntry& entry) {
+    // Key is stored twice (map node + LRU list node); the constant covers
+    // node, bucket and list bookkeeping.
+    return 2 * key.size() + entry.suggestion.command.size() +
+           entry.suggestion.explanation.size() + sizeof(CacheEntry) + 64;
+}
+
+size_t SuggestionCache::negative_entry_bytes(const std::string& key) {
+    return 2 * key.size() + sizeof(NegativeEntry) + 64;
 }
 
-bool SuggestionCache::is_expired(const CacheEntry& entry) const {
-    auto now = std::chrono::system_clock::now();
-    auto age = std::chrono::duration_cast<std::chrono::minutes>(now - entry.timestamp);
-    return age > ttl_;
+std::chrono::steady_clock::duration SuggestionCache::age_of(const CacheEntry& entry) const {
+    return std::chrono::steady_clock::now() - entry.timestamp;
 }
 
 std::string SuggestionCache::normalize_query(const std::string& query) const {
@@ -1,6 +1,7 @@
 #ifndef COLABB_SUGGESTION_CACHE_HPP
 #define COLABB_SUGGESTION_CACHE_HPP
 
+#include "application/frequency_sketch.hpp"
 #include "domain/models/suggestion.hpp"
 #include <string>
 #include <unordered_map>
@@ -11,31 +12,131 @@
 namespace colabb {
 namespace application {
 
+/**
+ * @brief Suggestion cache with W-TinyLFU admission.
+ *
+ * New entries land in a small LRU window (~1% of capacity). Entries leaving
+ * the window compete with the main region's probation victim and are only
+ * admitted when the frequency sketch says they are at least as popular, so
+ * a burst of one-off queries cannot flush frequently reused commands. The
+ * main region is a segmented LRU (probation / protected).
+ *
+ * Entries are fresh for fresh_ttl. For stale_window after that they can
+ * still be served through lookup() flagged as stale, so the caller can show
+ * them immediately and revalidate in the background.
+ *
+ * Queries that produced nothing are remembered as short-lived negative
+ * entries, with separate TTLs for empty answers and transport failures,
+ * so retyping them does not hit the provider again.
+ *
+ * An optional byte budget bounds the cache by approximate footprint as well
+ * as entry count; trim_to() lets the memory governor shrink it on demand.
+ */
 class SuggestionCache {
 public:
-    SuggestionCache(size_t max_size = 100, std::chrono::minutes ttl = std::chrono::minutes(30));
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t stale_hits = 0;
+        size_t negative_hits = 0;
+        size_t rejected_admissions = 0;
+
+        double hit_rate() const {
+            const size_t total = hits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+        }
+    };
+
+    struct Lookup {
+        domain::Suggestion suggestion;
+        bool stale = false;
+        // True only for the first stale hit, so one refresh is issued per entry
+        bool needs_revalidation = false;
+    };
+
+    enum class NegativeKind { EmptyAnswer, TransportFailure };
+
+    SuggestionCache(size_t max_size = 100,
+                    std::chrono::milliseconds fresh_ttl = std::chrono::minutes(30),
+                    std::chrono::milliseconds stale_window = std::chrono::minutes(30));
     
     void put(const std::string& query, const domain::Suggestion& suggestion);
+    // Fresh entries only
     std::optional<domain::Suggestion> get(const std::string& query);
+    // Fresh or stale-but-servable entries
+    std::optional<Lookup> lookup(const std::string& query);
+    // The refresh asked for by lookup() failed or was dropped: the next
+    // stale hit asks again. A refresh that never reports back is also given
+    // up on after kRevalidationTimeout.
+    void abandon_revalidation(const std::string& query);
+    static constexpr std::chrono::seconds kRevalidationTimeout{30};
+
+    // Negative entries (bounded by max_size, oldest dropped first)
+    void put_negative(const std::string& query, NegativeKind kind);
+    std::optional<NegativeKind> get_negative(const std::string& query);
+    void set_negative_ttls(std::chrono::milliseconds empty_ttl,
+                           std::chrono::milliseconds failure_ttl);
+
     void clear();
     size_t size() const { return cache_.size(); }
+
+    // Approximate heap footprint of all entries (positive and negative)
+    size_t memory_usage() const { return bytes_; }
+    // 0 disables the byte budget
+    void set_max_bytes(size_t max_bytes);
+    // Evict (negatives first, then probation, window, protected) until at
+    // most target_bytes remain. Returns the number of bytes released.
+    size_t trim_to(size_t target_bytes);
+    const Stats& stats() const { return stats_; }
     
 private:
+    enum class Segment { Window, Probation, Protected };
+
     struct CacheEntry {
         domain::Suggestion suggestion;
-        std::chrono::system_clock::time_point timestamp;
-        // Iterator into LRU list for O(1) updates/evictions
+        std::chrono::steady_clock::time_point timestamp;
+        Segment segment;
+        bool revalidating = false;
+        std::chrono::steady_clock::time_point revalidation_started;
+        // Iterator into the segment's LRU list for O(1) updates/evictions
         std::list<std::string>::iterator lru_it;
     };
     
+    struct NegativeEntry {
+        NegativeKind kind;
+        std::chrono::steady_clock::time_point expires_at;
+        std::list<std::string>::iterator order_it;
+    };
+
     std::unordered_map<std::string, CacheEntry> cache_;
+    std::unordered_map<std::string, NegativeEntry> negative_;
+    // Insertion order of negative entries, front = newest
+    std::list<std::string> negative_order_;
     // Front = most recently used, Back = least recently used
-    std::list<std::string> lru_list_;
+    std::list<std::string> window_list_;
+    std::list<std::string> probation_list_;
+    std::list<std::string> protected_list_;
     size_t max_size_;
-    std::chrono::minutes ttl_;
+    size_t window_max_;
+    size_t main_max_;
+    size_t protected_max_;
+    std::chrono::milliseconds fresh_ttl_;
+    std::chrono::milliseconds stale_window_;
+    std::chrono::milliseconds negative_empty_ttl_{std::chrono::minutes(2)};
+    std::chrono::milliseconds negative_failure_ttl_{std::chrono::seconds(15)};
+    FrequencySketch sketch_;
+    Stats stats_;
+    size_t bytes_ = 0;
+    size_t max_bytes_ = 0;
     
-    void evict_oldest();
-    bool is_expired(const CacheEntry& entry) const;
+    std::list<std::string>& list_for(Segment segment);
+    void on_hit(CacheEntry& entry);
+    void evict();
+    void erase_entry(std::unordered_map<std::string, CacheEntry>::iterator it);
+    void erase_negative(std::unordered_map<std::string, NegativeEntry>::iterator it);
+    static size_t entry_bytes(const std::string& key, const CacheEntry& entry);
+    static size_t negative_entry_bytes(const std::string& key);
+    std::chrono::steady_clock::duration age_of(const CacheEntry& entry) const;
     std::string normalize_query(const std::string& query) const;
 };
 
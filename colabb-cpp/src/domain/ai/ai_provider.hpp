@@ -6,10 +6,20 @@
 #include <string>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 
 namespace colabb {
 namespace domain {
 
+/**
+ * @brief Error de transporte del proveedor (red, HTTP no-2xx, respuesta ilegible).
+ * Permite distinguir un fallo del servicio de una respuesta vacía (std::nullopt).
+ */
+class ProviderError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
 /**
  * @brief Interfaz base para proveedores de IA.
  */
@@ -1,7 +1,6 @@
 #include "domain/ai/ai_provider.hpp"
 #include <nlohmann/json.hpp>
 #include <regex>
-#include <iostream>
 
 using json = nlohmann::json;
 
@@ -42,24 +41,24 @@ std::optional<Suggestion> GenericHttpAiProvider::predict(const std::string& prom
     auto response = http_client_->post(config_.endpoint_url, request_body.dump(), headers);
     
     if (!response.is_success()) {
-        std::cerr << "AI Provider error (" << config_.model << "): " << response.status_code << std::endl;
-        return std::nullopt;
+        throw ProviderError("AI Provider error (" + config_.model + "): " +
+                            std::to_string(response.status_code));
     }
     
+    std::string content;
     try {
         json response_json = json::parse(response.body);
-        std::string content = response_json["choices"][0]["message"]["content"];
-        std::string sanitized = sanitize_response(content);
-        
-        if (sanitized.empty()) {
-            return std::nullopt;
-        }
-        
-        return Suggestion(sanitized);
+        content = response_json["choices"][0]["message"]["content"];
     } catch (const std::exception& e) {
-        std::cerr << "Failed to parse AI response: " << e.what() << std::endl;
+        throw ProviderError(std::string("Failed to parse AI response: ") + e.what());
+    }
+
+    std::string sanitized = sanitize_response(content);
+    if (sanitized.empty()) {
         return std::nullopt;
     }
+    
+    return Suggestion(sanitized);
 }
 
 bool GenericHttpAiProvider::validate_connection() {
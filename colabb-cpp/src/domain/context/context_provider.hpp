@@ -0,0 +1,41 @@
+#ifndef COLABB_CONTEXT_PROVIDER_HPP
+#define COLABB_CONTEXT_PROVIDER_HPP
+
+#include <string>
+
+namespace colabb {
+namespace domain {
+
+/**
+ * @brief Instantánea de lo que se sabe al pedir una sugerencia.
+ * Se captura en el hilo de GTK; los proveedores solo la leen.
+ */
+struct ContextRequest {
+    std::string query;
+    std::string cwd;
+    std::string terminal_output; // últimas líneas visibles, ya sin ANSI
+    // Última orden terminada, solo si falló (requiere integración de shell)
+    std::string failed_command;
+    std::string failed_output;
+    int failed_exit_code = 0;
+};
+
+/**
+ * @brief Interfaz para fuentes de contexto del prompt (git, historial, plugins...).
+ *
+ * provide() corre en un hilo del pool y debe ser thread-safe. Devuelve una
+ * sección de texto lista para el prompt, o "" si no hay nada que aportar.
+ * Un proveedor que no termina a tiempo simplemente queda fuera del prompt.
+ */
+class IContextProvider {
+public:
+    virtual ~IContextProvider() = default;
+
+    virtual std::string name() const = 0;
+    virtual std::string provide(const ContextRequest& request) = 0;
+};
+
+} // namespace domain
+} // namespace colabb
+
+#endif // COLABB_CONTEXT_PROVIDER_HPP
@@ -1,5 +1,6 @@
 #include "infrastructure/config/settings_manager.hpp"
 #include <libsecret/secret.h>
+#include <algorithm>
 #include <fstream>
 #include <filesystem>
 #include <iostream>
@@ -45,6 +46,10 @@ std::string SettingsManager::get_base_config_dir() {
     return "/tmp/colabb";
 }
 
+std::string SettingsManager::get_context_plugin_dir() {
+    return get_base_config_dir() + "/plugins/context";
+}
+
 void SettingsManager::ensure_config_dir() {
     fs::create_directories(get_base_config_dir());
 }
@@ -111,6 +116,52 @@ void SettingsManager::set_ai_provider(const std::string& provider) {
     save_all();
 }
 
+size_t SettingsManager::get_memory_budget_bytes() const {
+    const int megabytes = settings_root_.value("memory_budget_mb", 32);
+    return static_cast<size_t>(std::max(megabytes, 1)) * 1024 * 1024;
+}
+
+std::unordered_map<std::string, std::string> SettingsManager::get_enabled_context_plugins() const {
+    std::unordered_map<std::string, std::string> plugins;
+    auto it = settings_root_.find("context_plugins");
+    if (it == settings_root_.end() || !it->is_object()) {
+        return plugins;
+    }
+    for (const auto& [name, sha256] : it->items()) {
+        if (sha256.is_string()) {
+            plugins[name] = sha256.get<std::string>();
+        } else {
+            std::cerr << "context_plugins: '" << name << "' needs a SHA-256 string" << std::endl;
+        }
+    }
+    return plugins;
+}
+
+size_t SettingsManager::get_rss_limit_bytes() const {
+    const int megabytes = settings_root_.value("memory_rss_limit_mb", 1024);
+    return static_cast<size_t>(std::max(megabytes, 0)) * 1024 * 1024;
+}
+
+std::chrono::minutes SettingsManager::get_suggestion_fresh_ttl() const {
+    return std::chrono::minutes(std::max(settings_root_.value("suggestion_fresh_minutes", 30), 0));
+}
+
+std::chrono::minutes SettingsManager::get_suggestion_stale_window() const {
+    return std::chrono::minutes(std::max(settings_root_.value("suggestion_stale_minutes", 30), 0));
+}
+
+std::chrono::seconds SettingsManager::get_negative_empty_ttl() const {
+    return std::chrono::seconds(std::max(settings_root_.value("suggestion_empty_ttl_seconds", 120), 0));
+}
+
+std::chrono::seconds SettingsManager::get_negative_failure_ttl() const {
+    return std::chrono::seconds(std::max(settings_root_.value("suggestion_failure_ttl_seconds", 15), 0));
+}
+
+bool SettingsManager::get_share_shell_history() const {
+    return settings_root_.value("share_shell_history", false);
+}
+
 std::string SettingsManager::get_api_key(const std::string& provider) {
     GError* error = nullptr;
     gchar* password = secret_password_lookup_sync(&colabb_schema, nullptr, &error, "provider", provider.c_str(), nullptr);
@@ -3,6 +3,7 @@
 
 #include "domain/models/terminal_profile.hpp"
 #include <nlohmann/json.hpp>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -40,6 +41,30 @@ public:
     // Persistence
     void sync();
 
+    // Directory holding context provider plugins (*.so)
+    std::string get_context_plugin_dir();
+
+    // Plugins the user enabled: file name in the plugin dir -> SHA-256 (hex)
+    // the file must match. Nothing is loaded unless listed here.
+    std::unordered_map<std::string, std::string> get_enabled_context_plugins() const;
+
+    // Whether the shell history file may go into AI prompts (off by default)
+    bool get_share_shell_history() const;
+
+    // Budget for caches, on top of the scrollback the profiles ask for
+    size_t get_memory_budget_bytes() const;
+    // Process RSS above which the memory governor treats the system as
+    // under pressure; 0 disables the check
+    size_t get_rss_limit_bytes() const;
+
+    // How long a cached suggestion is served as is, and for how long after
+    // that it is still shown while a refresh runs
+    std::chrono::minutes get_suggestion_fresh_ttl() const;
+    std::chrono::minutes get_suggestion_stale_window() const;
+    // How long an empty answer and a provider failure are remembered
+    std::chrono::seconds get_negative_empty_ttl() const;
+    std::chrono::seconds get_negative_failure_ttl() const;
+
 private:
     // Memory state
     nlohmann::json settings_root_;
@@ -1,7 +1,7 @@
 #include "infrastructure/context/context_service.hpp"
 #include <filesystem>
-#include <fstream>
 #include <algorithm>
+#include <cstdlib>
 #include <iostream>
 
 namespace fs = std::filesystem;
@@ -9,119 +9,777 @@ namespace fs = std::filesystem;
 namespace colabb {
 namespace infrastructure {
 
-ContextService::ContextService() {}
+namespace {
 
-ContextService::ProjectInfo ContextService::detect_context(const std::string& current_path) {
-    {
-        std::lock_guard<std::mutex> lock(cache_mutex_);
-        auto cached = cache_.find(current_path);
-        if (cached != cache_.end()) {
-            auto age = std::chrono::steady_clock::now() - cached->second.timestamp;
-            if (age <= cache_ttl_) {
-                return cached->second.info;
-            }
-            cache_.erase(cached);
+struct Marker {
+    const char* file;
+    const char* build_tool;
+    const char* language; // nullptr when the tool says nothing about it
+};
+
+// Build files that identify a project; Makefile could be C, C++, Go, etc.
+constexpr Marker kMarkers[] = {
+    {"CMakeLists.txt", "CMake", "C++"},
+    {"Makefile", "Make", nullptr},
+    {"package.json", "NPM", "JavaScript/TypeScript"},
+    {"requirements.txt", "Pip/Poetry", "Python"},
+    {"pyproject.toml", "Pip/Poetry", "Python"},
+    {"poetry.lock", "Pip/Poetry", "Python"},
+    {"Cargo.toml", "Cargo", "Rust"},
+    {"go.mod", "Go", "Go"},
+};
+
+// Index watches use their own key space so they never collide with the
+// per-cwd cache keys
+const std::string kIndexKeyPrefix = "dir:";
+
+// Files read by ToolchainProbe between the cwd and the project root
+constexpr const char* kVersionFiles[] = {
+    ".python-version", ".nvmrc", ".node-version", "rust-toolchain", "rust-toolchain.toml",
+    ".venv", "venv", "env",
+};
+
+bool is_marker_name(const std::string& name) {
+    if (name == ".git") return true;
+    for (const auto& marker : kMarkers) {
+        if (name == marker.file) return true;
+    }
+    for (const char* file : kVersionFiles) {
+        if (name == file) return true;
+    }
+    return false;
+}
+
+void merge_unique(std::vector<std::string>& into, const std::vector<std::string>& from) {
+    for (const auto& item : from) {
+        if (std::find(into.begin(), into.end(), item) == into.end()) {
+            into.push_back(item);
         }
     }
+}
+
+bool is_within(const std::string& path, const std::string& directory) {
+    if (directory == "/") return true;
+    return path.compare(0, directory.size(), directory) == 0 &&
+           (path.size() == directory.size() || path[directory.size()] == '/');
+}
+
+std::string normalize(const std::string& path) {
+    std::string normal = fs::path(path).lexically_normal().string();
+    while (normal.size() > 1 && normal.back() == '/') normal.pop_back();
+    return normal;
+}
+
+} // namespace
+
+ContextService::ContextService(bool watch_filesystem) {
+    if (const char* home = std::getenv("HOME")) {
+        home_dir_ = normalize(home);
+    }
+    if (watch_filesystem) {
+        watcher_ = std::make_unique<FileWatcher>(
+            [this](const std::string& key, const std::string& directory,
+                   const std::string& name, FileWatcher::Event event) {
+                on_file_event(key, directory, name, event);
+            });
+    }
+    toolchain_probe_ = std::make_unique<ToolchainProbe>([this] { on_toolchain_ready(); });
+    prefetch_thread_ = std::thread(&ContextService::prefetch_loop, this);
+}
+
+ContextService::~ContextService() {
+    set_directory_cache(nullptr);
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        stop_prefetch_ = true;
+    }
+    prefetch_cv_.notify_one();
+    if (prefetch_thread_.joinable()) {
+        prefetch_thread_.join();
+    }
+}
+
+const ContextService::CacheEntry* ContextService::find_cached_locked(const std::string& path) {
+    auto cached = cache_.find(path);
+    if (cached == cache_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (is_expired(cached->second, now)) {
+        erase_entry_locked(cached);
+        ++stats_.expired;
+        ++stats_.misses;
+        return nullptr;
+    }
+    ++stats_.hits;
+    cached->second.last_used = now;
+    lru_.splice(lru_.begin(), lru_, cached->second.lru);
+    return &cached->second;
+}
+
+bool ContextService::is_expired(const CacheEntry& entry, std::chrono::steady_clock::time_point now) const {
+    if (now - entry.last_used > idle_ttl_) {
+        return true;
+    }
+    return !entry.watched && now - entry.timestamp > cache_ttl_;
+}
+
+bool ContextService::git_status_stale(const CacheEntry& entry, std::chrono::steady_clock::time_point now) const {
+    return entry.info.is_git_repo && now - entry.git_checked > git_status_ttl_.load();
+}
+
+void ContextService::store_locked(const std::string& path, CacheEntry entry) {
+    entry.last_used = entry.timestamp;
+    entry.git_checked = entry.timestamp;
+    auto it = cache_.find(path);
+    if (it != cache_.end()) {
+        entry.lru = it->second.lru;
+        lru_.splice(lru_.begin(), lru_, entry.lru);
+        it->second = std::move(entry);
+        return;
+    }
+    lru_.push_front(path);
+    entry.lru = lru_.begin();
+    cache_.emplace(path, std::move(entry));
+    while (cache_.size() > max_entries_) {
+        erase_entry_locked(cache_.find(lru_.back()));
+        ++stats_.evicted;
+    }
+}
+
+std::unordered_map<std::string, ContextService::CacheEntry>::iterator
+ContextService::erase_entry_locked(std::unordered_map<std::string, CacheEntry>::iterator it) {
+    if (watcher_) {
+        watcher_->unwatch(it->first);
+    }
+    lru_.erase(it->second.lru);
+    return cache_.erase(it);
+}
+
+std::optional<ContextService::ProjectInfo> ContextService::lookup_cached(const std::string& path,
+                                                                         bool& git_stale) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (const CacheEntry* entry = find_cached_locked(path)) {
+        git_stale = git_status_stale(*entry, std::chrono::steady_clock::now());
+        return entry->info;
+    }
+    return std::nullopt;
+}
+
+ContextService::ProjectInfo ContextService::refresh_git_status(const std::string& path, ProjectInfo info) {
+    // project_root is the directory holding .git whenever is_git_repo
+    detect_git_status(info.project_root, info);
+    Prompt prompt = prompt_for(info);
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = cache_.find(path);
+    if (it != cache_.end()) {
+        it->second.info = info;
+        it->second.prompt = std::move(prompt);
+        it->second.git_checked = std::chrono::steady_clock::now();
+    }
+    return info;
+}
+
+ContextService::ProjectInfo ContextService::detect_context(const std::string& current_path) {
+    bool git_stale = false;
+    if (auto cached = lookup_cached(current_path, git_stale)) {
+        return git_stale ? refresh_git_status(current_path, std::move(*cached)) : *cached;
+    }
 
     ProjectInfo info;
     info.is_git_repo = false;
+
+    // Watch before probing so a change during detection is not missed
+    const std::uint64_t epoch = invalidation_epoch_.load();
+    bool watched = false;
     
     try {
         if (!fs::exists(current_path) || !fs::is_directory(current_path)) {
             return info;
         }
 
-        info.project_name = get_project_name(current_path);
-        detect_languages_and_tools(current_path, info);
-        detect_git_status(current_path, info);
+        const DirectoryNode node = resolve_directory(current_path);
+        watched = node.watched && watch_directory(current_path, node.git_root);
+        info.project_root = node.project_root.empty() ? normalize(current_path) : node.project_root;
+        info.project_name = get_project_name(info.project_root);
+        detect_languages_and_tools(current_path, node, info);
+        info.toolchain = toolchain_probe_->probe(normalize(current_path), info.project_root,
+                                                 info.languages, &info.toolchain_pending);
+        if (!node.git_root.empty()) {
+            detect_git_status(node.git_root, info);
+        }
 
     } catch (const std::exception& e) {
         std::cerr << "Error detecting context: " << e.what() << std::endl;
     }
 
+    // Render now, on the detecting thread, so a UI-side hit costs nothing
+    Prompt prompt = prompt_for(info);
     {
         std::lock_guard<std::mutex> lock(cache_mutex_);
-        cache_[current_path] = CacheEntry{info, std::chrono::steady_clock::now()};
+        store_locked(current_path, CacheEntry{info, std::chrono::steady_clock::now(),
+                                              watched && invalidation_epoch_.load() == epoch,
+                                              std::move(prompt)});
     }
 
     return info;
 }
 
+bool ContextService::watch_directory(const std::string& path, const std::string& git_root) {
+    if (!is_watching()) {
+        return false;
+    }
+
+    // The directory itself covers files appearing or disappearing for the
+    // extension scan (ancestors are covered by the index watches). The git
+    // dir (HEAD, index), the common dir (packed-refs) and refs/heads with
+    // its subdirectories (branches like feature/x) cover checkouts, commits
+    // and staging.
+    bool ok = watcher_->watch(path, path);
+    if (ok && !git_root.empty()) {
+        if (auto layout = GitReader::locate(git_root)) {
+            ok = watcher_->watch(path, layout->git_dir, true);
+            if (ok && layout->common_dir != layout->git_dir) {
+                ok = watcher_->watch(path, layout->common_dir, true);
+            }
+            const std::string heads = layout->common_dir + "/refs/heads";
+            std::error_code ec;
+            if (ok && fs::is_directory(heads, ec)) {
+                ok = watcher_->watch(path, heads, true);
+                for (fs::recursive_directory_iterator it(heads, ec), end; ok && !ec && it != end; it.increment(ec)) {
+                    if (it->is_directory(ec)) {
+                        ok = watcher_->watch(path, it->path().string(), true);
+                    }
+                }
+            }
+        }
+    }
+
+    if (!ok) {
+        watcher_->unwatch(path);
+    }
+    return ok;
+}
+
+ContextService::DirectoryNode ContextService::resolve_directory(const std::string& path) {
+    const std::string dir = normalize(path);
+    const std::uint64_t epoch = invalidation_epoch_.load();
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = dir_index_.find(dir);
+        if (it != dir_index_.end()) {
+            return it->second;
+        }
+    }
+
+    // A watched listing is as current as our own watches; skip the stats
+    DirectoryCache* directories = directory_cache_.load();
+    const DirectoryCache::ListingPtr listing =
+        directories && is_watching() ? directories->get(dir) : nullptr;
+
+    DirectoryNode node;
+    collect_markers(dir, listing.get(), node.languages, node.build_tools);
+    const bool own_markers = !node.build_tools.empty();
+
+    std::error_code ec;
+    const bool has_git = listing && !listing->truncated ? listing->find(".git") != nullptr
+                                                        : fs::exists(dir + "/.git", ec);
+    const std::string parent = fs::path(dir).parent_path().string();
+    const bool is_top = dir == home_dir_ || parent.empty() || parent == dir;
+    node.shareable = !is_top;
+    node.watched = true;
+
+    if (!has_git && !is_top) {
+        const DirectoryNode up = resolve_directory(parent);
+        node.watched = up.watched;
+        if (up.shareable) {
+            merge_unique(node.languages, up.languages);
+            merge_unique(node.build_tools, up.build_tools);
+            node.project_root = up.project_root;
+            node.git_root = up.git_root;
+        }
+    }
+    if (has_git) {
+        node.git_root = dir;
+        node.project_root = dir;
+    } else if (node.project_root.empty() && own_markers) {
+        node.project_root = dir;
+    }
+
+    // Only marker names matter here, so ancestors are cheap to keep watched
+    node.watched = node.watched && is_watching() && watcher_->watch(kIndexKeyPrefix + dir, dir);
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (invalidation_epoch_.load() == epoch) {
+        dir_index_[dir] = node;
+    }
+    return node;
+}
+
+void ContextService::on_file_event(const std::string& key, const std::string& directory,
+                                   const std::string& name, FileWatcher::Event event) {
+    if (key.compare(0, kIndexKeyPrefix.size(), kIndexKeyPrefix) == 0) {
+        if (event == FileWatcher::Event::Overflow || name.empty() || is_marker_name(name)) {
+            invalidate_subtree(key.substr(kIndexKeyPrefix.size()));
+        }
+        return;
+    }
+
+    if (event == FileWatcher::Event::Overflow) {
+        invalidate(key);
+        return;
+    }
+
+    // Outside the directory itself only git state matters; objects, logs
+    // and lock files churn constantly
+    if (directory != key && !name.empty()) {
+        const std::string lock_suffix = ".lock";
+        const bool is_lock = name.size() > lock_suffix.size() &&
+            name.compare(name.size() - lock_suffix.size(), lock_suffix.size(), lock_suffix) == 0;
+        const size_t heads = directory.find("/refs/heads");
+        const bool in_refs = heads != std::string::npos &&
+            (heads + 11 == directory.size() || directory[heads + 11] == '/');
+        if (is_lock || (!in_refs && name != "HEAD" && name != "packed-refs" && name != "index" &&
+                        name != "FETCH_HEAD")) {
+            return;
+        }
+    }
+
+    invalidate(key);
+}
+
+void ContextService::invalidate(const std::string& path) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    ++invalidation_epoch_;
+    auto it = cache_.find(path);
+    if (it != cache_.end()) {
+        erase_entry_locked(it);
+    } else if (watcher_) {
+        watcher_->unwatch(path);
+    }
+}
+
+void ContextService::invalidate_subtree(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    ++invalidation_epoch_;
+    for (auto it = dir_index_.begin(); it != dir_index_.end();) {
+        if (is_within(it->first, directory)) {
+            if (watcher_) watcher_->unwatch(kIndexKeyPrefix + it->first);
+            it = dir_index_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        if (is_within(normalize(it->first), directory)) {
+            it = erase_entry_locked(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ContextService::on_toolchain_ready() {
+    std::vector<std::pair<std::string, ProjectInfo>> waiting;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        for (const auto& [path, entry] : cache_) {
+            if (entry.info.toolchain_pending) {
+                waiting.emplace_back(path, entry.info);
+            }
+        }
+    }
+
+    // Version results are cached now, so re-probing is only a few stats
+    for (auto& [path, info] : waiting) {
+        info.toolchain = toolchain_probe_->probe(normalize(path), info.project_root,
+                                                 info.languages, &info.toolchain_pending);
+        Prompt prompt = prompt_for(info);
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = cache_.find(path);
+        if (it != cache_.end() && it->second.info.toolchain_pending) {
+            it->second.info = std::move(info);
+            it->second.prompt = std::move(prompt);
+        }
+    }
+}
+
 std::string ContextService::get_context_prompt(const std::string& current_path) {
-    auto info = detect_context(current_path);
-    
-    std::string prompt = "Project Context:\n";
-    prompt += "- Name: " + info.project_name + "\n";
-    
-    if (!info.languages.empty()) {
-        prompt += "- Languages: ";
-        for (const auto& lang : info.languages) prompt += lang + ", ";
-        prompt = prompt.substr(0, prompt.length() - 2) + "\n";
+    return *prompt_for(detect_context(current_path));
+}
+
+void ContextService::prefetch(const std::string& current_path) {
+    if (current_path.empty()) {
+        return;
     }
-    
-    if (!info.build_tools.empty()) {
-        prompt += "- Build Tools: ";
-        for (const auto& tool : info.build_tools) prompt += tool + ", ";
-        prompt = prompt.substr(0, prompt.length() - 2) + "\n";
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        // Only the latest few directories matter; skip duplicates
+        if (std::find(prefetch_queue_.begin(), prefetch_queue_.end(), current_path) != prefetch_queue_.end()) {
+            return;
+        }
+        prefetch_queue_.push_back(current_path);
+        if (prefetch_queue_.size() > 16) {
+            prefetch_queue_.pop_front();
+        }
+    }
+    prefetch_cv_.notify_one();
+}
+
+ContextService::Prompt ContextService::get_cached_context_prompt(const std::string& current_path) {
+    Prompt cached;
+    bool git_stale = false;
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (const CacheEntry* entry = find_cached_locked(current_path)) {
+            cached = entry->prompt;
+            git_stale = git_status_stale(*entry, std::chrono::steady_clock::now());
+        }
+    }
+    if (cached) {
+        if (git_stale) {
+            prefetch(current_path); // serve this one, refresh for the next
+        }
+        return cached;
+    }
+
+    prefetch(current_path);
+    ProjectInfo info;
+    info.is_git_repo = false;
+    info.project_name = get_project_name(current_path);
+    return prompt_for(info);
+}
+
+std::uint64_t ContextService::fingerprint(const ProjectInfo& info) {
+    // FNV-1a; fields are separated so ("ab","c") and ("a","bc") differ
+    std::uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const std::string& field) {
+        for (unsigned char c : field) {
+            hash = (hash ^ c) * 1099511628211ULL;
+        }
+        hash = (hash ^ 0xff) * 1099511628211ULL;
+    };
+    auto mix_int = [&mix](long long value) { mix(std::to_string(value)); };
+
+    mix(info.project_name);
+    for (const auto& lang : info.languages) mix(lang);
+    mix("|");
+    for (const auto& tool : info.build_tools) mix(tool);
+    mix("|");
+    mix_int(info.is_git_repo);
+    mix_int(info.git_detached);
+    mix(info.git_branch);
+    mix(info.git_upstream);
+    mix_int(info.git_staged);
+    mix_int(info.git_modified);
+    mix_int(info.git_ahead);
+    mix_int(info.git_behind);
+    for (const auto& [tool, version] : info.toolchain) {
+        mix(tool);
+        mix(version);
+    }
+    return hash;
+}
+
+ContextService::Prompt ContextService::prompt_for(const ProjectInfo& info) {
+    // Rendering is a few appends; the fingerprint only finds the candidate
+    // to share, the text decides (a collision must not serve another prompt)
+    const std::uint64_t key = fingerprint(info);
+    std::string text = render_prompt(info);
+
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto& slot = prompts_[key];
+    if (Prompt existing = slot.lock()) {
+        if (*existing == text) {
+            return existing;
+        }
+        return std::make_shared<const std::string>(std::move(text)); // collision: not shared
+    }
+    Prompt rendered = std::make_shared<const std::string>(std::move(text));
+    slot = rendered;
+    // Forget prompts nobody holds any more
+    if (prompts_.size() > 2 * cache_.size() + 16) {
+        for (auto it = prompts_.begin(); it != prompts_.end();) {
+            it = it->second.expired() ? prompts_.erase(it) : std::next(it);
+        }
+    }
+    return rendered;
+}
+
+void ContextService::prefetch_loop() {
+    auto next_sweep = std::chrono::steady_clock::now() + kSweepInterval;
+    while (true) {
+        std::string path;
+        {
+            std::unique_lock<std::mutex> lock(prefetch_mutex_);
+            prefetch_cv_.wait_until(lock, next_sweep, [this] {
+                return stop_prefetch_ || !prefetch_queue_.empty();
+            });
+            if (stop_prefetch_) {
+                break;
+            }
+            if (!prefetch_queue_.empty()) {
+                path = std::move(prefetch_queue_.front());
+                prefetch_queue_.pop_front();
+            }
+        }
+        // Proactive expiry: idle entries go even if their path is never looked up again
+        if (std::chrono::steady_clock::now() >= next_sweep) {
+            sweep_expired();
+            next_sweep = std::chrono::steady_clock::now() + kSweepInterval;
+        }
+        if (path.empty()) {
+            continue;
+        }
+        // Listing first, so validation and marker probes find it warm
+        if (DirectoryCache* directories = directory_cache_.load()) {
+            directories->load(path);
+        }
+        detect_context(path);
+    }
+}
+
+std::string ContextService::render_prompt(const ProjectInfo& info) {
+    auto append_list = [](std::string& out, const char* label, const std::vector<std::string>& items) {
+        if (items.empty()) return;
+        out += label;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i > 0) out += ", ";
+            out += items[i];
+        }
+        out += '\n';
+    };
+
+    std::string prompt;
+    prompt.reserve(128 + info.project_name.size() + info.git_branch.size() + info.git_upstream.size());
+    prompt += "Project Context:\n- Name: ";
+    prompt += info.project_name;
+    prompt += '\n';
+    append_list(prompt, "- Languages: ", info.languages);
+    append_list(prompt, "- Build Tools: ", info.build_tools);
+    if (!info.toolchain.empty()) {
+        prompt += "- Toolchain: ";
+        for (size_t i = 0; i < info.toolchain.size(); ++i) {
+            if (i > 0) prompt += ", ";
+            prompt += info.toolchain[i].first;
+            prompt += ' ';
+            prompt += info.toolchain[i].second;
+        }
+        prompt += '\n';
     }
     
     if (info.is_git_repo) {
         prompt += "- Git: Yes";
-        if (!info.git_branch.empty()) {
-            prompt += " (Branch: " + info.git_branch + ")";
+        if (info.git_detached) {
+            if (info.git_branch.empty()) {
+                prompt += " (Detached HEAD)";
+            } else {
+                prompt += " (Detached at ";
+                prompt += info.git_branch;
+                prompt += ')';
+            }
+        } else if (!info.git_branch.empty()) {
+            prompt += " (Branch: ";
+            prompt += info.git_branch;
+            prompt += ')';
         }
-        prompt += "\n";
+        if (info.git_staged > 0) {
+            prompt += ", ";
+            prompt += std::to_string(info.git_staged);
+            prompt += " staged";
+        }
+        if (info.git_modified > 0) {
+            prompt += ", ";
+            prompt += std::to_string(info.git_modified);
+            prompt += " modified";
+        }
+        if (info.git_ahead > 0 || info.git_behind > 0) {
+            prompt += ", ";
+            prompt += std::to_string(std::max(info.git_ahead, 0));
+            prompt += " ahead/";
+            prompt += std::to_string(std::max(info.git_behind, 0));
+            prompt += " behind ";
+            prompt += info.git_upstream;
+        }
+        prompt += '\n';
     }
     
     return prompt;
 }
 
-std::string ContextService::get_project_name(const std::string& path) {
-    return fs::path(path).filename().string();
+void ContextService::set_scan_options(const LanguageScanner::Options& options) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    language_scanner_ = LanguageScanner(options);
+}
+
+void ContextService::set_directory_cache(DirectoryCache* cache) {
+    if (DirectoryCache* previous = directory_cache_.exchange(cache)) {
+        previous->set_change_callback(nullptr);
+    }
+    if (cache) {
+        // Index nodes built from a listing must not outlive its next update
+        cache->set_change_callback([this](const std::string& directory, const std::string& name) {
+            if (name.empty() || is_marker_name(name)) {
+                invalidate_subtree(directory);
+            }
+        });
+    }
+}
+
+void ContextService::set_git_status_ttl(std::chrono::milliseconds ttl) {
+    git_status_ttl_ = ttl;
+    git_reader_.set_worktree_ttl(ttl);
+}
+
+void ContextService::set_cache_limits(size_t max_entries, std::chrono::milliseconds idle_ttl) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    max_entries_ = std::max<size_t>(1, max_entries);
+    idle_ttl_ = idle_ttl;
+    while (cache_.size() > max_entries_) {
+        erase_entry_locked(cache_.find(lru_.back()));
+        ++stats_.evicted;
+    }
+}
+
+size_t ContextService::cache_size() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return cache_.size();
+}
+
+ContextService::CacheStats ContextService::cache_stats() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    return stats_;
+}
+
+size_t ContextService::sweep_expired() {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    size_t removed = 0;
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        if (is_expired(it->second, now)) {
+            it = erase_entry_locked(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    stats_.expired += removed;
+
+    // The index only grows with directories visited; past a few times the
+    // cache bound, rebuilding it from scratch is cheaper than keeping it
+    if (dir_index_.size() > 4 * max_entries_) {
+        for (const auto& [path, node] : dir_index_) {
+            if (watcher_) watcher_->unwatch(kIndexKeyPrefix + path);
+        }
+        dir_index_.clear();
+        ++invalidation_epoch_;
+    }
+    return removed;
 }
 
-void ContextService::detect_languages_and_tools(const std::string& path, ProjectInfo& info) {
-    // Check for build files first to infer tools and likely languages
-    if (has_file(path, "CMakeLists.txt")) {
-        info.build_tools.push_back("CMake");
-        info.languages.push_back("C++");
+size_t ContextService::memory_usage() const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    size_t total = 0;
+    for (const auto& [path, entry] : cache_) {
+        total += entry_bytes(path, entry);
     }
-    if (has_file(path, "Makefile")) {
-        info.build_tools.push_back("Make");
-        // Could be C, C++, Go, etc.
+    for (const auto& [path, node] : dir_index_) {
+        total += node_bytes(path, node);
     }
-    if (has_file(path, "package.json")) {
-        info.build_tools.push_back("NPM");
-        info.languages.push_back("JavaScript/TypeScript");
+    return total;
+}
+
+size_t ContextService::trim_to(size_t target_bytes) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    size_t total = 0;
+    for (const auto& [path, entry] : cache_) {
+        total += entry_bytes(path, entry);
     }
-    if (has_file(path, "requirements.txt") || has_file(path, "pyproject.toml") || has_file(path, "poetry.lock")) {
-        info.build_tools.push_back("Pip/Poetry");
-        info.languages.push_back("Python");
+    size_t index_total = 0;
+    for (const auto& [path, node] : dir_index_) {
+        index_total += node_bytes(path, node);
+    }
+    total += index_total;
+
+    const size_t before = total;
+    while (total > target_bytes && !lru_.empty()) {
+        auto it = cache_.find(lru_.back());
+        total -= entry_bytes(it->first, it->second);
+        erase_entry_locked(it);
+    }
+
+    // The index is cheap to rebuild (one probe per directory), so it goes
+    // as a whole once the cached contexts alone cannot meet the target
+    if (total > target_bytes && !dir_index_.empty()) {
+        for (const auto& [path, node] : dir_index_) {
+            if (watcher_) watcher_->unwatch(kIndexKeyPrefix + path);
+        }
+        dir_index_.clear();
+        ++invalidation_epoch_;
+        total -= index_total;
     }
-    if (has_file(path, "Cargo.toml")) {
-        info.build_tools.push_back("Cargo");
-        info.languages.push_back("Rust");
+    return before - total;
+}
+
+size_t ContextService::entry_bytes(const std::string& path, const CacheEntry& entry) {
+    const ProjectInfo& info = entry.info;
+    size_t bytes = sizeof(CacheEntry) + 64 + path.size() + info.git_branch.size() +
+                   info.project_name.size() + info.project_root.size() + info.git_upstream.size();
+    for (const auto& lang : info.languages) bytes += sizeof(std::string) + lang.size();
+    for (const auto& tool : info.build_tools) bytes += sizeof(std::string) + tool.size();
+    for (const auto& [tool, version] : info.toolchain) {
+        bytes += sizeof(ToolchainProbe::Entry) + tool.size() + version.size();
+    }
+    // Shared prompts are counted by every holder; the estimate errs high
+    if (entry.prompt) bytes += sizeof(std::string) + entry.prompt->size();
+    return bytes;
+}
+
+size_t ContextService::node_bytes(const std::string& path, const DirectoryNode& node) {
+    size_t bytes = sizeof(DirectoryNode) + 64 + 2 * path.size() +
+                   node.project_root.size() + node.git_root.size();
+    for (const auto& lang : node.languages) bytes += sizeof(std::string) + lang.size();
+    for (const auto& tool : node.build_tools) bytes += sizeof(std::string) + tool.size();
+    return bytes;
+}
+
+std::string ContextService::get_project_name(const std::string& path) {
+    return fs::path(path).filename().string();
+}
+
+void ContextService::collect_markers(const std::string& path, const DirectoryCache::Listing* listing,
+                                     std::vector<std::string>& languages, std::vector<std::string>& build_tools) {
+    if (listing && listing->truncated) {
+        listing = nullptr; // absence is not proven
     }
-    if (has_file(path, "go.mod")) {
-        info.build_tools.push_back("Go");
-        info.languages.push_back("Go");
+    std::error_code ec;
+    for (const auto& marker : kMarkers) {
+        const bool exists = listing ? listing->find(marker.file) != nullptr
+                                    : fs::exists(path + "/" + marker.file, ec);
+        if (!exists) continue;
+        merge_unique(build_tools, {marker.build_tool});
+        if (marker.language) {
+            merge_unique(languages, {marker.language});
+        }
     }
+}
+
+void ContextService::detect_languages_and_tools(const std::string& path, const DirectoryNode& node,
+                                                ProjectInfo& info) {
+    // Build files in the directory or any ancestor up to the project root
+    info.languages = node.languages;
+    info.build_tools = node.build_tools;
     
-    // Scan direct children for extensions if language list is empty
+    // No marker: sample the tree by extension, within the scan budget
     if (info.languages.empty()) {
-        bool has_cpp = false, has_py = false, has_js = false;
-        for (const auto& entry : fs::directory_iterator(path)) {
-            if (entry.is_regular_file()) {
-                std::string ext = entry.path().extension().string();
-                if (ext == ".cpp" || ext == ".hpp" || ext == ".cc" || ext == ".c") has_cpp = true;
-                else if (ext == ".py") has_py = true;
-                else if (ext == ".js" || ext == ".ts") has_js = true;
-            }
+        LanguageScanner scanner;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            scanner = language_scanner_;
         }
-        if (has_cpp) info.languages.push_back("C/C++");
-        if (has_py) info.languages.push_back("Python");
-        if (has_js) info.languages.push_back("JavaScript");
+        const auto result = scanner.scan(path);
+        info.languages = result.languages(scanner.options().min_share);
     }
     
     // Deduplicate
@@ -132,25 +790,19 @@ void ContextService::detect_languages_and_tools(const std::string& path, Project
 }
 
 void ContextService::detect_git_status(const std::string& path, ProjectInfo& info) {
-    if (fs::exists(path + "/.git")) {
-        info.is_git_repo = true;
-        
-        // Try to read HEAD to get branch
-        std::ifstream head_file(path + "/.git/HEAD");
-        if (head_file.is_open()) {
-            std::string line;
-            std::getline(head_file, line); // e.g., "ref: refs/heads/main"
-            if (line.rfind("ref: refs/heads/", 0) == 0) {
-                info.git_branch = line.substr(16);
-            } else {
-                info.git_branch = "DETACHED";
-            }
-        }
+    const GitReader::Status status = git_reader_.read(path);
+    if (!status.is_repo) {
+        return;
     }
-}
 
-bool ContextService::has_file(const std::string& path, const std::string& filename) {
-    return fs::exists(path + "/" + filename);
+    info.is_git_repo = true;
+    info.git_detached = status.branch.empty();
+    info.git_branch = info.git_detached ? status.head.substr(0, 7) : status.branch;
+    info.git_staged = status.staged;
+    info.git_modified = status.modified;
+    info.git_upstream = status.upstream;
+    info.git_ahead = status.ahead;
+    info.git_behind = status.behind;
 }
 
 } // namespace infrastructure
@@ -5,8 +5,22 @@
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
+
+#include "infrastructure/context/git_reader.hpp"
+#include "infrastructure/context/language_scanner.hpp"
+#include "infrastructure/context/toolchain_probe.hpp"
+#include "infrastructure/filesystem/directory_cache.hpp"
+#include "infrastructure/filesystem/file_watcher.hpp"
 
 namespace colabb {
 namespace infrastructure {
@@ -17,36 +31,190 @@ public:
         std::vector<std::string> languages;   // e.g., "C++", "Python"
         std::vector<std::string> build_tools; // e.g., "CMake", "Make", "NPM"
         bool is_git_repo;
-        std::string git_branch;
+        std::string git_branch;       // short SHA when HEAD is detached
+        bool git_detached = false;
+        int git_staged = 0;
+        int git_modified = 0;
+        std::string git_upstream;
+        int git_ahead = -1;           // -1 when unknown or untracked
+        int git_behind = -1;
         std::string project_name;
+        // Nearest ancestor holding .git, else the topmost one with a build
+        // marker, else the directory itself
+        std::string project_root;
+        // e.g. {"Python", "3.11.4 (venv .venv)"}, {"Node", "v20.11.0"}
+        std::vector<ToolchainProbe::Entry> toolchain;
+        // A version probe is still running; the entry is refreshed when it lands
+        bool toolchain_pending = false;
     };
 
-    ContextService();
-    ~ContextService() = default;
+    // With watch_filesystem, cached entries stay valid until inotify reports
+    // a change to the directory or its .git metadata; otherwise (or when a
+    // watch cannot be placed) they expire after cache_ttl_. Edits anywhere
+    // in the worktree aren't watched: a git entry's status is re-read once
+    // it is older than the git status TTL.
+    explicit ContextService(bool watch_filesystem = true);
+    ~ContextService();
+
+    bool is_watching() const { return watcher_ && watcher_->available(); }
 
     // Analyzes the directory at current_path to extract context
     ProjectInfo detect_context(const std::string& current_path);
 
+    // Rendered prompts are immutable and shared between every cache entry
+    // (and caller) whose ProjectInfo renders to the same text; the
+    // fingerprint is the lookup key, the text is compared
+    using Prompt = std::shared_ptr<const std::string>;
+
     // Generates a prompt string summarizing the context
     std::string get_context_prompt(const std::string& current_path);
 
+    // Queue detection of path on the background thread (coalesced, never
+    // blocks). Called when a shell reports a new working directory.
+    void prefetch(const std::string& current_path);
+
+    // Prompt from the cache only, safe on the UI thread: no filesystem
+    // access. On a miss it queues a prefetch and returns a name-only prompt.
+    // A hit hands out the prompt rendered when the entry was cached.
+    Prompt get_cached_context_prompt(const std::string& current_path);
+
+    // Content hash of everything render_prompt looks at
+    static std::uint64_t fingerprint(const ProjectInfo& info);
+
+    // Budget and depth of the extension scan used when no build marker is
+    // found. Applies to detections started afterwards.
+    void set_scan_options(const LanguageScanner::Options& options);
+
+    // Share directory listings: prefetches load the cwd into cache, and
+    // marker probes read watched listings instead of stat'ing. cache must
+    // outlive this service.
+    void set_directory_cache(DirectoryCache* cache);
+
+    struct CacheStats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t expired = 0; // dropped by TTL, idle expiry or the sweep
+        size_t evicted = 0; // dropped to stay within max_entries
+
+        double hit_rate() const {
+            const size_t total = hits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+        }
+    };
+
+    // At most max_entries cached contexts (least recently used dropped
+    // first). Entries not looked up for idle_ttl expire even when watched,
+    // which also releases their inotify watches.
+    void set_cache_limits(size_t max_entries, std::chrono::milliseconds idle_ttl);
+    void set_git_status_ttl(std::chrono::milliseconds ttl);
+    size_t cache_size() const;
+    CacheStats cache_stats() const;
+    // Drop expired entries now; the prefetch thread does this every
+    // kSweepInterval. Returns the number of entries removed.
+    size_t sweep_expired();
+
+    // Approximate heap footprint of the detection cache
+    size_t memory_usage() const;
+    // Drop oldest cache entries until at most target_bytes remain.
+    // Returns the number of bytes released.
+    size_t trim_to(size_t target_bytes);
+
 private:
     struct CacheEntry {
         ProjectInfo info;
         std::chrono::steady_clock::time_point timestamp;
+        bool watched = false;
+        Prompt prompt;
+        std::chrono::steady_clock::time_point last_used{};
+        std::list<std::string>::iterator lru{};
+        std::chrono::steady_clock::time_point git_checked{};
+    };
+
+    static constexpr std::chrono::seconds kSweepInterval{30};
+
+    // One directory of the memoized ancestor index. Lists hold the
+    // directory's own markers merged with everything inherited from its
+    // ancestors up to the project boundary, so a child costs one probe of
+    // its own directory plus a lookup of its parent.
+    struct DirectoryNode {
+        std::vector<std::string> languages;
+        std::vector<std::string> build_tools;
+        std::string project_root; // "" when nothing was found
+        std::string git_root;     // directory containing .git, or ""
+        bool shareable = true;    // false for $HOME and "/": children inherit nothing
+        bool watched = false;
     };
 
     mutable std::mutex cache_mutex_;
     std::unordered_map<std::string, CacheEntry> cache_;
+    std::list<std::string> lru_; // front = most recently used
+    size_t max_entries_ = 256;
+    std::chrono::milliseconds idle_ttl_{std::chrono::minutes(10)};
+    CacheStats stats_;
+    std::unordered_map<std::string, DirectoryNode> dir_index_;
+    // fingerprint -> rendered prompt, alive while some entry or caller holds it
+    std::unordered_map<std::uint64_t, std::weak_ptr<const std::string>> prompts_;
+    std::string home_dir_;
+    GitReader git_reader_;
+    LanguageScanner language_scanner_;
+    std::atomic<DirectoryCache*> directory_cache_{nullptr};
     std::chrono::seconds cache_ttl_{5};
+    std::atomic<std::chrono::milliseconds> git_status_ttl_{std::chrono::seconds(3)};
+    // Bumped on every invalidation so a detection racing with a change is
+    // not cached as watched
+    std::atomic<std::uint64_t> invalidation_epoch_{0};
+    // Background prefetch queue
+    std::mutex prefetch_mutex_;
+    std::condition_variable prefetch_cv_;
+    std::deque<std::string> prefetch_queue_;
+    bool stop_prefetch_ = false;
+    std::thread prefetch_thread_;
+
+    // Destroyed before the caches its callback touches
+    std::unique_ptr<ToolchainProbe> toolchain_probe_;
+    // Declared last: destroyed first, so no callback outlives the cache
+    std::unique_ptr<FileWatcher> watcher_;
+
+    // Valid entry for path or nullptr; expired entries are dropped. Counts
+    // toward the hit rate and refreshes the entry's LRU position.
+    const CacheEntry* find_cached_locked(const std::string& path);
+    void store_locked(const std::string& path, CacheEntry entry);
+    // Removes the entry, its LRU node and its watches
+    std::unordered_map<std::string, CacheEntry>::iterator
+    erase_entry_locked(std::unordered_map<std::string, CacheEntry>::iterator it);
+    bool is_expired(const CacheEntry& entry, std::chrono::steady_clock::time_point now) const;
+    bool git_status_stale(const CacheEntry& entry, std::chrono::steady_clock::time_point now) const;
+    // Cached info, and whether its git status is due for a refresh
+    std::optional<ProjectInfo> lookup_cached(const std::string& path, bool& git_stale);
+    ProjectInfo refresh_git_status(const std::string& path, ProjectInfo info);
+    Prompt prompt_for(const ProjectInfo& info);
+    void prefetch_loop();
+    static std::string render_prompt(const ProjectInfo& info);
+
+    bool watch_directory(const std::string& path, const std::string& git_root);
+    void on_file_event(const std::string& key, const std::string& directory,
+                       const std::string& name, FileWatcher::Event event);
+    void invalidate(const std::string& path);
+    // A process probe finished: fill in the entries that were waiting on it
+    void on_toolchain_ready();
+    // Drop the index nodes and cached contexts at or below directory
+    void invalidate_subtree(const std::string& directory);
+
+    // Ancestor walk: stops at a directory containing .git, at $HOME or at "/"
+    DirectoryNode resolve_directory(const std::string& path);
 
     // Helpers
+    static size_t entry_bytes(const std::string& path, const CacheEntry& entry);
+    static size_t node_bytes(const std::string& path, const DirectoryNode& node);
     std::string get_project_name(const std::string& path);
-    void detect_languages_and_tools(const std::string& path, ProjectInfo& info);
+    void detect_languages_and_tools(const std::string& path, const DirectoryNode& node,
+                                    ProjectInfo& info);
+    // listing, when given, answers the existence checks without stat()
+    static void collect_markers(const std::string& path, const DirectoryCache::Listing* listing,
+                                std::vector<std::string>& languages, std::vector<std::string>& build_tools);
     void detect_git_status(const std::string& path, ProjectInfo& info);
     
     // Signatures
-    bool has_file(const std::string& path, const std::string& filename);
     bool has_extension(const std::string& path, const std::string& ext);
 };
 
@@ -0,0 +1,883 @@
+#include "infrastructure/context/git_reader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace fs = std::filesystem;
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+constexpr size_t kRawShaSize = 20;
+constexpr size_t kHexShaSize = 40;
+constexpr int kMaxDeltaDepth = 64;
+
+std::optional<std::string> read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+std::string trim(const std::string& text) {
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    const auto end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string first_line(const std::string& text) {
+    return trim(text.substr(0, text.find('\n')));
+}
+
+std::int64_t mtime_ns(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return -1;
+    }
+    return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+bool is_hex_sha(const std::string& text) {
+    return text.size() == kHexShaSize &&
+           std::all_of(text.begin(), text.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
+}
+
+std::string to_hex(const unsigned char* raw) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(kHexShaSize, '0');
+    for (size_t i = 0; i < kRawShaSize; ++i) {
+        hex[2 * i] = digits[raw[i] >> 4];
+        hex[2 * i + 1] = digits[raw[i] & 0xf];
+    }
+    return hex;
+}
+
+bool to_raw(const std::string& hex, unsigned char* raw) {
+    if (!is_hex_sha(hex)) return false;
+    auto nibble = [](char c) {
+        return static_cast<unsigned char>(std::isdigit(static_cast<unsigned char>(c)) ? c - '0'
+                                                                                     : std::tolower(c) - 'a' + 10);
+    };
+    for (size_t i = 0; i < kRawShaSize; ++i) {
+        raw[i] = static_cast<unsigned char>(nibble(hex[2 * i]) << 4 | nibble(hex[2 * i + 1]));
+    }
+    return true;
+}
+
+std::uint32_t be32(const unsigned char* p) {
+    return static_cast<std::uint32_t>(p[0]) << 24 | static_cast<std::uint32_t>(p[1]) << 16 |
+           static_cast<std::uint32_t>(p[2]) << 8 | p[3];
+}
+
+std::uint16_t be16(const unsigned char* p) {
+    return static_cast<std::uint16_t>(p[0] << 8 | p[1]);
+}
+
+// Inflate a zlib stream. With expected > 0 the output size is known up
+// front (pack entries); otherwise the buffer grows (loose objects).
+bool inflate_zlib(const unsigned char* data, size_t length, size_t expected, std::string& out) {
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        return false;
+    }
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = static_cast<uInt>(std::min<size_t>(length, UINT32_MAX));
+
+    out.assign(expected > 0 ? expected : 4096, '\0');
+    size_t produced = 0;
+    int rc = Z_OK;
+    while (rc == Z_OK) {
+        if (produced == out.size()) {
+            if (expected > 0) break;
+            out.resize(out.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(&out[produced]);
+        stream.avail_out = static_cast<uInt>(out.size() - produced);
+        rc = inflate(&stream, Z_NO_FLUSH);
+        produced = out.size() - stream.avail_out;
+    }
+    inflateEnd(&stream);
+    out.resize(produced);
+    return rc == Z_STREAM_END || (expected > 0 && produced == expected);
+}
+
+bool read_varint(const std::string& data, size_t& pos, size_t& value) {
+    value = 0;
+    int shift = 0;
+    while (pos < data.size()) {
+        const auto byte = static_cast<unsigned char>(data[pos++]);
+        value |= static_cast<size_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+        shift += 7;
+    }
+    return false;
+}
+
+bool apply_delta(const std::string& base, const std::string& delta, std::string& out) {
+    size_t pos = 0, source_size = 0, target_size = 0;
+    if (!read_varint(delta, pos, source_size) || !read_varint(delta, pos, target_size) ||
+        source_size != base.size()) {
+        return false;
+    }
+
+    out.clear();
+    out.reserve(target_size);
+    while (pos < delta.size()) {
+        const auto op = static_cast<unsigned char>(delta[pos++]);
+        if (op & 0x80) {
+            size_t offset = 0, size = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (op & (1 << i)) {
+                    if (pos >= delta.size()) return false;
+                    offset |= static_cast<size_t>(static_cast<unsigned char>(delta[pos++])) << (8 * i);
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (op & (0x10 << i)) {
+                    if (pos >= delta.size()) return false;
+                    size |= static_cast<size_t>(static_cast<unsigned char>(delta[pos++])) << (8 * i);
+                }
+            }
+            if (size == 0) size = 0x10000;
+            if (offset + size > base.size()) return false;
+            out.append(base, offset, size);
+        } else if (op) {
+            if (pos + op > delta.size()) return false;
+            out.append(delta, pos, op);
+            pos += op;
+        } else {
+            return false;
+        }
+    }
+    return out.size() == target_size;
+}
+
+// Read-only mmap of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                data_ = static_cast<const unsigned char*>(map);
+                size_ = static_cast<size_t>(st.st_size);
+            }
+        }
+        close(fd);
+    }
+    ~MappedFile() {
+        if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+enum ObjectType { kCommit = 1, kTree = 2, kBlob = 3, kTag = 4, kOfsDelta = 6, kRefDelta = 7 };
+
+struct Object {
+    int type = 0;
+    std::string data;
+};
+
+// Loose objects plus v2 pack indexes, enough to read commits and trees
+class ObjectStore {
+public:
+    explicit ObjectStore(const std::string& common_dir) : objects_dir_(common_dir + "/objects") {
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator(objects_dir_ + "/pack", ec)) {
+            const auto path = entry.path();
+            if (path.extension() != ".idx") continue;
+            auto pack = std::make_unique<Pack>(path.string(), fs::path(path).replace_extension(".pack").string());
+            if (pack->valid()) packs_.push_back(std::move(pack));
+        }
+    }
+
+    std::optional<Object> read(const std::string& sha, int depth = 0) {
+        if (depth > kMaxDeltaDepth) return std::nullopt;
+        if (auto loose = read_loose(sha)) return loose;
+
+        unsigned char raw[kRawShaSize];
+        if (!to_raw(sha, raw)) return std::nullopt;
+        for (auto& pack : packs_) {
+            size_t offset = 0;
+            if (pack->find(raw, offset)) {
+                return read_packed(*pack, offset, depth);
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    struct Pack {
+        MappedFile idx;
+        MappedFile pack;
+        std::uint32_t count = 0;
+
+        Pack(const std::string& idx_path, const std::string& pack_path) : idx(idx_path), pack(pack_path) {
+            static const unsigned char kMagic[] = {0xff, 't', 'O', 'c', 0, 0, 0, 2};
+            if (idx.size() < 8 + 1024 || std::memcmp(idx.data(), kMagic, 8) != 0 || pack.size() < 12) {
+                count = 0;
+                return;
+            }
+            count = be32(idx.data() + 8 + 255 * 4);
+            const size_t needed = 8 + 1024 + static_cast<size_t>(count) * (kRawShaSize + 8);
+            if (idx.size() < needed) count = 0;
+        }
+
+        bool valid() const { return count > 0; }
+
+        bool find(const unsigned char* raw, size_t& offset) const {
+            const unsigned char* fanout = idx.data() + 8;
+            std::uint32_t lo = raw[0] ? be32(fanout + (raw[0] - 1) * 4) : 0;
+            std::uint32_t hi = be32(fanout + raw[0] * 4);
+            const unsigned char* shas = fanout + 1024;
+            while (lo < hi) {
+                const std::uint32_t mid = lo + (hi - lo) / 2;
+                const int cmp = std::memcmp(shas + static_cast<size_t>(mid) * kRawShaSize, raw, kRawShaSize);
+                if (cmp == 0) {
+                    const unsigned char* offsets = shas + static_cast<size_t>(count) * (kRawShaSize + 4);
+                    std::uint32_t small = be32(offsets + static_cast<size_t>(mid) * 4);
+                    if (small & 0x80000000u) {
+                        const unsigned char* large = offsets + static_cast<size_t>(count) * 4 +
+                                                     static_cast<size_t>(small & 0x7fffffffu) * 8;
+                        if (large + 8 > idx.data() + idx.size()) return false;
+                        offset = static_cast<size_t>(be32(large)) << 32 | be32(large + 4);
+                    } else {
+                        offset = small;
+                    }
+                    return offset < pack.size();
+                }
+                if (cmp < 0) lo = mid + 1;
+                else hi = mid;
+            }
+            return false;
+        }
+    };
+
+    std::string objects_dir_;
+    std::vector<std::unique_ptr<Pack>> packs_;
+
+    std::optional<Object> read_loose(const std::string& sha) {
+        const std::string path = objects_dir_ + "/" + sha.substr(0, 2) + "/" + sha.substr(2);
+        auto compressed = read_file(path);
+        if (!compressed) return std::nullopt;
+
+        std::string raw;
+        if (!inflate_zlib(reinterpret_cast<const unsigned char*>(compressed->data()), compressed->size(), 0, raw)) {
+            return std::nullopt;
+        }
+        const auto space = raw.find(' ');
+        const auto nul = raw.find('\0');
+        if (space == std::string::npos || nul == std::string::npos || space > nul) return std::nullopt;
+
+        const std::string kind = raw.substr(0, space);
+        Object object;
+        object.type = kind == "commit" ? kCommit : kind == "tree" ? kTree : kind == "blob" ? kBlob
+                    : kind == "tag" ? kTag : 0;
+        object.data = raw.substr(nul + 1);
+        return object;
+    }
+
+    std::optional<Object> read_packed(Pack& pack, size_t offset, int depth) {
+        const unsigned char* data = pack.pack.data();
+        const size_t size = pack.pack.size();
+        size_t pos = offset;
+        if (pos >= size) return std::nullopt;
+
+        unsigned char byte = data[pos++];
+        const int type = (byte >> 4) & 7;
+        size_t inflated_size = byte & 0x0f;
+        int shift = 4;
+        while (byte & 0x80) {
+            if (pos >= size) return std::nullopt;
+            byte = data[pos++];
+            inflated_size |= static_cast<size_t>(byte & 0x7f) << shift;
+            shift += 7;
+        }
+
+        std::optional<Object> base;
+        if (type == kOfsDelta) {
+            if (pos >= size) return std::nullopt;
+            byte = data[pos++];
+            size_t distance = byte & 0x7f;
+            while (byte & 0x80) {
+                if (pos >= size) return std::nullopt;
+                byte = data[pos++];
+                distance = ((distance + 1) << 7) | (byte & 0x7f);
+            }
+            if (distance > offset || depth >= kMaxDeltaDepth) return std::nullopt;
+            base = read_packed(pack, offset - distance, depth + 1);
+        } else if (type == kRefDelta) {
+            if (pos + kRawShaSize > size) return std::nullopt;
+            base = read(to_hex(data + pos), depth + 1);
+            pos += kRawShaSize;
+        }
+
+        Object object;
+        if (!inflate_zlib(data + pos, size - pos, inflated_size, object.data)) return std::nullopt;
+        if (type == kOfsDelta || type == kRefDelta) {
+            if (!base) return std::nullopt;
+            std::string patched;
+            if (!apply_delta(base->data, object.data, patched)) return std::nullopt;
+            object.type = base->type;
+            object.data = std::move(patched);
+        } else {
+            object.type = type;
+        }
+        return object;
+    }
+};
+
+struct Commit {
+    std::string tree;
+    std::vector<std::string> parents;
+    std::int64_t time = 0;
+};
+
+std::optional<Commit> read_commit(ObjectStore& store, const std::string& sha) {
+    auto object = store.read(sha);
+    if (!object || object->type != kCommit) return std::nullopt;
+
+    Commit commit;
+    std::istringstream stream(object->data);
+    std::string line;
+    while (std::getline(stream, line) && !line.empty()) {
+        if (line.rfind("tree ", 0) == 0) {
+            commit.tree = line.substr(5);
+        } else if (line.rfind("parent ", 0) == 0) {
+            commit.parents.push_back(line.substr(7));
+        } else if (line.rfind("committer ", 0) == 0) {
+            // "committer Name <mail> <timestamp> <tz>"
+            const auto gt = line.rfind('>');
+            if (gt != std::string::npos) {
+                try {
+                    commit.time = std::stoll(line.substr(gt + 1));
+                } catch (const std::exception&) {
+                    commit.time = 0;
+                }
+            }
+        }
+    }
+    return commit;
+}
+
+// Directory path ("" for the root, else "a/b") -> tree SHA, from the
+// index's cache-tree (TREE extension); only entries git still trusts
+using CacheTree = std::unordered_map<std::string, std::string>;
+
+// Flatten a tree into path -> blob SHA (gitlinks included), expanding only
+// the subtrees the cache-tree doesn't show unchanged; those go to
+// clean_dirs. Untouched subtrees of a large repository are never read.
+bool flatten_tree(ObjectStore& store, const std::string& sha, const std::string& dir, const CacheTree& cache_tree,
+                  std::unordered_set<std::string>& clean_dirs, std::unordered_map<std::string, std::string>& out) {
+    auto object = store.read(sha);
+    if (!object || object->type != kTree) return false;
+
+    const std::string& data = object->data;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        const auto space = data.find(' ', pos);
+        const auto nul = data.find('\0', space == std::string::npos ? pos : space);
+        if (space == std::string::npos || nul == std::string::npos || nul + 1 + kRawShaSize > data.size()) {
+            return false;
+        }
+        const std::string mode = data.substr(pos, space - pos);
+        const std::string name = data.substr(space + 1, nul - space - 1);
+        const std::string path = dir.empty() ? name : dir + "/" + name;
+        const std::string child = to_hex(reinterpret_cast<const unsigned char*>(data.data() + nul + 1));
+        pos = nul + 1 + kRawShaSize;
+
+        if (mode == "40000") {
+            auto cached = cache_tree.find(path);
+            if (cached != cache_tree.end() && cached->second == child) {
+                clean_dirs.insert(path);
+            } else if (!flatten_tree(store, child, path, cache_tree, clean_dirs, out)) {
+                return false;
+            }
+        } else {
+            out[path] = child;
+        }
+    }
+    return true;
+}
+
+struct IndexEntry {
+    std::string path;
+    std::string sha;
+    std::uint32_t mtime_sec = 0;
+    std::uint32_t mtime_nsec = 0;
+    std::uint32_t mode = 0;
+    std::uint32_t size = 0;
+    int stage = 0;
+    bool skip_worktree = false;
+};
+
+// One cache-tree node and, recursively, its subtrees: "<name>\0<entries>
+// <subtrees>\n", then the tree SHA unless entries is -1 (invalidated)
+bool parse_cache_tree(const unsigned char* data, size_t end, size_t& pos, const std::string& parent,
+                      int depth, CacheTree& out) {
+    if (depth > 256) return false;
+    const void* nul = std::memchr(data + pos, '\0', end - pos);
+    if (!nul) return false;
+    const size_t length = static_cast<const unsigned char*>(nul) - (data + pos);
+    const std::string name(reinterpret_cast<const char*>(data + pos), length);
+    const std::string path = parent.empty() ? name : parent + "/" + name;
+    pos += length + 1;
+
+    const void* newline = std::memchr(data + pos, '\n', end - pos);
+    if (!newline) return false;
+    const size_t header = static_cast<const unsigned char*>(newline) - (data + pos);
+    std::istringstream counts(std::string(reinterpret_cast<const char*>(data + pos), header));
+    long entries = 0;
+    long subtrees = 0;
+    if (!(counts >> entries >> subtrees) || subtrees < 0) return false;
+    pos += header + 1;
+
+    if (entries >= 0) {
+        if (end - pos < kRawShaSize) return false;
+        out[path] = to_hex(data + pos);
+        pos += kRawShaSize;
+    }
+    for (long i = 0; i < subtrees; ++i) {
+        if (!parse_cache_tree(data, end, pos, path, depth + 1, out)) return false;
+    }
+    return true;
+}
+
+// Parse index versions 2-4 (v4 prefix-compresses paths), and the
+// cache-tree extension into cache_tree when given
+bool parse_index(const std::string& path, std::vector<IndexEntry>& entries, CacheTree* cache_tree = nullptr) {
+    MappedFile file(path);
+    const unsigned char* data = file.data();
+    const size_t size = file.size();
+    if (!data || size < 12 || std::memcmp(data, "DIRC", 4) != 0) return false;
+
+    const std::uint32_t version = be32(data + 4);
+    const std::uint32_t count = be32(data + 8);
+    if (version < 2 || version > 4) return false;
+
+    entries.reserve(count);
+    size_t pos = 12;
+    std::string previous;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const size_t start = pos;
+        if (pos + 62 > size) return false;
+        IndexEntry entry;
+        entry.mtime_sec = be32(data + pos + 8);
+        entry.mtime_nsec = be32(data + pos + 12);
+        entry.mode = be32(data + pos + 24);
+        entry.size = be32(data + pos + 36);
+        entry.sha = to_hex(data + pos + 40);
+        const std::uint16_t flags = be16(data + pos + 60);
+        entry.stage = (flags >> 12) & 3;
+        pos += 62;
+        if (flags & 0x4000) {
+            if (version < 3 || pos + 2 > size) return false;
+            entry.skip_worktree = be16(data + pos) & 0x4000;
+            pos += 2;
+        }
+
+        if (version == 4) {
+            size_t strip = 0;
+            unsigned char byte;
+            do {
+                if (pos >= size) return false;
+                byte = data[pos++];
+                strip = (strip << 7) | (byte & 0x7f);
+                if (byte & 0x80) ++strip;
+            } while (byte & 0x80);
+            const void* nul = std::memchr(data + pos, '\0', size - pos);
+            if (!nul || strip > previous.size()) return false;
+            const size_t length = static_cast<const unsigned char*>(nul) - (data + pos);
+            entry.path = previous.substr(0, previous.size() - strip) +
+                         std::string(reinterpret_cast<const char*>(data + pos), length);
+            pos += length + 1;
+            previous = entry.path;
+        } else {
+            const void* nul = std::memchr(data + pos, '\0', size - pos);
+            if (!nul) return false;
+            const size_t length = static_cast<const unsigned char*>(nul) - (data + pos);
+            entry.path.assign(reinterpret_cast<const char*>(data + pos), length);
+            // Entries are NUL-padded to a multiple of 8 bytes
+            pos = start + ((pos + length - start + 8) & ~static_cast<size_t>(7));
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    // Extensions ("<signature><be32 size><data>") run up to the checksum
+    const size_t end = size >= pos + kRawShaSize ? size - kRawShaSize : pos;
+    while (cache_tree && end - pos >= 8) {
+        const size_t length = be32(data + pos + 4);
+        const size_t body = pos + 8;
+        if (length > end - body) break;
+        if (std::memcmp(data + pos, "TREE", 4) == 0) {
+            size_t at = body;
+            if (!parse_cache_tree(data, body + length, at, "", 0, *cache_tree)) cache_tree->clear();
+            break;
+        }
+        pos = body + length;
+    }
+    return true;
+}
+
+bool worktree_differs(const std::string& root, const IndexEntry& entry);
+
+// Conflicted paths plus stage-0 entries whose worktree file differs
+int count_modified(const std::string& root, const std::vector<IndexEntry>& entries) {
+    int modified = 0;
+    std::unordered_set<std::string> conflicted;
+    for (const auto& entry : entries) {
+        if (entry.stage != 0) {
+            if (conflicted.insert(entry.path).second) ++modified;
+            continue;
+        }
+        // Gitlinks (submodules) are directories; their state is their own
+        const bool gitlink = (entry.mode & 0170000) == 0160000;
+        if (!gitlink && !entry.skip_worktree && worktree_differs(root, entry)) {
+            ++modified;
+        }
+    }
+    return modified;
+}
+
+bool worktree_differs(const std::string& root, const IndexEntry& entry) {
+    struct stat st;
+    if (lstat((root + "/" + entry.path).c_str(), &st) != 0) {
+        return true; // deleted
+    }
+    if (static_cast<std::uint32_t>(st.st_size) != entry.size ||
+        static_cast<std::uint32_t>(st.st_mtim.tv_sec) != entry.mtime_sec ||
+        static_cast<std::uint32_t>(st.st_mtim.tv_nsec) != entry.mtime_nsec) {
+        return true;
+    }
+    // Executable bit flips are modifications too
+    const bool index_exec = entry.mode & 0100;
+    return S_ISREG(st.st_mode) && index_exec != static_cast<bool>(st.st_mode & S_IXUSR);
+}
+
+// Ahead/behind by painting both tips' ancestry in commit-time order; stops
+// once every queued commit is reachable from both sides.
+bool count_divergence(ObjectStore& store, const std::string& local, const std::string& upstream,
+                      size_t limit, int& ahead, int& behind) {
+    if (local == upstream) {
+        ahead = behind = 0;
+        return true;
+    }
+
+    constexpr unsigned kLocal = 1, kUpstream = 2, kBoth = 3;
+    std::unordered_map<std::string, unsigned> flags;
+    std::unordered_map<std::string, Commit> commits;
+    // Newest first; a commit is queued at most once at a time
+    std::set<std::pair<std::int64_t, std::string>, std::greater<>> queue;
+    size_t pending = 0; // queued commits not yet marked from both sides
+
+    auto enqueue = [&](const std::string& sha, unsigned add) -> bool {
+        auto it = commits.find(sha);
+        if (it == commits.end()) {
+            auto commit = read_commit(store, sha);
+            if (!commit) return false;
+            it = commits.emplace(sha, std::move(*commit)).first;
+        }
+        unsigned& mark = flags[sha];
+        const unsigned updated = mark | add;
+        if (updated == mark) return true;
+
+        const bool inserted = queue.emplace(it->second.time, sha).second;
+        if (inserted && updated != kBoth) ++pending;
+        if (!inserted && mark != kBoth && updated == kBoth) --pending;
+        mark = updated;
+        return true;
+    };
+
+    if (!enqueue(local, kLocal) || !enqueue(upstream, kUpstream)) return false;
+
+    size_t visited = 0;
+    while (!queue.empty() && pending > 0) {
+        if (++visited > limit) return false;
+        const std::string sha = queue.begin()->second;
+        queue.erase(queue.begin());
+        const unsigned mark = flags[sha];
+        if (mark != kBoth) --pending;
+        for (const auto& parent : commits[sha].parents) {
+            if (!enqueue(parent, mark)) return false;
+        }
+    }
+
+    ahead = behind = 0;
+    for (const auto& [sha, mark] : flags) {
+        if (mark == kLocal) ++ahead;
+        else if (mark == kUpstream) ++behind;
+    }
+    return true;
+}
+
+struct Tracking {
+    std::string remote;
+    std::string merge; // refs/heads/... on the remote
+};
+
+// [branch "name"] remote/merge from the repository config
+std::optional<Tracking> read_tracking(const std::string& config_path, const std::string& branch) {
+    auto config = read_file(config_path);
+    if (!config) return std::nullopt;
+
+    const std::string wanted = "[branch \"" + branch + "\"]";
+    std::istringstream stream(*config);
+    std::string line;
+    bool in_section = false;
+    Tracking tracking;
+    while (std::getline(stream, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+        if (line[0] == '[') {
+            in_section = line == wanted;
+            continue;
+        }
+        if (!in_section) continue;
+        const auto eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = trim(line.substr(0, eq));
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return std::tolower(c); });
+        const std::string value = trim(line.substr(eq + 1));
+        if (key == "remote") tracking.remote = value;
+        else if (key == "merge") tracking.merge = value;
+    }
+    if (tracking.remote.empty() || tracking.merge.empty()) return std::nullopt;
+    return tracking;
+}
+
+// Local ref holding the upstream tip, e.g. refs/remotes/origin/main
+std::string upstream_ref(const Tracking& tracking) {
+    if (tracking.remote == ".") return tracking.merge;
+    const std::string heads = "refs/heads/";
+    const std::string name = tracking.merge.rfind(heads, 0) == 0 ? tracking.merge.substr(heads.size())
+                                                                  : tracking.merge;
+    return "refs/remotes/" + tracking.remote + "/" + name;
+}
+
+} // namespace
+
+std::optional<GitReader::Layout> GitReader::locate(const std::string& root) {
+    const std::string dot_git = root + "/.git";
+    std::error_code ec;
+    Layout layout;
+    if (fs::is_directory(dot_git, ec)) {
+        layout.git_dir = dot_git;
+    } else if (fs::is_regular_file(dot_git, ec)) {
+        // Worktrees and submodules: ".git" is a file "gitdir: <path>"
+        auto content = read_file(dot_git);
+        const std::string prefix = "gitdir:";
+        if (!content || content->rfind(prefix, 0) != 0) return std::nullopt;
+        fs::path target = trim(first_line(*content).substr(prefix.size()));
+        if (target.is_relative()) target = fs::path(root) / target;
+        layout.git_dir = target.lexically_normal().string();
+    } else {
+        return std::nullopt;
+    }
+
+    layout.common_dir = layout.git_dir;
+    if (auto common = read_file(layout.git_dir + "/commondir")) {
+        fs::path target = first_line(*common);
+        if (target.is_relative()) target = fs::path(layout.git_dir) / target;
+        layout.common_dir = target.lexically_normal().string();
+    }
+    while (layout.git_dir.size() > 1 && layout.git_dir.back() == '/') layout.git_dir.pop_back();
+    while (layout.common_dir.size() > 1 && layout.common_dir.back() == '/') layout.common_dir.pop_back();
+
+    if (!fs::exists(layout.git_dir + "/HEAD", ec)) return std::nullopt;
+    return layout;
+}
+
+std::string GitReader::resolve_ref(const Layout& layout, const std::string& ref) {
+    std::string name = ref;
+    for (int depth = 0; depth < 5; ++depth) {
+        // HEAD-like refs live per worktree, the rest in the common dir
+        const bool per_worktree = name.find('/') == std::string::npos;
+        auto loose = read_file((per_worktree ? layout.git_dir : layout.common_dir) + "/" + name);
+        if (loose) {
+            const std::string value = first_line(*loose);
+            if (value.rfind("ref: ", 0) == 0) {
+                name = trim(value.substr(5));
+                continue;
+            }
+            return is_hex_sha(value) ? value : "";
+        }
+
+        auto packed = read_file(layout.common_dir + "/packed-refs");
+        if (!packed) return "";
+        std::istringstream stream(*packed);
+        std::string line;
+        while (std::getline(stream, line)) {
+            if (line.empty() || line[0] == '#' || line[0] == '^') continue;
+            const auto space = line.find(' ');
+            if (space != std::string::npos && trim(line.substr(space + 1)) == name) {
+                const std::string sha = line.substr(0, space);
+                return is_hex_sha(sha) ? sha : "";
+            }
+        }
+        return "";
+    }
+    return "";
+}
+
+GitReader::Status GitReader::read(const std::string& root) {
+    Status status;
+    auto layout = locate(root);
+    if (!layout) {
+        return status;
+    }
+    status.is_repo = true;
+
+    // Cheap part first: HEAD and tracking config decide which files to stamp
+    const std::string head = first_line(read_file(layout->git_dir + "/HEAD").value_or(""));
+    std::string branch_ref;
+    if (head.rfind("ref: ", 0) == 0) {
+        branch_ref = trim(head.substr(5));
+        const std::string heads = "refs/heads/";
+        status.branch = branch_ref.rfind(heads, 0) == 0 ? branch_ref.substr(heads.size()) : branch_ref;
+    }
+
+    const std::string config_path = layout->common_dir + "/config";
+    std::optional<Tracking> tracking;
+    if (!status.branch.empty()) {
+        tracking = read_tracking(config_path, status.branch);
+    }
+    const std::string tracking_ref = tracking ? upstream_ref(*tracking) : "";
+
+    std::vector<std::int64_t> stamps = {
+        mtime_ns(layout->git_dir + "/HEAD"),
+        mtime_ns(layout->git_dir + "/index"),
+        mtime_ns(layout->common_dir + "/packed-refs"),
+        mtime_ns(config_path),
+        branch_ref.empty() ? 0 : mtime_ns(layout->common_dir + "/" + branch_ref),
+        tracking_ref.empty() ? 0 : mtime_ns(layout->common_dir + "/" + tracking_ref),
+    };
+    const auto now = std::chrono::steady_clock::now();
+    std::optional<Status> unchanged;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto cached = cache_.find(root);
+        if (cached != cache_.end() && cached->second.stamps == stamps) {
+            if (now - cached->second.checked < worktree_ttl_) {
+                return cached->second.status;
+            }
+            unchanged = cached->second.status;
+        }
+    }
+    if (unchanged) {
+        // Only worktree files may have changed: re-stat them against the
+        // index, without walking trees or history again
+        std::vector<IndexEntry> entries;
+        if (parse_index(layout->git_dir + "/index", entries)) {
+            unchanged->modified = count_modified(root, entries);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_[root] = CachedStatus{std::move(stamps), *unchanged, now};
+        return *unchanged;
+    }
+
+    status.head = branch_ref.empty() ? (is_hex_sha(head) ? head : "") : resolve_ref(*layout, branch_ref);
+
+    ObjectStore store(layout->common_dir);
+
+    std::vector<IndexEntry> entries;
+    CacheTree cache_tree;
+    if (parse_index(layout->git_dir + "/index", entries, &cache_tree)) {
+        status.modified = count_modified(root, entries);
+
+        // HEAD's tree, minus the directories the index has unchanged. When
+        // it can't be read (e.g. objects missing from a partial clone) the
+        // staged count is unknown rather than "everything".
+        std::unordered_map<std::string, std::string> head_tree;
+        std::unordered_set<std::string> clean_dirs;
+        bool head_known = status.head.empty(); // unborn: nothing committed
+        if (!status.head.empty()) {
+            if (auto commit = read_commit(store, status.head)) {
+                auto root_entry = cache_tree.find("");
+                if (root_entry != cache_tree.end() && root_entry->second == commit->tree) {
+                    clean_dirs.insert("");
+                    head_known = true;
+                } else {
+                    head_known = flatten_tree(store, commit->tree, "", cache_tree, clean_dirs, head_tree);
+                }
+            }
+        }
+
+        auto in_clean_dir = [&clean_dirs](const std::string& path) {
+            if (clean_dirs.count("")) return true;
+            for (size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+                if (clean_dirs.count(path.substr(0, slash))) return true;
+            }
+            return false;
+        };
+
+        if (!head_known) {
+            status.staged = -1;
+        } else if (!clean_dirs.count("")) {
+            std::unordered_set<std::string> indexed;
+            for (const auto& entry : entries) {
+                if (!clean_dirs.empty() && in_clean_dir(entry.path)) {
+                    continue;
+                }
+                indexed.insert(entry.path);
+                if (entry.stage != 0) {
+                    continue;
+                }
+                auto in_head = head_tree.find(entry.path);
+                if (in_head == head_tree.end() || in_head->second != entry.sha) {
+                    ++status.staged; // added or changed
+                }
+            }
+            // HEAD paths missing from the index are staged deletions
+            for (const auto& [path, sha] : head_tree) {
+                if (!indexed.count(path)) ++status.staged;
+            }
+        }
+    }
+
+    if (tracking) {
+        const std::string upstream_sha = resolve_ref(*layout, tracking_ref);
+        const std::string prefix = "refs/remotes/";
+        status.upstream = tracking_ref.rfind(prefix, 0) == 0 ? tracking_ref.substr(prefix.size()) : tracking_ref;
+        if (!status.head.empty() && !upstream_sha.empty()) {
+            int ahead = 0, behind = 0;
+            if (count_divergence(store, status.head, upstream_sha, walk_limit_, ahead, behind)) {
+                status.ahead = ahead;
+                status.behind = behind;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_[root] = CachedStatus{std::move(stamps), status, now};
+    return status;
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,78 @@
+#ifndef COLABB_GIT_READER_HPP
+#define COLABB_GIT_READER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Reads repository state straight from .git without spawning git.
+ *
+ * Understands HEAD, loose refs, packed-refs, "gitdir:" files (worktrees and
+ * submodules), the index (v2-v4) and loose/packed objects, which is enough
+ * for branch, dirty counts and upstream ahead/behind. Staged changes are
+ * found by comparing HEAD's tree with the index, skipping every directory
+ * whose tree the index's cache-tree still matches. Results are cached
+ * per repository and reused until the mtime of the index, HEAD, config,
+ * packed-refs or one of the refs involved changes. Worktree edits touch
+ * none of those, so once the result is older than the worktree TTL the
+ * modified count alone is refreshed (a stat per index entry). Reading can
+ * be slow on large repositories; call it off the UI thread.
+ */
+class GitReader {
+public:
+    struct Status {
+        bool is_repo = false;
+        std::string branch;   // empty when HEAD is detached
+        std::string head;     // full SHA of HEAD, empty on an unborn branch
+        std::string upstream; // e.g. "origin/main", empty without tracking
+        int staged = 0;       // index entries differing from HEAD's tree; -1 if
+                              // that tree couldn't be read
+        int modified = 0;     // index entries whose worktree stat differs
+        int ahead = -1;       // -1: no upstream, or the history walk gave up
+        int behind = -1;
+    };
+
+    struct Layout {
+        std::string git_dir;    // per worktree: HEAD, index
+        std::string common_dir; // shared: refs, packed-refs, objects, config
+    };
+
+    // Resolve root/.git, following a "gitdir:" file and commondir
+    static std::optional<Layout> locate(const std::string& root);
+
+    // Full SHA a ref points to (loose first, then packed-refs), following
+    // symbolic refs. Empty when it does not exist.
+    static std::string resolve_ref(const Layout& layout, const std::string& ref);
+
+    Status read(const std::string& root);
+
+    // Commits visited per ahead/behind computation before giving up
+    void set_walk_limit(size_t limit) { walk_limit_ = limit; }
+    // How long a modified count is trusted without re-stat'ing the worktree
+    void set_worktree_ttl(std::chrono::milliseconds ttl) { worktree_ttl_ = ttl; }
+
+private:
+    struct CachedStatus {
+        std::vector<std::int64_t> stamps;
+        Status status;
+        std::chrono::steady_clock::time_point checked;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, CachedStatus> cache_;
+    size_t walk_limit_ = 20000;
+    std::chrono::milliseconds worktree_ttl_{std::chrono::seconds(3)};
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_GIT_READER_HPP
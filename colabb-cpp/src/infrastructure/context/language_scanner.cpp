@@ -0,0 +1,260 @@
+#include "infrastructure/context/language_scanner.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <fnmatch.h>
+
+namespace fs = std::filesystem;
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+struct ExtensionWeight {
+    const char* extension;
+    const char* language;
+    double weight;
+};
+
+// Headers, scripts and configs count less than sources: a C project has
+// plenty of .h files and most repos carry a few shell scripts.
+constexpr ExtensionWeight kExtensions[] = {
+    {".c", "C/C++", 1.0},   {".cc", "C/C++", 1.0},  {".cpp", "C/C++", 1.0}, {".cxx", "C/C++", 1.0},
+    {".h", "C/C++", 0.5},   {".hh", "C/C++", 0.5},  {".hpp", "C/C++", 0.5},
+    {".py", "Python", 1.0}, {".pyi", "Python", 0.3},
+    {".js", "JavaScript/TypeScript", 1.0}, {".jsx", "JavaScript/TypeScript", 1.0},
+    {".ts", "JavaScript/TypeScript", 1.0}, {".tsx", "JavaScript/TypeScript", 1.0},
+    {".mjs", "JavaScript/TypeScript", 1.0},
+    {".rs", "Rust", 1.0},   {".go", "Go", 1.0},     {".java", "Java", 1.0}, {".kt", "Kotlin", 1.0},
+    {".cs", "C#", 1.0},     {".rb", "Ruby", 1.0},   {".php", "PHP", 1.0},   {".swift", "Swift", 1.0},
+    {".lua", "Lua", 1.0},   {".sh", "Shell", 0.3},  {".bash", "Shell", 0.3}, {".zsh", "Shell", 0.3},
+};
+
+struct IgnoreLayer {
+    std::string base; // directory holding the .gitignore, with trailing '/'
+    LanguageScanner::IgnoreRules rules;
+};
+
+using IgnoreStack = std::shared_ptr<const std::vector<IgnoreLayer>>;
+
+// Deeper .gitignore files take precedence over their parents'
+bool is_ignored(const IgnoreStack& stack, const std::string& path, bool is_dir) {
+    if (!stack) return false;
+    for (auto layer = stack->rbegin(); layer != stack->rend(); ++layer) {
+        if (path.compare(0, layer->base.size(), layer->base) != 0) continue;
+        const int verdict = layer->rules.match(path.substr(layer->base.size()), is_dir);
+        if (verdict >= 0) return verdict == 1;
+    }
+    return false;
+}
+
+struct PendingDir {
+    std::string path;
+    int depth;
+    IgnoreStack ignores;
+};
+
+} // namespace
+
+std::pair<const char*, double> LanguageScanner::classify(const std::string& extension) {
+    for (const auto& entry : kExtensions) {
+        if (extension == entry.extension) {
+            return {entry.language, entry.weight};
+        }
+    }
+    return {nullptr, 0.0};
+}
+
+std::vector<std::string> LanguageScanner::Result::languages(double min_share) const {
+    double total = 0;
+    for (const auto& [language, score] : scores) total += score;
+
+    std::vector<std::string> names;
+    for (const auto& [language, score] : scores) {
+        if (total > 0 && score / total >= min_share) {
+            names.push_back(language);
+        }
+    }
+    return names;
+}
+
+void LanguageScanner::IgnoreRules::parse(const std::string& content) {
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        Rule rule;
+        if (line[0] == '!') {
+            rule.negate = true;
+            line.erase(0, 1);
+        } else if (line[0] == '\\') {
+            line.erase(0, 1);
+        }
+        if (!line.empty() && line.back() == '/') {
+            rule.dir_only = true;
+            line.pop_back();
+        }
+        if (line.rfind("**/", 0) == 0) {
+            line.erase(0, 3);
+        }
+        if (line.find('/') != std::string::npos) {
+            rule.anchored = true;
+            if (line[0] == '/') line.erase(0, 1);
+        }
+        if (line.empty()) continue;
+        rule.pattern = line;
+        rules_.push_back(std::move(rule));
+    }
+}
+
+int LanguageScanner::IgnoreRules::match(const std::string& relative_path, bool is_dir) const {
+    const auto slash = relative_path.rfind('/');
+    const std::string name = slash == std::string::npos ? relative_path : relative_path.substr(slash + 1);
+
+    for (auto rule = rules_.rbegin(); rule != rules_.rend(); ++rule) {
+        if (rule->dir_only && !is_dir) continue;
+
+        bool matched;
+        if (!rule->anchored) {
+            matched = fnmatch(rule->pattern.c_str(), name.c_str(), 0) == 0;
+        } else if (rule->pattern.size() > 3 &&
+                   rule->pattern.compare(rule->pattern.size() - 3, 3, "/**") == 0) {
+            const std::string prefix = rule->pattern.substr(0, rule->pattern.size() - 2);
+            matched = relative_path.compare(0, prefix.size(), prefix) == 0;
+        } else {
+            matched = fnmatch(rule->pattern.c_str(), relative_path.c_str(), FNM_PATHNAME) == 0;
+        }
+        if (matched) {
+            return rule->negate ? 0 : 1;
+        }
+    }
+    return -1;
+}
+
+LanguageScanner::Result LanguageScanner::scan(const std::string& root) const {
+    const auto deadline = std::chrono::steady_clock::now() + options_.time_budget;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<PendingDir> queue;
+    unsigned active = 0;
+    std::atomic<bool> stop{false};
+    std::atomic<bool> partial{false};
+    std::atomic<size_t> entries{0};
+    std::unordered_map<std::string, double> totals;
+
+    queue.push_back(PendingDir{root, 0, nullptr});
+
+    auto process = [&](const PendingDir& dir, std::unordered_map<std::string, double>& scores) {
+        IgnoreStack ignores = dir.ignores;
+        const std::string base = dir.path.back() == '/' ? dir.path : dir.path + "/";
+        std::ifstream gitignore(base + ".gitignore");
+        if (gitignore.is_open()) {
+            std::ostringstream content;
+            content << gitignore.rdbuf();
+            auto layers = std::make_shared<std::vector<IgnoreLayer>>(ignores ? *ignores : std::vector<IgnoreLayer>{});
+            layers->push_back(IgnoreLayer{base, {}});
+            layers->back().rules.parse(content.str());
+            ignores = layers;
+        }
+
+        std::error_code ec;
+        fs::directory_iterator it(dir.path, fs::directory_options::skip_permission_denied, ec);
+        size_t seen = 0;
+        for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+            if (stop.load(std::memory_order_relaxed)) return;
+            // readdir order is effectively hashed on most filesystems, so the
+            // first entries of a huge directory are a fair sample
+            if (++seen > options_.max_entries_per_dir) {
+                partial = true;
+                return;
+            }
+            if (entries.fetch_add(1, std::memory_order_relaxed) >= options_.max_entries ||
+                ((seen & 63) == 0 && std::chrono::steady_clock::now() >= deadline)) {
+                partial = true;
+                stop = true;
+                return;
+            }
+
+            const auto& entry = *it;
+            const std::string name = entry.path().filename().string();
+            if (name == ".git") continue;
+            std::error_code type_ec;
+            if (entry.is_symlink(type_ec)) continue;
+
+            const std::string path = base + name;
+            if (entry.is_directory(type_ec)) {
+                if (dir.depth < options_.max_depth && !is_ignored(ignores, path, true)) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.push_back(PendingDir{path, dir.depth + 1, ignores});
+                    cv.notify_one();
+                }
+            } else if (entry.is_regular_file(type_ec)) {
+                const auto [language, weight] = classify(entry.path().extension().string());
+                if (language && !is_ignored(ignores, path, false)) {
+                    scores[language] += weight;
+                }
+            }
+        }
+    };
+
+    auto worker = [&]() {
+        std::unordered_map<std::string, double> scores;
+        while (true) {
+            PendingDir dir;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait_until(lock, deadline, [&] { return stop || !queue.empty() || active == 0; });
+                if (stop || queue.empty() || std::chrono::steady_clock::now() >= deadline) {
+                    if (!queue.empty()) partial = true;
+                    stop = true;
+                    cv.notify_all();
+                    break;
+                }
+                dir = std::move(queue.front());
+                queue.pop_front();
+                ++active;
+            }
+            process(dir, scores);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --active;
+            }
+            cv.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [language, score] : scores) totals[language] += score;
+    };
+
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < std::max(1u, options_.threads); ++i) {
+        helpers.emplace_back(worker);
+    }
+    worker();
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+
+    Result result;
+    result.scores.assign(totals.begin(), totals.end());
+    std::sort(result.scores.begin(), result.scores.end(),
+              [](const auto& a, const auto& b) { return a.second > b.second || (a.second == b.second && a.first < b.first); });
+    result.entries_scanned = std::min(entries.load(), options_.max_entries);
+    result.partial = partial;
+    return result;
+}
+
+} // namespace infrastructure
+} // namespace colabb
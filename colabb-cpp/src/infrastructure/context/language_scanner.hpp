@@ -0,0 +1,81 @@
+#ifndef COLABB_LANGUAGE_SCANNER_HPP
+#define COLABB_LANGUAGE_SCANNER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Bounded, parallel guess of a directory's languages from file
+ * extensions.
+ *
+ * Walks breadth-first up to max_depth on a few worker threads, looks at no
+ * more than max_entries_per_dir entries of any one directory (sampling huge
+ * directories) and max_entries overall, honours .gitignore files along the
+ * way and stops at the deadline. Whatever was counted by then is returned,
+ * flagged as partial.
+ */
+class LanguageScanner {
+public:
+    struct Options {
+        int max_depth = 3;
+        size_t max_entries = 5000;
+        size_t max_entries_per_dir = 500;
+        std::chrono::milliseconds time_budget{150};
+        unsigned threads = 4;
+        // Languages below this share of the total weight are dropped
+        double min_share = 0.1;
+    };
+
+    struct Result {
+        // Highest score first
+        std::vector<std::pair<std::string, double>> scores;
+        size_t entries_scanned = 0;
+        bool partial = false;
+
+        std::vector<std::string> languages(double min_share) const;
+    };
+
+    LanguageScanner() = default;
+    explicit LanguageScanner(Options options) : options_(options) {}
+
+    const Options& options() const { return options_; }
+    Result scan(const std::string& root) const;
+
+    // Language and weight for a file extension (with the dot); weight 0
+    // when the extension says nothing
+    static std::pair<const char*, double> classify(const std::string& extension);
+
+    // .gitignore matching, exposed for tests. Rules are tried in order and
+    // the last match wins; relative_path is relative to the .gitignore's
+    // directory.
+    class IgnoreRules {
+    public:
+        void parse(const std::string& content);
+        // 1 ignored, 0 re-included (!pattern), -1 no rule matched
+        int match(const std::string& relative_path, bool is_dir) const;
+        bool empty() const { return rules_.empty(); }
+
+    private:
+        struct Rule {
+            std::string pattern;
+            bool negate = false;
+            bool dir_only = false;
+            bool anchored = false; // contains a '/': match the whole relative path
+        };
+        std::vector<Rule> rules_;
+    };
+
+private:
+    Options options_;
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_LANGUAGE_SCANNER_HPP
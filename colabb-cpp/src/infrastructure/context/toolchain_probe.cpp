@@ -0,0 +1,368 @@
+#include "infrastructure/context/toolchain_probe.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+std::string trim(const std::string& text) {
+    const auto begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    const auto end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string unquote(std::string text) {
+    text = trim(text);
+    if (text.size() >= 2 && (text.front() == '"' || text.front() == '\'') && text.back() == text.front()) {
+        return text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+std::string parse_first_line(const std::string& content) {
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        line = trim(line);
+        if (!line.empty() && line[0] != '#') return line;
+    }
+    return "";
+}
+
+// "key = value" lookup in simple INI/TOML-ish content
+std::string find_key(const std::string& content, const std::string& key) {
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+        const auto eq = line.find('=');
+        if (eq != std::string::npos && trim(line.substr(0, eq)) == key) {
+            return unquote(line.substr(eq + 1));
+        }
+    }
+    return "";
+}
+
+std::int64_t mtime_of(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return -1;
+    }
+    return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+// Resolve a command through this process's PATH (the shell's PATH may
+// differ, e.g. after activating a venv; version files cover that case)
+std::string resolve_binary(const std::string& command) {
+    if (command.find('/') != std::string::npos) {
+        return access(command.c_str(), X_OK) == 0 ? command : "";
+    }
+    const char* path = std::getenv("PATH");
+    std::istringstream dirs(path ? path : "/usr/local/bin:/usr/bin:/bin");
+    std::string dir;
+    while (std::getline(dirs, dir, ':')) {
+        if (dir.empty()) continue;
+        const std::string candidate = dir + "/" + command;
+        struct stat st;
+        if (stat(candidate.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(candidate.c_str(), X_OK) == 0) {
+            return candidate;
+        }
+    }
+    return "";
+}
+
+// "ccache g++" -> {"ccache", "g++"}; $CXX is split on blanks like make does
+std::vector<std::string> split_command(const std::string& command) {
+    std::istringstream stream(command);
+    std::vector<std::string> words;
+    std::string word;
+    while (stream >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// First non-empty line of argv's combined stdout/stderr; "" when it can't
+// be spawned or exits with an error. argv[0] is a path: no shell, no PATH.
+std::string first_output_line(const std::vector<std::string>& argv) {
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return "";
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDERR_FILENO);
+    std::vector<char*> args;
+    for (const auto& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    pid_t pid = -1;
+    const int spawned = posix_spawn(&pid, args[0], &actions, nullptr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(fds[1]);
+
+    std::string output;
+    if (spawned == 0) {
+        // Read to the end so the child never blocks on a full pipe
+        char buffer[512];
+        while (true) {
+            const ssize_t n = read(fds[0], buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            if (output.size() < 4096) output.append(buffer, static_cast<size_t>(n));
+        }
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            output.clear();
+        }
+    }
+    close(fds[0]);
+    return parse_first_line(output);
+}
+
+std::string strip_prefix(const std::string& text, const std::string& prefix) {
+    return text.rfind(prefix, 0) == 0 ? text.substr(prefix.size()) : text;
+}
+
+bool has_language(const std::vector<std::string>& languages, const std::string& needle) {
+    return std::any_of(languages.begin(), languages.end(),
+                       [&](const std::string& lang) { return lang.find(needle) != std::string::npos; });
+}
+
+} // namespace
+
+ToolchainProbe::ToolchainProbe(ReadyCallback on_ready)
+    : on_ready_(std::move(on_ready)) {
+    worker_ = std::thread(&ToolchainProbe::run, this);
+}
+
+ToolchainProbe::~ToolchainProbe() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void ToolchainProbe::set_process_probes_enabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    process_probes_enabled_ = enabled;
+}
+
+void ToolchainProbe::set_failed_probe_retry(std::chrono::milliseconds delay) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failed_probe_retry_ = delay;
+}
+
+std::string ToolchainProbe::parse_rust_toolchain(const std::string& content) {
+    const std::string channel = find_key(content, "channel");
+    if (!channel.empty()) return channel;
+    // Legacy rust-toolchain: the whole file is the channel name
+    return content.find('[') == std::string::npos ? parse_first_line(content) : "";
+}
+
+std::string ToolchainProbe::parse_pyvenv_version(const std::string& content) {
+    const std::string version = find_key(content, "version");
+    if (!version.empty()) return version;
+    // Older virtualenv: "version_info = 3.11.4.final.0"
+    std::string info = find_key(content, "version_info");
+    size_t dots = 0;
+    for (size_t i = 0; i < info.size(); ++i) {
+        if (info[i] == '.' && ++dots == 3) return info.substr(0, i);
+    }
+    return info;
+}
+
+std::string ToolchainProbe::parse_go_version(const std::string& content) {
+    std::istringstream stream(content);
+    std::string line, go;
+    while (std::getline(stream, line)) {
+        line = trim(line);
+        if (line.rfind("toolchain ", 0) == 0) return strip_prefix(trim(line.substr(10)), "go");
+        if (line.rfind("go ", 0) == 0) go = trim(line.substr(3));
+    }
+    return go;
+}
+
+std::string ToolchainProbe::read_value(const std::string& path, std::string (*parse)(const std::string&)) {
+    const std::int64_t mtime = mtime_of(path);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(path);
+        if (it != files_.end() && it->second.mtime == mtime) {
+            return it->second.value;
+        }
+    }
+
+    std::string value;
+    if (mtime >= 0) {
+        std::ifstream file(path);
+        std::ostringstream content;
+        content << file.rdbuf();
+        value = parse(content.str());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_[path] = FileValue{mtime, value};
+    return value;
+}
+
+std::string ToolchainProbe::process_version(const std::string& command, bool& pending) {
+    std::vector<std::string> words = split_command(command);
+    if (words.empty()) {
+        return "";
+    }
+    const std::string binary = resolve_binary(words.front());
+    if (binary.empty()) {
+        return "";
+    }
+    const std::int64_t mtime = mtime_of(binary);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& cached = processes_[command];
+    if (cached.running) {
+        pending = true;
+        return "";
+    }
+    const bool retry = cached.failed &&
+                       std::chrono::steady_clock::now() - cached.finished >= failed_probe_retry_;
+    if (cached.binary_path == binary && cached.mtime == mtime && !retry) {
+        return cached.version;
+    }
+    if (!process_probes_enabled_) {
+        return "";
+    }
+
+    cached.binary_path = binary;
+    cached.arguments.assign(words.begin() + 1, words.end());
+    cached.mtime = mtime;
+    cached.version.clear();
+    cached.running = true;
+    queue_.push_back(command);
+    cv_.notify_one();
+    pending = true;
+    return "";
+}
+
+std::vector<ToolchainProbe::Entry> ToolchainProbe::probe(const std::string& cwd, const std::string& project_root,
+                                                         const std::vector<std::string>& languages, bool* pending) {
+    // Nearest version file wins: cwd first, then each parent up to the root
+    std::vector<std::string> dirs{cwd};
+    if (!project_root.empty() && cwd.size() > project_root.size() && cwd.rfind(project_root + "/", 0) == 0) {
+        std::string dir = cwd;
+        while (dir.size() > project_root.size()) {
+            dir = dir.substr(0, dir.rfind('/'));
+            dirs.push_back(dir.empty() ? "/" : dir);
+        }
+    }
+    auto nearest = [&](std::initializer_list<const char*> names, std::string (*parse)(const std::string&)) {
+        for (const auto& dir : dirs) {
+            for (const char* name : names) {
+                std::string value = read_value(dir + "/" + name, parse);
+                if (!value.empty()) return value;
+            }
+        }
+        return std::string();
+    };
+
+    std::vector<Entry> entries;
+    bool waiting = false;
+
+    std::string python;
+    for (const auto& dir : dirs) {
+        for (const char* venv : {".venv", "venv", "env"}) {
+            const std::string version = read_value(dir + "/" + venv + "/pyvenv.cfg", &parse_pyvenv_version);
+            if (!version.empty()) {
+                python = version + " (venv " + venv + ")";
+                break;
+            }
+        }
+        if (!python.empty()) break;
+    }
+    if (python.empty()) python = nearest({".python-version"}, &parse_first_line);
+    if (python.empty() && has_language(languages, "Python")) {
+        python = strip_prefix(process_version("python3", waiting), "Python ");
+    }
+    if (!python.empty()) entries.emplace_back("Python", python);
+
+    std::string node = nearest({".nvmrc", ".node-version"}, &parse_first_line);
+    if (node.empty() && has_language(languages, "JavaScript")) {
+        node = process_version("node", waiting);
+    }
+    if (!node.empty()) entries.emplace_back("Node", node);
+
+    std::string rust = nearest({"rust-toolchain.toml", "rust-toolchain"}, &parse_rust_toolchain);
+    if (rust.empty() && has_language(languages, "Rust")) {
+        rust = strip_prefix(process_version("rustc", waiting), "rustc ");
+    }
+    if (!rust.empty()) entries.emplace_back("Rust", rust);
+
+    const std::string go = nearest({"go.mod"}, &parse_go_version);
+    if (!go.empty()) entries.emplace_back("Go", go);
+
+    if (has_language(languages, "C/C++") || has_language(languages, "C++")) {
+        const char* cxx = std::getenv("CXX");
+        const std::string compiler = process_version(cxx && *cxx ? cxx : "c++", waiting);
+        if (!compiler.empty()) entries.emplace_back("Compiler", compiler);
+    }
+
+    if (pending) *pending = waiting;
+    return entries;
+}
+
+void ToolchainProbe::run() {
+    while (true) {
+        std::string command;
+        std::vector<std::string> argv;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                break;
+            }
+            command = std::move(queue_.front());
+            queue_.pop_front();
+            const auto& cached = processes_[command];
+            argv.push_back(cached.binary_path);
+            argv.insert(argv.end(), cached.arguments.begin(), cached.arguments.end());
+            argv.push_back("--version");
+        }
+
+        const std::string version = first_output_line(argv);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& cached = processes_[command];
+            cached.version = version;
+            cached.running = false;
+            cached.failed = version.empty();
+            cached.finished = std::chrono::steady_clock::now();
+        }
+        if (on_ready_) {
+            on_ready_();
+        }
+    }
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,96 @@
+#ifndef COLABB_TOOLCHAIN_PROBE_HPP
+#define COLABB_TOOLCHAIN_PROBE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Which Python, Node, Rust, Go and compiler versions a project uses.
+ *
+ * Version files (.python-version, pyvenv.cfg, .nvmrc, .node-version,
+ * rust-toolchain[.toml], go.mod) are read directly between the cwd and the
+ * project root, and their parsed values are cached by mtime. When a
+ * detected language has no version file, "<tool> --version" is run on the
+ * probe's own thread (spawned directly, no shell) and cached by the
+ * binary's path and mtime; a run that fails is retried after a while. $CXX
+ * may carry arguments ("ccache g++", "clang++ -m32"). Until a run
+ * finishes, probe() reports the result as pending, and on_ready fires once
+ * it lands.
+ */
+class ToolchainProbe {
+public:
+    using Entry = std::pair<std::string, std::string>; // tool, version
+    using ReadyCallback = std::function<void()>;
+
+    explicit ToolchainProbe(ReadyCallback on_ready = nullptr);
+    ~ToolchainProbe();
+
+    ToolchainProbe(const ToolchainProbe&) = delete;
+    ToolchainProbe& operator=(const ToolchainProbe&) = delete;
+
+    // Never spawns on the calling thread. pending is set when a process
+    // probe was queued or is still running for one of the languages.
+    std::vector<Entry> probe(const std::string& cwd, const std::string& project_root,
+                             const std::vector<std::string>& languages, bool* pending = nullptr);
+
+    void set_process_probes_enabled(bool enabled);
+    // How long a failed "--version" run is remembered before trying again
+    void set_failed_probe_retry(std::chrono::milliseconds delay);
+
+    // Parsers, exposed for tests
+    static std::string parse_rust_toolchain(const std::string& content);
+    static std::string parse_pyvenv_version(const std::string& content);
+    static std::string parse_go_version(const std::string& content);
+
+private:
+    struct FileValue {
+        std::int64_t mtime = 0;
+        std::string value;
+    };
+
+    struct ProcessValue {
+        std::string binary_path;
+        std::vector<std::string> arguments; // after the binary, before --version
+        std::int64_t mtime = 0;
+        std::string version;
+        bool running = false;
+        bool failed = false;
+        std::chrono::steady_clock::time_point finished;
+    };
+
+    ReadyCallback on_ready_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, FileValue> files_;
+    std::unordered_map<std::string, ProcessValue> processes_;
+    bool process_probes_enabled_ = true;
+    std::chrono::milliseconds failed_probe_retry_{std::chrono::minutes(1)};
+
+    std::condition_variable cv_;
+    std::deque<std::string> queue_;
+    bool stop_ = false;
+    std::thread worker_;
+
+    // Parsed content of path, re-read only when its mtime changes ("" when missing)
+    std::string read_value(const std::string& path, std::string (*parse)(const std::string&));
+    // Cached "<command> --version"; queues a run when stale or failed long
+    // enough ago. command may carry arguments. Empty while pending.
+    std::string process_version(const std::string& command, bool& pending);
+    void run();
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_TOOLCHAIN_PROBE_HPP
@@ -0,0 +1,366 @@
+#include "infrastructure/filesystem/directory_cache.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <sys/stat.h>
+
+namespace fs = std::filesystem;
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+std::string normalize(const std::string& path) {
+    std::string normal = path;
+    while (normal.size() > 1 && normal.back() == '/') normal.pop_back();
+    return normal;
+}
+
+bool stat_entry(const std::string& directory, const std::string& name, DirectoryCache::Entry& entry) {
+    struct stat st;
+    if (lstat((directory + "/" + name).c_str(), &st) != 0) {
+        return false;
+    }
+    entry.name = name;
+    entry.type = S_ISREG(st.st_mode) ? DirectoryCache::Type::File
+               : S_ISDIR(st.st_mode) ? DirectoryCache::Type::Directory
+               : S_ISLNK(st.st_mode) ? DirectoryCache::Type::Symlink
+                                     : DirectoryCache::Type::Other;
+    entry.size = S_ISREG(st.st_mode) ? static_cast<std::uint64_t>(st.st_size) : 0;
+    return true;
+}
+
+bool by_name(const DirectoryCache::Entry& a, const DirectoryCache::Entry& b) {
+    return a.name < b.name;
+}
+
+// Shell-ish split: quotes group, operators are tokens of their own
+std::vector<std::string> tokenize(const std::string& command) {
+    std::vector<std::string> tokens;
+    std::string current;
+    bool in_token = false;
+    char quote = 0;
+    auto flush = [&]() {
+        if (in_token) tokens.push_back(current);
+        current.clear();
+        in_token = false;
+    };
+
+    for (size_t i = 0; i < command.size(); ++i) {
+        const char c = command[i];
+        if (quote) {
+            if (c == quote) quote = 0;
+            else current += c;
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            in_token = true;
+        } else if (c == ' ' || c == '\t' || c == '\n') {
+            flush();
+        } else if (c == '|' || c == ';' || c == '&' || c == '<' || c == '>') {
+            // Keep "2>" together with its operator
+            std::string op(1, c);
+            if (c == '>' && in_token && current.size() == 1 && std::isdigit(static_cast<unsigned char>(current[0]))) {
+                op = current + op;
+                current.clear();
+                in_token = false;
+            }
+            flush();
+            while (i + 1 < command.size() && (command[i + 1] == c || command[i + 1] == '&')) {
+                op += command[++i];
+            }
+            tokens.push_back(op);
+        } else {
+            current += c;
+            in_token = true;
+        }
+    }
+    flush();
+    return tokens;
+}
+
+bool is_operator(const std::string& token) {
+    return !token.empty() && (token.back() == '|' || token.back() == ';' || token.back() == '&' ||
+                              token.back() == '>' || token.back() == '<');
+}
+
+// Relative names that plausibly refer to an existing entry: "notes.txt",
+// "src/main.cpp", ".env". Flags, globs, variables and URLs are skipped.
+bool looks_like_file(const std::string& token) {
+    if (token.empty() || token[0] == '-' || token[0] == '/' || token == "." || token == "..") return false;
+    if (token.find_first_of("$*?~{}`=:@% \t") != std::string::npos) return false;
+    if (token.find('/') != std::string::npos) return true;
+    const auto dot = token.rfind('.');
+    if (dot == std::string::npos || dot + 1 == token.size()) return false;
+    const std::string ext = token.substr(dot + 1);
+    return ext.size() <= 8 &&
+           std::all_of(ext.begin(), ext.end(), [](unsigned char c) { return std::isalnum(c); }) &&
+           !std::all_of(ext.begin(), ext.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+// Commands whose arguments are created rather than read, or are not local
+// files at all (hosts, package names)
+bool ignores_arguments(const std::vector<std::string>& words) {
+    static const char* kIgnored[] = {"touch", "mkdir", "tee", "wget", "curl", "ssh-keygen", "mktemp",
+                                     "ping", "ssh", "dig", "host", "nslookup", "traceroute",
+                                     "pip", "pip3", "npm", "yarn", "pnpm", "cargo", "apt", "apt-get", "brew",
+                                     "echo", "printf"};
+    const std::string& cmd = words[0];
+    for (const char* creator : kIgnored) {
+        if (cmd == creator) return true;
+    }
+    if (cmd == "git" && words.size() > 1 && (words[1] == "clone" || words[1] == "init")) return true;
+    if (cmd == "tar" && words.size() > 1 && words[1].find('c') != std::string::npos) return true;
+    return false;
+}
+
+} // namespace
+
+const DirectoryCache::Entry* DirectoryCache::Listing::find(const std::string& name) const {
+    Entry key;
+    key.name = name;
+    auto it = std::lower_bound(entries.begin(), entries.end(), key, by_name);
+    return it != entries.end() && it->name == name ? &*it : nullptr;
+}
+
+DirectoryCache::DirectoryCache(size_t max_directories, size_t max_entries_per_dir, bool watch_filesystem)
+    : max_directories_(std::max<size_t>(1, max_directories))
+    , max_entries_per_dir_(max_entries_per_dir) {
+    if (watch_filesystem) {
+        watcher_ = std::make_unique<FileWatcher>(
+            [this](const std::string& key, const std::string&, const std::string& name, FileWatcher::Event event) {
+                on_file_event(key, name, event);
+            });
+    }
+}
+
+DirectoryCache::~DirectoryCache() {
+    // Stop event delivery before the slots go away
+    watcher_.reset();
+}
+
+void DirectoryCache::set_change_callback(ChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    change_callback_ = std::move(callback);
+}
+
+DirectoryCache::ListingPtr DirectoryCache::read_listing(const std::string& directory) const {
+    auto listing = std::make_shared<Listing>();
+    std::error_code ec;
+    for (fs::directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec);
+         !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        if (listing->entries.size() >= max_entries_per_dir_) {
+            listing->truncated = true;
+            break;
+        }
+        Entry entry;
+        if (stat_entry(directory, it->path().filename().string(), entry)) {
+            listing->entries.push_back(std::move(entry));
+        }
+    }
+    std::sort(listing->entries.begin(), listing->entries.end(), by_name);
+    return listing;
+}
+
+DirectoryCache::ListingPtr DirectoryCache::load(const std::string& path) {
+    const std::string directory = normalize(path);
+    if (directory.empty()) {
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = slots_.find(directory);
+        if (it != slots_.end() && it->second.watched) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.listing; // inotify keeps it current
+        }
+    }
+
+    // Watch before reading so nothing between the two is missed
+    const bool watched = watcher_ && watcher_->watch(directory, directory, true);
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        if (watched) watcher_->unwatch(directory);
+        return nullptr;
+    }
+    ListingPtr listing = read_listing(directory);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slots_.find(directory);
+    if (it == slots_.end()) {
+        lru_.push_front(directory);
+        it = slots_.emplace(directory, Slot{listing, watched, lru_.begin()}).first;
+    } else {
+        it->second.listing = listing;
+        it->second.watched = watched;
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+    }
+    while (slots_.size() > max_directories_) {
+        evict_locked(lru_.back());
+    }
+    return listing;
+}
+
+DirectoryCache::ListingPtr DirectoryCache::get(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = slots_.find(normalize(path));
+    return it != slots_.end() ? it->second.listing : nullptr;
+}
+
+void DirectoryCache::on_file_event(const std::string& directory, const std::string& name,
+                                   FileWatcher::Event event) {
+    ListingPtr reloaded;
+    Entry entry;
+    bool exists = false;
+    if (event == FileWatcher::Event::Overflow) {
+        reloaded = read_listing(directory);
+    } else if (name.empty()) {
+        // The directory itself was removed or moved: forget it, load() starts over
+        std::lock_guard<std::mutex> lock(mutex_);
+        evict_locked(directory);
+        return;
+    } else {
+        exists = stat_entry(directory, name, entry);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = slots_.find(directory);
+        if (it == slots_.end()) {
+            return;
+        }
+        if (reloaded) {
+            it->second.listing = reloaded;
+        } else {
+            // Copy-on-write: readers keep the snapshot they already hold
+            auto updated = std::make_shared<Listing>(*it->second.listing);
+            auto pos = std::lower_bound(updated->entries.begin(), updated->entries.end(),
+                                        Entry{name, Type::Other, 0}, by_name);
+            const bool present = pos != updated->entries.end() && pos->name == name;
+            if (exists && present) {
+                *pos = std::move(entry);
+            } else if (exists) {
+                updated->entries.insert(pos, std::move(entry));
+            } else if (present) {
+                updated->entries.erase(pos);
+            }
+            it->second.listing = std::move(updated);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (change_callback_) {
+        change_callback_(directory, reloaded ? std::string() : name);
+    }
+}
+
+std::vector<std::string> DirectoryCache::unknown_references(const std::string& directory,
+                                                            const std::string& command) const {
+    std::vector<std::string> unknown;
+    ListingPtr listing = get(directory);
+    if (!listing || listing->truncated) {
+        return unknown; // can't tell absence from not having looked
+    }
+
+    const auto tokens = tokenize(command);
+    size_t start = 0;
+    while (start < tokens.size()) {
+        // One simple command at a time, up to the next operator
+        size_t end = start;
+        std::vector<std::string> words;
+        std::vector<bool> redirect_target;
+        bool after_redirect = false;
+        for (; end < tokens.size() && !(is_operator(tokens[end]) && tokens[end].find('>') == std::string::npos &&
+                                         tokens[end] != "<");
+             ++end) {
+            if (is_operator(tokens[end])) {
+                after_redirect = tokens[end].find('>') != std::string::npos;
+                continue;
+            }
+            words.push_back(tokens[end]);
+            redirect_target.push_back(after_redirect);
+            after_redirect = false;
+        }
+        start = end + 1;
+
+        // Skip "sudo" and leading VAR=value assignments
+        size_t first = 0;
+        while (first < words.size() && (words[first] == "sudo" || words[first].find('=') != std::string::npos)) {
+            ++first;
+        }
+        if (first >= words.size()) continue;
+        words.erase(words.begin(), words.begin() + static_cast<long>(first));
+        redirect_target.erase(redirect_target.begin(), redirect_target.begin() + static_cast<long>(first));
+        if (ignores_arguments(words)) continue;
+
+        const std::string& cmd = words[0];
+        const bool last_is_destination = cmd == "cp" || cmd == "mv" || cmd == "ln" || cmd == "rsync" || cmd == "scp";
+        for (size_t i = 1; i < words.size(); ++i) {
+            if (redirect_target[i] || (last_is_destination && i + 1 == words.size())) continue;
+            // "-o out" names an output file by convention
+            if (words[i - 1] == "-o" || words[i - 1] == "--output") continue;
+            std::string word = words[i];
+            if (!looks_like_file(word)) continue;
+            if (word.rfind("./", 0) == 0) word.erase(0, 2);
+            const std::string component = word.substr(0, word.find('/'));
+            if (component.empty() || component == "." || component == "..") continue;
+            if (!listing->find(component) &&
+                std::find(unknown.begin(), unknown.end(), words[i]) == unknown.end()) {
+                unknown.push_back(words[i]);
+            }
+        }
+    }
+    return unknown;
+}
+
+size_t DirectoryCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_.size();
+}
+
+size_t DirectoryCache::listing_bytes(const std::string& directory, const Listing& listing) {
+    size_t bytes = sizeof(Slot) + sizeof(Listing) + 64 + 2 * directory.size();
+    for (const auto& entry : listing.entries) {
+        bytes += sizeof(Entry) + entry.name.size();
+    }
+    return bytes;
+}
+
+size_t DirectoryCache::memory_usage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = 0;
+    for (const auto& [directory, slot] : slots_) {
+        total += listing_bytes(directory, *slot.listing);
+    }
+    return total;
+}
+
+size_t DirectoryCache::trim_to(size_t target_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t total = 0;
+    for (const auto& [directory, slot] : slots_) {
+        total += listing_bytes(directory, *slot.listing);
+    }
+    const size_t before = total;
+    while (total > target_bytes && !lru_.empty()) {
+        const std::string directory = lru_.back();
+        total -= listing_bytes(directory, *slots_.at(directory).listing);
+        evict_locked(directory);
+    }
+    return before - total;
+}
+
+void DirectoryCache::evict_locked(const std::string& directory) {
+    auto it = slots_.find(directory);
+    if (it == slots_.end()) {
+        return;
+    }
+    if (it->second.watched && watcher_) {
+        watcher_->unwatch(directory);
+    }
+    lru_.erase(it->second.lru);
+    slots_.erase(it);
+}
+
+} // namespace infrastructure
+} // namespace colabb
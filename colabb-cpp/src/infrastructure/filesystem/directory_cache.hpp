@@ -0,0 +1,102 @@
+#ifndef COLABB_DIRECTORY_CACHE_HPP
+#define COLABB_DIRECTORY_CACHE_HPP
+
+#include "infrastructure/filesystem/file_watcher.hpp"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief In-memory listings (name, type, size) of recently visited
+ * directories, kept current through inotify.
+ *
+ * load() reads a directory and must run off the UI thread; everything else
+ * only touches memory. Listings are immutable snapshots: an inotify event
+ * re-stats the one entry it names and publishes a new snapshot, so readers
+ * holding the old one are never disturbed. The least recently loaded
+ * directory is dropped (and unwatched) beyond max_directories.
+ */
+class DirectoryCache {
+public:
+    enum class Type : std::uint8_t { File, Directory, Symlink, Other };
+
+    struct Entry {
+        std::string name;
+        Type type = Type::Other;
+        std::uint64_t size = 0;
+    };
+
+    struct Listing {
+        std::vector<Entry> entries; // sorted by name
+        bool truncated = false;     // more than max_entries_per_dir entries
+
+        const Entry* find(const std::string& name) const;
+    };
+
+    using ListingPtr = std::shared_ptr<const Listing>;
+    // A cached directory changed, after its snapshot was updated. name is
+    // the entry involved, "" when the whole listing was reloaded.
+    using ChangeCallback = std::function<void(const std::string& directory, const std::string& name)>;
+
+    explicit DirectoryCache(size_t max_directories = 32, size_t max_entries_per_dir = 5000,
+                            bool watch_filesystem = true);
+    ~DirectoryCache();
+
+    DirectoryCache(const DirectoryCache&) = delete;
+    DirectoryCache& operator=(const DirectoryCache&) = delete;
+
+    // Read (or refresh, if unwatched) the listing of directory. Blocking I/O.
+    ListingPtr load(const std::string& directory);
+    // Cached listing or nullptr; never touches the filesystem
+    ListingPtr get(const std::string& directory) const;
+
+    // Arguments of command that look like relative file names but are not
+    // in the cached listing of directory. Only the first path component is
+    // checked. Empty when the directory is not cached.
+    std::vector<std::string> unknown_references(const std::string& directory,
+                                                const std::string& command) const;
+
+    // Replacing the callback waits for a running invocation of the old one,
+    // so set_change_callback(nullptr) is safe before its owner goes away
+    void set_change_callback(ChangeCallback callback);
+
+    size_t size() const;
+    size_t memory_usage() const;
+    size_t trim_to(size_t target_bytes);
+
+private:
+    struct Slot {
+        ListingPtr listing;
+        bool watched = false;
+        std::list<std::string>::iterator lru;
+    };
+
+    size_t max_directories_;
+    size_t max_entries_per_dir_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Slot> slots_;
+    std::list<std::string> lru_; // front = most recently loaded
+    std::mutex callback_mutex_; // held while change_callback_ runs
+    ChangeCallback change_callback_;
+
+    // Declared last: destroyed first, so no callback outlives the slots
+    std::unique_ptr<FileWatcher> watcher_;
+
+    ListingPtr read_listing(const std::string& directory) const;
+    void on_file_event(const std::string& directory, const std::string& name, FileWatcher::Event event);
+    void evict_locked(const std::string& directory);
+    static size_t listing_bytes(const std::string& directory, const Listing& listing);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_DIRECTORY_CACHE_HPP
@@ -0,0 +1,191 @@
+#include "infrastructure/filesystem/file_watcher.hpp"
+#include <algorithm>
+#include <iostream>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace colabb {
+namespace infrastructure {
+
+#if defined(__linux__)
+
+namespace {
+constexpr uint32_t kStructureMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+}
+
+FileWatcher::FileWatcher(Callback callback)
+    : callback_(std::move(callback))
+    , inotify_fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    , wake_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (inotify_fd_ < 0 || wake_fd_ < 0) {
+        std::cerr << "FileWatcher: inotify unavailable, falling back to polling" << std::endl;
+        if (inotify_fd_ >= 0) close(inotify_fd_);
+        if (wake_fd_ >= 0) close(wake_fd_);
+        inotify_fd_ = -1;
+        wake_fd_ = -1;
+        return;
+    }
+    thread_ = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher() {
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (inotify_fd_ >= 0) close(inotify_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+}
+
+bool FileWatcher::watch(const std::string& key, const std::string& directory, bool include_writes) {
+    if (inotify_fd_ < 0) {
+        return false;
+    }
+
+    uint32_t mask = kStructureMask | (include_writes ? IN_CLOSE_WRITE : 0);
+    // IN_MASK_ADD so a directory watched with and without writes keeps both
+    int wd = inotify_add_watch(inotify_fd_, directory.c_str(), mask | IN_MASK_ADD);
+    if (wd < 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& entry = watches_[wd];
+    entry.directory = directory;
+    if (entry.keys.insert(key).second) {
+        key_watches_[key].push_back(wd);
+    }
+    return true;
+}
+
+void FileWatcher::unwatch(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = key_watches_.find(key);
+    if (it == key_watches_.end()) {
+        return;
+    }
+
+    for (int wd : it->second) {
+        auto watch = watches_.find(wd);
+        if (watch == watches_.end()) continue;
+        watch->second.keys.erase(key);
+        if (watch->second.keys.empty()) {
+            inotify_rm_watch(inotify_fd_, wd);
+            watches_.erase(watch);
+        }
+    }
+    key_watches_.erase(it);
+}
+
+size_t FileWatcher::watch_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return watches_.size();
+}
+
+void FileWatcher::run() {
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            continue;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            ssize_t length;
+            while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+                dispatch(buffer, length);
+            }
+        }
+    }
+}
+
+void FileWatcher::dispatch(const char* buffer, long length) {
+    struct Pending {
+        std::string key;
+        std::string directory;
+        std::string name;
+        Event event;
+    };
+    std::vector<Pending> pending;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (long offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost: every watcher must assume everything changed
+                for (const auto& [key, wds] : key_watches_) {
+                    pending.push_back({key, "", "", Event::Overflow});
+                }
+                continue;
+            }
+
+            auto watch = watches_.find(event->wd);
+            if (watch == watches_.end()) {
+                continue;
+            }
+
+            std::string name = event->len > 0 ? std::string(event->name) : std::string();
+            for (const auto& key : watch->second.keys) {
+                pending.push_back({key, watch->second.directory, name, Event::Changed});
+            }
+
+            if (event->mask & IN_IGNORED) {
+                // Directory is gone; the kernel already dropped the watch
+                for (const auto& key : watch->second.keys) {
+                    auto& wds = key_watches_[key];
+                    wds.erase(std::remove(wds.begin(), wds.end(), event->wd), wds.end());
+                }
+                watches_.erase(watch);
+            }
+        }
+    }
+
+    for (const auto& p : pending) {
+        callback_(p.key, p.directory, p.name, p.event);
+    }
+}
+
+#else // !__linux__
+
+FileWatcher::FileWatcher(Callback callback)
+    : callback_(std::move(callback))
+    , inotify_fd_(-1)
+    , wake_fd_(-1) {
+}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::watch(const std::string&, const std::string&, bool) {
+    return false;
+}
+
+void FileWatcher::unwatch(const std::string&) {}
+
+size_t FileWatcher::watch_count() const {
+    return 0;
+}
+
+void FileWatcher::run() {}
+
+void FileWatcher::dispatch(const char*, long) {}
+
+#endif
+
+} // namespace infrastructure
+} // namespace colabb
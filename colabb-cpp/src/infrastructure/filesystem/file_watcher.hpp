@@ -0,0 +1,71 @@
+#ifndef COLABB_FILE_WATCHER_HPP
+#define COLABB_FILE_WATCHER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief inotify-backed directory watcher shared by the filesystem caches.
+ *
+ * Callers register directories under an opaque key; when anything happens
+ * inside a watched directory the callback receives the key, the directory
+ * and the entry name. Several keys may watch the same directory. Events are
+ * delivered on the watcher's own thread. On platforms without inotify,
+ * watch() returns false and callers should fall back to polling/TTLs.
+ */
+class FileWatcher {
+public:
+    enum class Event { Changed, Overflow };
+
+    // key, watched directory, entry name ("" for the directory itself)
+    using Callback = std::function<void(const std::string& key,
+                                        const std::string& directory,
+                                        const std::string& name,
+                                        Event event)>;
+
+    explicit FileWatcher(Callback callback);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool available() const { return inotify_fd_ >= 0; }
+
+    // Watch entries being created/removed/renamed in directory. With
+    // include_writes, completed writes to existing entries are reported too.
+    bool watch(const std::string& key, const std::string& directory, bool include_writes = false);
+    // Drop every directory registered under key
+    void unwatch(const std::string& key);
+    size_t watch_count() const;
+
+private:
+    struct Watch {
+        std::string directory;
+        std::unordered_set<std::string> keys;
+    };
+
+    Callback callback_;
+    int inotify_fd_;
+    int wake_fd_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::unordered_map<int, Watch> watches_;
+    std::unordered_map<std::string, std::vector<int>> key_watches_;
+
+    void run();
+    void dispatch(const char* buffer, long length);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_FILE_WATCHER_HPP
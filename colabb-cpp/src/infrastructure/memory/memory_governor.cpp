@@ -0,0 +1,178 @@
+#include "infrastructure/memory/memory_governor.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+std::string read_small_file(const char* path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return "";
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+}
+
+MemoryGovernor::MemoryGovernor(size_t budget_bytes)
+    : next_id_(1)
+    , budget_bytes_(budget_bytes)
+    , rss_limit_bytes_(0)
+    , psi_threshold_(10.0) {
+}
+
+MemoryGovernor::ComponentId MemoryGovernor::register_component(const std::string& name, int priority,
+                                                               UsageFn usage, TrimFn trim, ReserveFn reserve) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ComponentId id = next_id_++;
+    components_.push_back({id, name, priority, std::move(usage), std::move(trim), std::move(reserve)});
+    std::stable_sort(components_.begin(), components_.end(),
+                     [](const Component& a, const Component& b) { return a.priority < b.priority; });
+    return id;
+}
+
+void MemoryGovernor::unregister_component(ComponentId id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    components_.erase(std::remove_if(components_.begin(), components_.end(),
+                                     [id](const Component& c) { return c.id == id; }),
+                      components_.end());
+}
+
+void MemoryGovernor::set_budget(size_t budget_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_bytes_ = budget_bytes;
+}
+
+size_t MemoryGovernor::budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_bytes_;
+}
+
+size_t MemoryGovernor::effective_budget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return effective_budget_locked();
+}
+
+size_t MemoryGovernor::effective_budget_locked() const {
+    size_t budget = budget_bytes_;
+    for (const auto& component : components_) {
+        if (component.reserve) {
+            budget += component.reserve();
+        }
+    }
+    return budget;
+}
+
+void MemoryGovernor::set_rss_limit(size_t rss_limit_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rss_limit_bytes_ = rss_limit_bytes;
+}
+
+void MemoryGovernor::set_psi_threshold(double some_avg10_percent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    psi_threshold_ = some_avg10_percent;
+}
+
+MemoryGovernor::Pressure MemoryGovernor::sample_pressure() const {
+    size_t rss_limit;
+    double psi_threshold;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rss_limit = rss_limit_bytes_;
+        psi_threshold = psi_threshold_;
+    }
+
+    Pressure pressure;
+    if (auto pages = parse_statm_rss_pages(read_small_file("/proc/self/statm"))) {
+        pressure.rss_bytes = *pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+    // PSI needs Linux 4.20+ with CONFIG_PSI; absent file means no signal
+    pressure.psi_some_avg10 = parse_psi_some_avg10(read_small_file("/proc/pressure/memory"));
+
+    pressure.under_pressure =
+        (rss_limit > 0 && pressure.rss_bytes > rss_limit) ||
+        (pressure.psi_some_avg10 && *pressure.psi_some_avg10 >= psi_threshold);
+    return pressure;
+}
+
+std::vector<MemoryGovernor::ComponentUsage> MemoryGovernor::report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ComponentUsage> usage;
+    usage.reserve(components_.size());
+    for (const auto& component : components_) {
+        usage.push_back({component.name, component.priority, component.usage()});
+    }
+    return usage;
+}
+
+size_t MemoryGovernor::total_usage() const {
+    size_t total = 0;
+    for (const auto& component : report()) {
+        total += component.bytes;
+    }
+    return total;
+}
+
+size_t MemoryGovernor::enforce() {
+    const bool under_pressure = sample_pressure().under_pressure;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t budget = effective_budget_locked();
+    const size_t target = under_pressure ? budget / 2 : budget;
+
+    std::vector<size_t> usage;
+    usage.reserve(components_.size());
+    size_t total = 0;
+    for (const auto& component : components_) {
+        usage.push_back(component.usage());
+        total += usage.back();
+    }
+
+    size_t released = 0;
+    for (size_t i = 0; i < components_.size() && total > target; ++i) {
+        const size_t excess = total - target;
+        size_t component_target = usage[i] > excess ? usage[i] - excess : 0;
+        // Reserved bytes are only given up under system pressure: caches
+        // overflowing the budget never cost a tab its scrollback
+        if (!under_pressure && components_[i].reserve) {
+            component_target = std::max(component_target, components_[i].reserve());
+        }
+        if (component_target >= usage[i]) {
+            continue;
+        }
+        const size_t freed = std::min(components_[i].trim(component_target), total);
+        total -= freed;
+        released += freed;
+    }
+    return released;
+}
+
+std::optional<size_t> MemoryGovernor::parse_statm_rss_pages(const std::string& statm) {
+    // Format: size resident shared text lib data dt (pages)
+    std::istringstream stream(statm);
+    size_t size_pages = 0, resident_pages = 0;
+    if (!(stream >> size_pages >> resident_pages)) {
+        return std::nullopt;
+    }
+    return resident_pages;
+}
+
+std::optional<double> MemoryGovernor::parse_psi_some_avg10(const std::string& pressure) {
+    // Format: "some avg10=0.00 avg60=0.00 avg300=0.00 total=0"
+    const std::string prefix = "some avg10=";
+    auto pos = pressure.find(prefix);
+    if (pos == std::string::npos) {
+        return std::nullopt;
+    }
+    try {
+        return std::stod(pressure.substr(pos + prefix.size()));
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,99 @@
+#ifndef COLABB_MEMORY_GOVERNOR_HPP
+#define COLABB_MEMORY_GOVERNOR_HPP
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Tracks the byte footprint of registered caches and enforces a
+ * global budget.
+ *
+ * Components report their usage and accept a trim request. enforce() trims
+ * them in priority order (lowest first) until the total fits the budget.
+ * A component may also reserve bytes it is entitled to on top of the
+ * budget (e.g. the scrollback its tabs' profiles ask for), so the budget
+ * covers caches rather than growing with every tab; it is never trimmed
+ * below that reservation unless the system is under memory pressure (RSS
+ * limit from /proc/self/statm or Linux PSI from /proc/pressure/memory),
+ * when the target also drops to half the budget.
+ * Callbacks run on the thread that calls enforce() (the GTK main loop).
+ */
+class MemoryGovernor {
+public:
+    using ComponentId = size_t;
+    using UsageFn = std::function<size_t()>;
+    // Shrink to at most target_bytes, return bytes released
+    using TrimFn = std::function<size_t(size_t target_bytes)>;
+    // Bytes added to the budget for this component, queried at each enforce()
+    using ReserveFn = std::function<size_t()>;
+
+    struct ComponentUsage {
+        std::string name;
+        int priority;
+        size_t bytes;
+    };
+
+    struct Pressure {
+        size_t rss_bytes = 0;
+        std::optional<double> psi_some_avg10;
+        bool under_pressure = false;
+    };
+
+    explicit MemoryGovernor(size_t budget_bytes = 32 * 1024 * 1024);
+
+    // Lower priority values are trimmed first
+    ComponentId register_component(const std::string& name, int priority,
+                                   UsageFn usage, TrimFn trim, ReserveFn reserve = nullptr);
+    void unregister_component(ComponentId id);
+
+    void set_budget(size_t budget_bytes);
+    size_t budget() const;
+    // budget() plus every component's reservation
+    size_t effective_budget() const;
+    // 0 disables the RSS check
+    void set_rss_limit(size_t rss_limit_bytes);
+    void set_psi_threshold(double some_avg10_percent);
+
+    Pressure sample_pressure() const;
+    std::vector<ComponentUsage> report() const;
+    size_t total_usage() const;
+
+    // Trim components until they fit the (pressure-adjusted) budget.
+    // Returns the number of bytes released.
+    size_t enforce();
+
+    // Parsers exposed for tests
+    static std::optional<size_t> parse_statm_rss_pages(const std::string& statm);
+    static std::optional<double> parse_psi_some_avg10(const std::string& pressure);
+
+private:
+    struct Component {
+        ComponentId id;
+        std::string name;
+        int priority;
+        UsageFn usage;
+        TrimFn trim;
+        ReserveFn reserve;
+    };
+
+    size_t effective_budget_locked() const;
+
+    mutable std::mutex mutex_;
+    std::vector<Component> components_;
+    ComponentId next_id_;
+    size_t budget_bytes_;
+    size_t rss_limit_bytes_;
+    double psi_threshold_;
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_MEMORY_GOVERNOR_HPP
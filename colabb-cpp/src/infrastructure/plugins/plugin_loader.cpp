@@ -1,6 +1,10 @@
 #include "infrastructure/plugins/plugin_loader.hpp"
 
+#include <algorithm>
+#include <cctype>
+#include <fstream>
 #include <iostream>
+#include <glib.h>
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -12,6 +16,8 @@ using namespace colabb::infrastructure::plugins;
 
 typedef colabb::domain::IAIProvider* (*create_fn_t)(const char*);
 typedef void (*destroy_fn_t)(colabb::domain::IAIProvider*);
+typedef colabb::domain::IContextProvider* (*create_context_fn_t)(const char*);
+typedef void (*destroy_context_fn_t)(colabb::domain::IContextProvider*);
 
 PluginLoader::PluginLoader() = default;
 
@@ -20,9 +26,8 @@ PluginLoader::~PluginLoader() {
     // Future improvement: allow unload when no providers remain.
 }
 
-std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::IAIProvider*)>> PluginLoader::loadProvider(const std::string& path, const std::string& config_json) {
-    std::lock_guard<std::mutex> lock(mutex_);
-
+void* PluginLoader::open_library(const std::string& path, const char* create_name, const char* destroy_name,
+                                 void*& create_sym, void*& destroy_sym) {
     if (path.empty()) return nullptr;
 
 #if defined(_WIN32)
@@ -31,13 +36,14 @@ std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::
         std::cerr << "PluginLoader: LoadLibrary failed: " << path << "\n";
         return nullptr;
     }
-    auto create_fn = reinterpret_cast<create_fn_t>(GetProcAddress(handle, "create_provider"));
-    auto destroy_fn = reinterpret_cast<destroy_fn_t>(GetProcAddress(handle, "destroy_provider"));
-    if (!create_fn || !destroy_fn) {
+    create_sym = reinterpret_cast<void*>(GetProcAddress(handle, create_name));
+    destroy_sym = reinterpret_cast<void*>(GetProcAddress(handle, destroy_name));
+    if (!create_sym || !destroy_sym) {
         std::cerr << "PluginLoader: missing symbols in: " << path << "\n";
         FreeLibrary(handle);
         return nullptr;
     }
+    return reinterpret_cast<void*>(handle);
 #else
     void* handle = dlopen(path.c_str(), RTLD_NOW);
     if (!handle) {
@@ -45,21 +51,59 @@ std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::
         return nullptr;
     }
     dlerror();
-    auto create_fn = reinterpret_cast<create_fn_t>(dlsym(handle, "create_provider"));
+    create_sym = dlsym(handle, create_name);
     const char* dlsym_err = dlerror();
     if (dlsym_err) {
-        std::cerr << "PluginLoader: dlsym create_provider error: " << dlsym_err << "\n";
+        std::cerr << "PluginLoader: dlsym " << create_name << " error: " << dlsym_err << "\n";
         dlclose(handle);
         return nullptr;
     }
-    auto destroy_fn = reinterpret_cast<destroy_fn_t>(dlsym(handle, "destroy_provider"));
+    destroy_sym = dlsym(handle, destroy_name);
     dlsym_err = dlerror();
     if (dlsym_err) {
-        std::cerr << "PluginLoader: dlsym destroy_provider error: " << dlsym_err << "\n";
+        std::cerr << "PluginLoader: dlsym " << destroy_name << " error: " << dlsym_err << "\n";
         dlclose(handle);
         return nullptr;
     }
+    return handle;
+#endif
+}
+
+bool PluginLoader::matches_sha256(const std::string& path, const std::string& expected_hex) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file || expected_hex.empty()) return false;
+
+    GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    char buffer[64 * 1024];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        g_checksum_update(checksum, reinterpret_cast<const guchar*>(buffer), file.gcount());
+    }
+    std::string actual = g_checksum_get_string(checksum);
+    g_checksum_free(checksum);
+
+    std::string expected = expected_hex;
+    std::transform(expected.begin(), expected.end(), expected.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return actual == expected;
+}
+
+void PluginLoader::close_library(void* handle) {
+#if defined(_WIN32)
+    FreeLibrary(reinterpret_cast<HMODULE>(handle));
+#else
+    dlclose(handle);
 #endif
+}
+
+std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::IAIProvider*)>> PluginLoader::loadProvider(const std::string& path, const std::string& config_json) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    void* create_sym = nullptr;
+    void* destroy_sym = nullptr;
+    void* handle = open_library(path, "create_provider", "destroy_provider", create_sym, destroy_sym);
+    if (!handle) return nullptr;
+    auto create_fn = reinterpret_cast<create_fn_t>(create_sym);
+    auto destroy_fn = reinterpret_cast<destroy_fn_t>(destroy_sym);
 
     colabb::domain::IAIProvider* raw = nullptr;
     try {
@@ -74,11 +118,7 @@ std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::
 
     if (!raw) {
         // creation failed; close handle
-#if defined(_WIN32)
-        FreeLibrary(handle);
-#else
-        dlclose(handle);
-#endif
+        close_library(handle);
         return nullptr;
     }
 
@@ -94,3 +134,40 @@ std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::
 
     return std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::IAIProvider*)>>(raw, deleter);
 }
+
+std::unique_ptr<colabb::domain::IContextProvider, std::function<void(colabb::domain::IContextProvider*)>> PluginLoader::loadContextProvider(const std::string& path, const std::string& config_json) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    void* create_sym = nullptr;
+    void* destroy_sym = nullptr;
+    void* handle = open_library(path, "create_context_provider", "destroy_context_provider", create_sym, destroy_sym);
+    if (!handle) return nullptr;
+    auto create_fn = reinterpret_cast<create_context_fn_t>(create_sym);
+    auto destroy_fn = reinterpret_cast<destroy_context_fn_t>(destroy_sym);
+
+    colabb::domain::IContextProvider* raw = nullptr;
+    try {
+        raw = create_fn(config_json.c_str());
+    } catch (const std::exception& e) {
+        std::cerr << "PluginLoader: create_context_provider threw: " << e.what() << "\n";
+        raw = nullptr;
+    } catch (...) {
+        std::cerr << "PluginLoader: create_context_provider threw unknown exception\n";
+        raw = nullptr;
+    }
+
+    if (!raw) {
+        close_library(handle);
+        return nullptr;
+    }
+
+    handles_.push_back(handle);
+
+    std::function<void(colabb::domain::IContextProvider*)> deleter = [destroy_fn](colabb::domain::IContextProvider* p) {
+        if (p && destroy_fn) {
+            destroy_fn(p);
+        }
+    };
+
+    return std::unique_ptr<colabb::domain::IContextProvider, std::function<void(colabb::domain::IContextProvider*)>>(raw, deleter);
+}
@@ -7,6 +7,7 @@
 #include <vector>
 #include <mutex>
 #include "domain/ai/ai_provider.hpp"
+#include "domain/context/context_provider.hpp"
 
 namespace colabb {
 namespace infrastructure {
@@ -21,10 +22,23 @@ public:
     // The returned unique_ptr will call the plugin's destroy function when destroyed.
     std::unique_ptr<colabb::domain::IAIProvider, std::function<void(colabb::domain::IAIProvider*)>> loadProvider(const std::string& path, const std::string& config_json);
 
+    // Load a context provider; the library must export
+    // create_context_provider(const char*) and destroy_context_provider.
+    std::unique_ptr<colabb::domain::IContextProvider, std::function<void(colabb::domain::IContextProvider*)>> loadContextProvider(const std::string& path, const std::string& config_json);
+
+    // True when the file's SHA-256 equals expected_hex (case-insensitive)
+    static bool matches_sha256(const std::string& path, const std::string& expected_hex);
+
 private:
     std::mutex mutex_;
     // Opaque handles to loaded libraries (kept alive for program lifetime)
     std::vector<void*> handles_;
+
+    // Open path and resolve both symbols. Returns the library handle, or
+    // nullptr (library closed again) on failure.
+    void* open_library(const std::string& path, const char* create_name, const char* destroy_name,
+                       void*& create_sym, void*& destroy_sym);
+    void close_library(void* handle);
 };
 
 } // namespace plugins
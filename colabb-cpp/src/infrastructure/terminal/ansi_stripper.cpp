@@ -0,0 +1,333 @@
+#include "infrastructure/terminal/ansi_stripper.hpp"
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+constexpr unsigned char kEsc = 0x1B;
+constexpr unsigned char kBel = 0x07;
+constexpr unsigned char kCan = 0x18;
+constexpr unsigned char kSub = 0x1A;
+
+inline bool is_continuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+} // namespace
+
+size_t AnsiStripper::find_control(const char* data, size_t length) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Unsigned c < 0x20 <=> min(c, 0x1F) == c
+    const __m128i limit = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    for (; i + 16 <= length; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i control = _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(chunk, limit), chunk),
+                                             _mm_cmpeq_epi8(chunk, del));
+        const int mask = _mm_movemask_epi8(control);
+        if (mask != 0) {
+            return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+    for (; i < length; ++i) {
+        const auto c = static_cast<unsigned char>(data[i]);
+        if (c < 0x20 || c == 0x7F) {
+            return i;
+        }
+    }
+    return length;
+}
+
+void AnsiStripper::feed(const char* data, size_t length, std::string& out) {
+    size_t i = 0;
+    while (i < length) {
+        const auto c = static_cast<unsigned char>(data[i]);
+        switch (state_) {
+        case State::Ground: {
+            const size_t run = find_control(data + i, length - i);
+            if (run > 0) {
+                if (!alternate_screen_) {
+                    put_text(data + i, run, out);
+                }
+                i += run;
+                continue;
+            }
+            ++i;
+            if (c == kEsc) {
+                state_ = State::Escape;
+            } else {
+                execute_control(c, out);
+            }
+            break;
+        }
+        case State::Escape:
+            ++i;
+            if (c == '[') {
+                state_ = State::Csi;
+                csi_param_ = 0;
+                csi_has_param_ = false;
+                csi_private_ = false;
+                csi_extra_ = false;
+            } else if (c == ']') {
+                state_ = State::Osc;
+                osc_payload_.clear();
+            } else if (c == 'P' || c == 'X' || c == '^' || c == '_') {
+                state_ = State::String;
+            } else if (c >= 0x20 && c <= 0x2F) {
+                state_ = State::EscapeIntermediate;
+            } else if (c == kCan || c == kSub) {
+                state_ = State::Ground;
+            } else if (c < 0x20) {
+                if (c != kEsc) execute_control(c, out);
+            } else {
+                state_ = State::Ground; // two-byte sequence (ESC 7, ESC =, ESC M...)
+            }
+            break;
+        case State::EscapeIntermediate:
+            ++i;
+            if (c >= 0x30 && c <= 0x7E) {
+                state_ = State::Ground; // charset designation and the like
+            } else if (c == kEsc) {
+                state_ = State::Escape;
+            } else if (c == kCan || c == kSub) {
+                state_ = State::Ground;
+            } else if (c < 0x20) {
+                execute_control(c, out);
+            }
+            break;
+        case State::Csi:
+            ++i;
+            if (c >= '0' && c <= '9') {
+                if (!csi_extra_) {
+                    csi_param_ = std::min(csi_param_ * 10 + (c - '0'), 9999u);
+                    csi_has_param_ = true;
+                }
+            } else if (c == '?' && !csi_has_param_ && !csi_private_ && !csi_extra_) {
+                csi_private_ = true;
+            } else if ((c >= 0x20 && c <= 0x2F) || (c >= 0x3A && c <= 0x3F)) {
+                csi_extra_ = true;
+            } else if (c >= 0x40 && c <= 0x7E) {
+                execute_csi(c);
+                state_ = State::Ground;
+            } else if (c == kEsc) {
+                state_ = State::Escape;
+            } else if (c == kCan || c == kSub) {
+                state_ = State::Ground;
+            } else if (c < 0x20) {
+                execute_control(c, out); // C0 controls still act inside a CSI
+            }
+            break;
+        case State::Osc:
+        case State::String: {
+            // Jump straight to the next terminator candidate
+            const size_t run = find_control(data + i, length - i);
+            if (state_ == State::Osc) {
+                append_osc(data + i, run);
+            }
+            i += run;
+            if (i == length) {
+                break;
+            }
+            const auto terminator = static_cast<unsigned char>(data[i++]);
+            if (terminator == kEsc) {
+                state_ = state_ == State::Osc ? State::OscEscape : State::StringEscape;
+            } else if (terminator == kBel && state_ == State::Osc) {
+                finish_osc();
+                state_ = State::Ground;
+            } else if (terminator == kCan || terminator == kSub) {
+                state_ = State::Ground;
+            } else if (state_ == State::Osc) {
+                append_osc(data + i - 1, 1); // e.g. newlines in a reported command line
+            }
+            break;
+        }
+        case State::OscEscape:
+        case State::StringEscape:
+            if (c == '\\') {
+                ++i;
+                if (state_ == State::OscEscape) {
+                    finish_osc();
+                }
+                state_ = State::Ground; // ST
+            } else {
+                state_ = State::Escape; // unterminated; c starts a new sequence
+            }
+            break;
+        }
+    }
+}
+
+void AnsiStripper::reset() {
+    state_ = State::Ground;
+    line_.clear();
+    cursor_ = 0;
+    lines_committed_ = 0;
+    alternate_screen_ = false;
+    osc_payload_.clear();
+}
+
+void AnsiStripper::set_osc_handler(OscHandler handler) {
+    osc_handler_ = std::move(handler);
+}
+
+void AnsiStripper::append_osc(const char* data, size_t length) {
+    if (osc_handler_ && osc_payload_.size() < kMaxOscPayload) {
+        osc_payload_.append(data, std::min(length, kMaxOscPayload - osc_payload_.size()));
+    }
+}
+
+void AnsiStripper::finish_osc() {
+    if (osc_handler_) {
+        osc_handler_(osc_payload_);
+    }
+    osc_payload_.clear();
+}
+
+void AnsiStripper::put_text(const char* data, size_t length, std::string& out) {
+    const size_t overlap = std::min(length, line_.size() - std::min(cursor_, line_.size()));
+    const auto is_ascii = [](const char* p, size_t n) {
+        return std::all_of(p, p + n, [](char ch) { return static_cast<unsigned char>(ch) < 0x80; });
+    };
+    if (cursor_ == line_.size()) {
+        // Common case: plain output appended at the end of the line
+        line_.append(data, length);
+        cursor_ += length;
+    } else if (overlap > 0 && is_ascii(data, overlap) && is_ascii(line_.data() + cursor_, overlap)) {
+        // Redrawn ASCII (progress bars): one byte per character, copy over
+        line_.replace(cursor_, overlap, data, overlap);
+        line_.append(data + overlap, length - overlap);
+        cursor_ += length;
+    } else {
+        for (size_t i = 0; i < length; ++i) {
+            put_byte(static_cast<unsigned char>(data[i]));
+        }
+    }
+    if (line_.size() >= kMaxLineLength) {
+        commit_line(out);
+    }
+}
+
+void AnsiStripper::put_byte(unsigned char c) {
+    if (cursor_ >= line_.size()) {
+        line_.resize(cursor_, ' '); // cursor moved past the end: pad
+        line_.push_back(static_cast<char>(c));
+    } else if (is_continuation(c)) {
+        line_.insert(cursor_, 1, static_cast<char>(c)); // completes the character just written
+    } else {
+        // Overwrite the whole character under the cursor
+        size_t end = cursor_ + 1;
+        while (end < line_.size() && is_continuation(static_cast<unsigned char>(line_[end]))) {
+            ++end;
+        }
+        line_.replace(cursor_, end - cursor_, 1, static_cast<char>(c));
+    }
+    ++cursor_;
+}
+
+void AnsiStripper::execute_control(unsigned char c, std::string& out) {
+    if (alternate_screen_) {
+        return;
+    }
+    switch (c) {
+    case '\n':
+    case '\v':
+    case '\f':
+        commit_line(out);
+        break;
+    case '\r':
+        cursor_ = 0;
+        break;
+    case '\b':
+        move_left(1);
+        break;
+    case '\t':
+        put_byte(c);
+        break;
+    default:
+        break; // BEL, SO/SI and the rest have no textual effect
+    }
+}
+
+void AnsiStripper::execute_csi(unsigned char final_byte) {
+    if (csi_private_) {
+        const bool alternate = csi_param_ == 1049 || csi_param_ == 1047 || csi_param_ == 47;
+        if (alternate && !csi_extra_ && (final_byte == 'h' || final_byte == 'l')) {
+            alternate_screen_ = final_byte == 'h';
+            line_.clear(); // the primary screen's line is redrawn on return
+            cursor_ = 0;
+        }
+        return;
+    }
+    if (csi_extra_ || alternate_screen_) {
+        return; // SGR lists, cursor positioning, full-screen drawing...
+    }
+    const unsigned count = csi_has_param_ && csi_param_ > 0 ? csi_param_ : 1;
+    switch (final_byte) {
+    case 'K': // erase in line
+        if (csi_param_ == 0) {
+            if (cursor_ < line_.size()) line_.resize(cursor_);
+        } else if (csi_param_ == 1) {
+            const size_t end = std::min(cursor_, line_.size());
+            const size_t chars = static_cast<size_t>(std::count_if(line_.begin(), line_.begin() + end,
+                [](char ch) { return !is_continuation(static_cast<unsigned char>(ch)); }));
+            line_.replace(0, end, chars, ' ');
+            cursor_ = chars;
+        } else if (csi_param_ == 2) {
+            line_.clear();
+            cursor_ = 0;
+        }
+        break;
+    case 'C':
+        move_right(count);
+        break;
+    case 'D':
+        move_left(count);
+        break;
+    case 'G': // cursor to absolute column
+        cursor_ = 0;
+        move_right(count - 1);
+        break;
+    default:
+        break;
+    }
+}
+
+void AnsiStripper::commit_line(std::string& out) {
+    out.append(line_);
+    out.push_back('\n');
+    ++lines_committed_;
+    line_.clear();
+    cursor_ = 0;
+}
+
+void AnsiStripper::move_left(unsigned count) {
+    for (; count > 0 && cursor_ > 0; --count) {
+        --cursor_;
+        while (cursor_ > 0 && cursor_ < line_.size() &&
+               is_continuation(static_cast<unsigned char>(line_[cursor_]))) {
+            --cursor_;
+        }
+    }
+}
+
+void AnsiStripper::move_right(unsigned count) {
+    for (; count > 0 && cursor_ < line_.size(); --count) {
+        ++cursor_;
+        while (cursor_ < line_.size() && is_continuation(static_cast<unsigned char>(line_[cursor_]))) {
+            ++cursor_;
+        }
+    }
+    // Past the end: put_byte pads with spaces
+    cursor_ = std::min(cursor_ + count, kMaxLineLength);
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,88 @@
+#ifndef COLABB_ANSI_STRIPPER_HPP
+#define COLABB_ANSI_STRIPPER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Streaming VT parser that turns raw shell output into plain lines.
+ *
+ * Escape sequences (CSI, OSC, DCS/SOS/PM/APC and two-byte ESC) are removed
+ * even when split across chunks. Carriage returns, backspaces and the
+ * cursor/erase CSIs used by progress bars are applied to the line being
+ * written, so only what the terminal finally displays on each line is kept.
+ * OSC payloads can be observed (shell integration marks, OSC 7) through
+ * set_osc_handler(). Text drawn on the alternate screen (vim, htop, less)
+ * is dropped: full-screen redraws don't make meaningful lines.
+ */
+class AnsiStripper {
+public:
+    // Appends every line completed by this chunk, each ending in '\n', to out
+    void feed(const char* data, size_t length, std::string& out);
+
+    // Line still being written (no newline seen yet), as currently displayed
+    const std::string& pending_line() const { return line_; }
+    // Lines completed since construction or the last reset()
+    std::uint64_t lines_committed() const { return lines_committed_; }
+    // A full-screen program switched to the alternate screen (DECSET 1049/1047/47)
+    bool alternate_screen() const { return alternate_screen_; }
+    void reset();
+
+    // Called with the payload of each terminated OSC sequence (e.g. "133;A"),
+    // in stream order with the lines around it
+    using OscHandler = std::function<void(std::string_view payload)>;
+    void set_osc_handler(OscHandler handler);
+
+    // Index of the first C0 control or DEL byte in data, or length
+    static size_t find_control(const char* data, size_t length);
+
+    // A line with no newline is flushed once it grows past this many bytes
+    static constexpr size_t kMaxLineLength = 16 * 1024;
+    // Longer OSC payloads are truncated before reaching the handler
+    static constexpr size_t kMaxOscPayload = 16 * 1024;
+
+private:
+    enum class State {
+        Ground,
+        Escape,
+        EscapeIntermediate,
+        Csi,
+        Osc,
+        OscEscape,
+        String,     // DCS, SOS, PM, APC: skipped up to ST
+        StringEscape
+    };
+
+    State state_ = State::Ground;
+    std::string line_;
+    size_t cursor_ = 0; // byte offset in line_, always on a UTF-8 boundary
+    unsigned csi_param_ = 0; // first parameter only; enough for K/C/D/G
+    bool csi_has_param_ = false;
+    bool csi_private_ = false; // leading '?' (DEC private mode)
+    bool csi_extra_ = false; // other markers, intermediates or more parameters
+    bool alternate_screen_ = false;
+    std::uint64_t lines_committed_ = 0;
+    OscHandler osc_handler_;
+    std::string osc_payload_;
+
+    void put_text(const char* data, size_t length, std::string& out);
+    void put_byte(unsigned char c);
+    void execute_control(unsigned char c, std::string& out);
+    void execute_csi(unsigned char final_byte);
+    void commit_line(std::string& out);
+    void append_osc(const char* data, size_t length);
+    void finish_osc();
+    void move_left(unsigned count);
+    void move_right(unsigned count);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_ANSI_STRIPPER_HPP
@@ -0,0 +1,115 @@
+#include "infrastructure/terminal/command_tracker.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+constexpr std::string_view kMarkPrefix = "133;";
+constexpr std::string_view kCommandLineKey = "cmdline=";
+
+std::optional<int> parse_exit_code(std::string_view text) {
+    const size_t end = text.find(';');
+    const std::string digits(text.substr(0, end));
+    if (digits.empty()) {
+        return std::nullopt;
+    }
+    char* parsed_end = nullptr;
+    const long value = std::strtol(digits.c_str(), &parsed_end, 10);
+    if (*parsed_end != '\0') {
+        return std::nullopt;
+    }
+    return static_cast<int>(value);
+}
+
+} // namespace
+
+CommandTracker::CommandTracker(size_t max_records)
+    : max_records_(std::max<size_t>(1, max_records)) {}
+
+bool CommandTracker::handle_osc(std::string_view payload, std::uint64_t line) {
+    if (payload.substr(0, kMarkPrefix.size()) != kMarkPrefix || payload.size() <= kMarkPrefix.size()) {
+        return false;
+    }
+    active_ = true;
+    const char mark = payload[kMarkPrefix.size()];
+    std::string_view options = payload.substr(std::min(payload.size(), kMarkPrefix.size() + 2));
+
+    switch (mark) {
+    case 'A': // prompt: a command that never reported D ended here
+        if (running_) finish(line, std::nullopt);
+        break;
+    case 'C': {
+        if (running_) finish(line, std::nullopt);
+        CommandRecord record;
+        // cmdline= runs to the end of the payload: the command may contain ';'
+        const size_t key = options.find(kCommandLineKey);
+        if (key != std::string_view::npos) {
+            record.command = std::string(options.substr(key + kCommandLineKey.size()));
+        }
+        record.output_begin = record.output_end = line;
+        record.started = std::chrono::steady_clock::now();
+        records_.push_back(std::move(record));
+        running_ = true;
+        if (records_.size() > max_records_) {
+            records_.pop_front();
+            ++first_id_;
+        }
+        break;
+    }
+    case 'D':
+        if (running_) finish(line, parse_exit_code(options));
+        break;
+    default:
+        break; // B (input start) and extensions carry nothing we index
+    }
+    return true;
+}
+
+void CommandTracker::finish(std::uint64_t line, std::optional<int> exit_code) {
+    CommandRecord& record = records_.back();
+    record.output_end = std::max(line, record.output_begin);
+    record.exit_code = exit_code;
+    record.finished = true;
+    record.ended = std::chrono::steady_clock::now();
+    running_ = false;
+
+    const std::uint64_t id = first_id_ + records_.size() - 1;
+    last_finished_id_ = id;
+    if (record.failed()) {
+        last_failed_id_ = id;
+    }
+}
+
+void CommandTracker::clear() {
+    first_id_ += records_.size();
+    records_.clear();
+    last_finished_id_.reset();
+    last_failed_id_.reset();
+    running_ = false;
+    active_ = false;
+}
+
+const CommandRecord* CommandTracker::find(const std::optional<std::uint64_t>& id) const {
+    if (!id || *id < first_id_ || *id - first_id_ >= records_.size()) {
+        return nullptr;
+    }
+    return &records_[static_cast<size_t>(*id - first_id_)];
+}
+
+const CommandRecord* CommandTracker::last() const {
+    return records_.empty() ? nullptr : &records_.back();
+}
+
+const CommandRecord* CommandTracker::last_finished() const {
+    return find(last_finished_id_);
+}
+
+const CommandRecord* CommandTracker::last_failed() const {
+    return find(last_failed_id_);
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,73 @@
+#ifndef COLABB_COMMAND_TRACKER_HPP
+#define COLABB_COMMAND_TRACKER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace colabb {
+namespace infrastructure {
+
+// One command line run in a tab, as reported by OSC 133 marks
+struct CommandRecord {
+    std::string command;
+    // Absolute line numbers of its output in the tab's LineBuffer; end is
+    // exclusive and only meaningful once the command has finished
+    std::uint64_t output_begin = 0;
+    std::uint64_t output_end = 0;
+    bool finished = false;
+    std::optional<int> exit_code; // unset if the shell didn't report one
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point ended;
+
+    bool failed() const { return exit_code && *exit_code != 0; }
+    std::chrono::milliseconds duration() const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            (finished ? ended : std::chrono::steady_clock::now()) - started);
+    }
+};
+
+/**
+ * @brief Per-tab index of commands built from OSC 133 shell integration marks.
+ *
+ * Fed by the tab's AnsiStripper with each OSC payload and the line number it
+ * arrived at. Keeps the most recent records; the last finished and last
+ * failed ones are found in O(1). GTK thread only, like the rest of the tab.
+ */
+class CommandTracker {
+public:
+    explicit CommandTracker(size_t max_records = 256);
+
+    // Returns false for payloads that aren't OSC 133 marks
+    bool handle_osc(std::string_view payload, std::uint64_t line);
+    void clear();
+
+    // Whether the shell has emitted any mark (integration is loaded)
+    bool active() const { return active_; }
+    // Most recent command, possibly still running
+    const CommandRecord* last() const;
+    const CommandRecord* last_finished() const;
+    const CommandRecord* last_failed() const;
+    const std::deque<CommandRecord>& records() const { return records_; }
+
+private:
+    std::deque<CommandRecord> records_;
+    size_t max_records_;
+    std::uint64_t first_id_ = 0; // id of records_.front()
+    std::optional<std::uint64_t> last_finished_id_;
+    std::optional<std::uint64_t> last_failed_id_;
+    bool running_ = false;
+    bool active_ = false;
+
+    const CommandRecord* find(const std::optional<std::uint64_t>& id) const;
+    void finish(std::uint64_t line, std::optional<int> exit_code);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_COMMAND_TRACKER_HPP
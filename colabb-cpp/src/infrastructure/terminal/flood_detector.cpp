@@ -0,0 +1,60 @@
+#include "infrastructure/terminal/flood_detector.hpp"
+#include <algorithm>
+
+namespace colabb {
+namespace infrastructure {
+
+constexpr std::chrono::milliseconds FloodDetector::kBucket;
+constexpr size_t FloodDetector::kBuckets;
+
+FloodDetector::FloodDetector(size_t threshold_bytes_per_second)
+    : threshold_(std::max<size_t>(1, threshold_bytes_per_second)) {}
+
+void FloodDetector::advance(Clock::time_point now) {
+    const std::int64_t bucket = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()).count() / kBucket.count();
+    if (current_bucket_ < 0 || bucket - current_bucket_ >= static_cast<std::int64_t>(kBuckets)) {
+        buckets_.fill(0);
+        window_bytes_ = 0;
+    } else {
+        // Clear the slots that fell out of the window since the last call
+        for (std::int64_t b = current_bucket_ + 1; b <= bucket; ++b) {
+            size_t& slot = buckets_[static_cast<size_t>(b % static_cast<std::int64_t>(kBuckets))];
+            window_bytes_ -= slot;
+            slot = 0;
+        }
+    }
+    current_bucket_ = std::max(current_bucket_, bucket);
+}
+
+bool FloodDetector::record(size_t bytes, Clock::time_point now) {
+    advance(now);
+    buckets_[static_cast<size_t>(current_bucket_ % static_cast<std::int64_t>(kBuckets))] += bytes;
+    window_bytes_ += bytes;
+    return update(now);
+}
+
+bool FloodDetector::update(Clock::time_point now) {
+    advance(now);
+    const size_t rate = bytes_per_second();
+    if (!flooding_ && rate > threshold_) {
+        flooding_ = true;
+    } else if (flooding_ && rate < threshold_ / 2) {
+        flooding_ = false;
+    }
+    return flooding_;
+}
+
+void FloodDetector::reset() {
+    buckets_.fill(0);
+    current_bucket_ = -1;
+    window_bytes_ = 0;
+    flooding_ = false;
+}
+
+size_t FloodDetector::bytes_per_second() const {
+    return window_bytes_ * 1000 / static_cast<size_t>(kBucket.count() * kBuckets);
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,52 @@
+#ifndef COLABB_FLOOD_DETECTOR_HPP
+#define COLABB_FLOOD_DETECTOR_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Output-rate detector for one tab.
+ *
+ * Bytes are counted in fixed 100 ms buckets over a sliding window. The tab
+ * is flooding once the windowed rate exceeds the threshold, and stays so
+ * until it falls below half of it (hysteresis, so a bursty build doesn't
+ * flap). O(1) per call; GTK thread only.
+ */
+class FloodDetector {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FloodDetector(size_t threshold_bytes_per_second = 512 * 1024);
+
+    // Records bytes read from the PTY; returns whether the tab is flooding
+    bool record(size_t bytes, Clock::time_point now = Clock::now());
+    // Re-evaluates without new output (the rate decays as buckets expire)
+    bool update(Clock::time_point now = Clock::now());
+    bool flooding() const { return flooding_; }
+    void reset();
+
+    // Windowed rate at the last record()/update()
+    size_t bytes_per_second() const;
+
+    static constexpr std::chrono::milliseconds kBucket{100};
+    static constexpr size_t kBuckets = 10; // 1 s window
+
+private:
+    size_t threshold_;
+    std::array<size_t, kBuckets> buckets_{};
+    std::int64_t current_bucket_ = -1; // absolute bucket number of the newest slot
+    size_t window_bytes_ = 0;
+    bool flooding_ = false;
+
+    void advance(Clock::time_point now);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_FLOOD_DETECTOR_HPP
@@ -0,0 +1,87 @@
+#include "infrastructure/terminal/line_buffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace colabb {
+namespace infrastructure {
+
+LineBuffer::LineBuffer(size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)) {}
+
+void LineBuffer::append(std::string_view lines) {
+    if (lines.empty()) {
+        return;
+    }
+
+    // Index the new lines while copying them in
+    const std::uint64_t start = base_ + text_.size();
+    text_.append(lines.data(), lines.size());
+    if (lines.back() != '\n') {
+        text_.push_back('\n');
+    }
+    size_t pos = 0;
+    while (pos < lines.size()) {
+        line_starts_.push_back(start + pos);
+        ++total_lines_;
+        const void* newline = std::memchr(lines.data() + pos, '\n', lines.size() - pos);
+        if (!newline) break;
+        pos = static_cast<size_t>(static_cast<const char*>(newline) - lines.data()) + 1;
+    }
+
+    // Drop the oldest lines over capacity (the newest one is always kept)
+    const std::uint64_t first_dropped = total_lines_ - line_starts_.size();
+    const size_t dropped_from = offset(0);
+    while (line_starts_.size() > 1 && size() > capacity_) {
+        line_starts_.pop_front();
+    }
+    if (eviction_handler_ && offset(0) > dropped_from) {
+        eviction_handler_(std::string_view(text_).substr(dropped_from, offset(0) - dropped_from), first_dropped);
+    }
+
+    // Compact once the dead prefix is as large as the live data's budget
+    const size_t dead = offset(0);
+    if (dead >= capacity_) {
+        text_.erase(0, dead);
+        base_ += dead;
+    }
+}
+
+void LineBuffer::clear() {
+    base_ += text_.size();
+    text_.clear();
+    line_starts_.clear();
+    total_lines_ = 0;
+}
+
+std::string_view LineBuffer::last_lines(size_t count) const {
+    count = std::min(count, line_starts_.size());
+    if (count == 0) {
+        return {};
+    }
+    const size_t begin = offset(line_starts_.size() - count);
+    return std::string_view(text_).substr(begin);
+}
+
+std::string_view LineBuffer::span(std::uint64_t begin, std::uint64_t end) const {
+    const std::uint64_t first = total_lines_ - line_starts_.size();
+    begin = std::max(begin, first);
+    end = std::min(end, total_lines_);
+    if (begin >= end) {
+        return {};
+    }
+    const size_t from = offset(static_cast<size_t>(begin - first));
+    const size_t to = end < total_lines_ ? offset(static_cast<size_t>(end - first)) : text_.size();
+    return std::string_view(text_).substr(from, to - from);
+}
+
+std::string_view LineBuffer::line(size_t index) const {
+    if (index >= line_starts_.size()) {
+        return {};
+    }
+    const size_t begin = offset(index);
+    const size_t end = index + 1 < line_starts_.size() ? offset(index + 1) : text_.size();
+    return std::string_view(text_).substr(begin, end - begin - 1);
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,72 @@
+#ifndef COLABB_LINE_BUFFER_HPP
+#define COLABB_LINE_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Bounded, line-indexed record of a tab's plain-text output.
+ *
+ * Lines are stored back to back in one contiguous string together with the
+ * offset where each one starts, so the last N lines are a single
+ * string_view obtained in O(1) however much output is retained. Once more
+ * than capacity bytes are held the oldest lines are dropped; their bytes
+ * are compacted away in bulk, amortized O(1) per appended byte.
+ *
+ * Dropped lines can be handed to an eviction handler (the next, compressed
+ * tier of the scrollback) before they're discarded.
+ *
+ * Not thread-safe: the owning TerminalWidget feeds and reads it on the GTK
+ * thread. Views stay valid until the next append() or clear().
+ */
+class LineBuffer {
+public:
+    explicit LineBuffer(size_t capacity = 256 * 1024);
+
+    // Complete lines, each ending in '\n' (a missing final one is added)
+    void append(std::string_view lines);
+    void clear();
+
+    // Receives the lines append() drops, oldest first, with the absolute
+    // number of the first one. Lines discarded by clear() aren't passed on.
+    using EvictionHandler = std::function<void(std::string_view lines, std::uint64_t first_line)>;
+    void set_eviction_handler(EvictionHandler handler) { eviction_handler_ = std::move(handler); }
+
+    // Last min(count, line_count()) lines, oldest first, each ending in '\n'
+    std::string_view last_lines(size_t count) const;
+    // Retained line by index (0 = oldest), without its '\n'
+    std::string_view line(size_t index) const;
+    // Lines [begin, end) by absolute number (0 = first line since clear()),
+    // clipped to the retained ones
+    std::string_view span(std::uint64_t begin, std::uint64_t end) const;
+
+    size_t line_count() const { return line_starts_.size(); }
+    // Bytes of the retained lines
+    size_t size() const { return text_.size() - (line_starts_.empty() ? text_.size() : offset(0)); }
+    size_t capacity() const { return capacity_; }
+    // Lines appended since clear(), including those already dropped; the
+    // absolute number of the next line
+    std::uint64_t total_lines() const { return total_lines_; }
+
+private:
+    std::string text_;
+    std::deque<std::uint64_t> line_starts_; // absolute: text_ index + base_
+    std::uint64_t base_ = 0; // absolute position of text_[0]
+    size_t capacity_;
+    std::uint64_t total_lines_ = 0;
+    EvictionHandler eviction_handler_;
+
+    size_t offset(size_t index) const { return static_cast<size_t>(line_starts_[index] - base_); }
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_LINE_BUFFER_HPP
@@ -0,0 +1,332 @@
+#include "infrastructure/terminal/scrollback_archive.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string folded(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(), fold);
+    return result;
+}
+
+// Lines [begin, end) of text, whose first line is numbered text_first
+std::string_view slice_lines(std::string_view text, std::uint64_t text_first,
+                             std::uint64_t begin, std::uint64_t end) {
+    size_t from = 0;
+    for (std::uint64_t n = text_first; n < begin && from < text.size(); ++n) {
+        from = text.find('\n', from) + 1;
+    }
+    size_t to = from;
+    for (std::uint64_t n = std::max(begin, text_first); n < end && to < text.size(); ++n) {
+        to = text.find('\n', to) + 1;
+    }
+    return text.substr(from, to - from);
+}
+
+// Compressed bytes come from data, or from fd at offset when data is empty
+bool inflate_block(int fd, std::uint64_t offset, size_t stored_size, size_t raw_size,
+                   const std::string& data, std::string& text) {
+    std::string stored;
+    const std::string* compressed = &data;
+    if (data.empty()) {
+        if (fd < 0) {
+            return false;
+        }
+        stored.resize(stored_size);
+        size_t done = 0;
+        while (done < stored.size()) {
+            const ssize_t n = pread(fd, stored.data() + done, stored.size() - done,
+                                    static_cast<off_t>(offset + done));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        compressed = &stored;
+    }
+
+    text.resize(raw_size);
+    uLongf length = raw_size;
+    return uncompress(reinterpret_cast<Bytef*>(text.data()), &length,
+                      reinterpret_cast<const Bytef*>(compressed->data()), compressed->size()) == Z_OK &&
+           length == raw_size;
+}
+
+} // namespace
+
+constexpr size_t ScrollbackArchive::kBlockSize;
+
+ScrollbackArchive::ScrollbackArchive(size_t max_bytes, std::string directory)
+    : max_bytes_(std::max<size_t>(1, max_bytes))
+    , directory_(std::move(directory)) {}
+
+ScrollbackArchive::~ScrollbackArchive() = default;
+
+ScrollbackArchive::File::~File() {
+    close(fd);
+}
+
+std::string ScrollbackArchive::default_directory() {
+    const char* cache_home = getenv("XDG_CACHE_HOME");
+    if (cache_home) return std::string(cache_home) + "/colabb";
+
+    const char* home = getenv("HOME");
+    if (home) return std::string(home) + "/.cache/colabb";
+
+    return "/tmp/colabb";
+}
+
+void ScrollbackArchive::open_file() {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    int fd = -1;
+#ifdef O_TMPFILE
+    fd = open(directory_.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+#endif
+    if (fd < 0) {
+        // Filesystems without O_TMPFILE: same result, one syscall apart
+        std::string path = directory_ + "/scrollback_XXXXXX";
+        fd = mkostemp(path.data(), O_CLOEXEC);
+        if (fd >= 0) {
+            unlink(path.c_str());
+        }
+    }
+    if (fd < 0) {
+        std::cerr << "Scrollback archive kept in memory (" << directory_ << ": "
+                  << std::strerror(errno) << ")" << std::endl;
+        return;
+    }
+    file_ = std::make_shared<File>(fd);
+}
+
+void ScrollbackArchive::append(std::string_view lines, std::uint64_t first_line) {
+    if (lines.empty()) {
+        return;
+    }
+    if (first_line < end_line()) {
+        clear(); // numbering restarted: the old lines can't be addressed anymore
+    }
+    if (first_line != end_line()) {
+        if (!staging_.empty()) {
+            seal(staging_.size(), staging_lines_);
+        }
+        staging_first_ = first_line;
+    }
+
+    staging_.append(lines.data(), lines.size());
+    if (lines.back() != '\n') {
+        staging_ += '\n';
+    }
+    staging_lines_ += static_cast<std::uint64_t>(std::count(lines.begin(), lines.end(), '\n')) +
+                      (lines.back() != '\n' ? 1 : 0);
+
+    // Blocks end on a line boundary just past kBlockSize
+    while (staging_.size() >= kBlockSize) {
+        const size_t cut = staging_.find('\n', kBlockSize - 1) + 1;
+        seal(cut, static_cast<std::uint64_t>(std::count(staging_.begin(), staging_.begin() + cut, '\n')));
+    }
+}
+
+void ScrollbackArchive::seal(size_t length, std::uint64_t lines) {
+    uLongf stored = compressBound(length);
+    std::string compressed(stored, '\0');
+    const int status = compress2(reinterpret_cast<Bytef*>(compressed.data()), &stored,
+                                 reinterpret_cast<const Bytef*>(staging_.data()), length, Z_BEST_SPEED);
+    if (status == Z_OK) {
+        compressed.resize(stored);
+        Block block{staging_first_, lines, 0, compressed.size(), length, {}};
+
+        if (!file_opened_) {
+            file_opened_ = true;
+            open_file();
+        }
+        size_t written = 0;
+        while (file_ && written < compressed.size()) {
+            const ssize_t n = pwrite(file_->fd, compressed.data() + written, compressed.size() - written,
+                                     static_cast<off_t>(file_end_ + written));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            written += static_cast<size_t>(n);
+        }
+        if (file_ && written == compressed.size()) {
+            block.offset = file_end_;
+            file_end_ += compressed.size();
+        } else {
+            block.data = std::move(compressed); // disk full or no file: keep it here
+        }
+
+        raw_bytes_ += length;
+        stored_bytes_ += block.stored_size;
+        blocks_.push_back(std::move(block));
+    } else {
+        std::cerr << "Scrollback block dropped: zlib error " << status << std::endl;
+    }
+
+    staging_.erase(0, length);
+    staging_first_ += lines;
+    staging_lines_ -= lines;
+
+    while (stored_bytes_ > max_bytes_ && blocks_.size() > 1) {
+        drop_oldest();
+    }
+}
+
+void ScrollbackArchive::drop_oldest() {
+    const Block& block = blocks_.front();
+    if (block.data.empty() && file_) {
+        // Give the space back; the file's apparent size doesn't matter
+        fallocate(file_->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                  static_cast<off_t>(block.offset), static_cast<off_t>(block.stored_size));
+    }
+    if (cached_first_line_ == block.first_line) {
+        cached_first_line_ = UINT64_MAX;
+        cached_text_.clear();
+    }
+    raw_bytes_ -= block.raw_size;
+    stored_bytes_ -= block.stored_size;
+    blocks_.pop_front();
+}
+
+void ScrollbackArchive::clear() {
+    while (!blocks_.empty()) {
+        drop_oldest();
+    }
+    // A fresh file rather than truncating: a BlockRef still held by a
+    // search must not read new blocks at its old offset
+    file_.reset();
+    file_opened_ = false;
+    file_end_ = 0;
+    staging_.clear();
+    staging_first_ = 0;
+    staging_lines_ = 0;
+}
+
+std::uint64_t ScrollbackArchive::first_line() const {
+    return blocks_.empty() ? staging_first_ : blocks_.front().first_line;
+}
+
+size_t ScrollbackArchive::memory_bytes() const {
+    size_t in_memory = 0;
+    for (const Block& block : blocks_) {
+        in_memory += block.data.capacity();
+    }
+    return blocks_.size() * sizeof(Block) + in_memory + staging_.capacity() + cached_text_.capacity();
+}
+
+bool ScrollbackArchive::load(const Block& block, std::string& text) const {
+    return inflate_block(file_ ? file_->fd : -1, block.offset, block.stored_size, block.raw_size, block.data, text);
+}
+
+bool ScrollbackArchive::BlockRef::load(std::string& text) const {
+    return inflate_block(file ? file->fd : -1, offset, stored_size, raw_size, data, text);
+}
+
+std::vector<ScrollbackArchive::BlockRef> ScrollbackArchive::block_refs(std::uint64_t begin, std::uint64_t end) const {
+    std::vector<BlockRef> refs;
+    auto block = std::partition_point(blocks_.begin(), blocks_.end(), [begin](const Block& b) {
+        return b.first_line + b.line_count <= begin;
+    });
+    for (; block != blocks_.end() && block->first_line < end; ++block) {
+        refs.push_back({block->first_line, block->line_count, block->data.empty() ? file_ : nullptr,
+                        block->offset, block->stored_size, block->raw_size, block->data});
+    }
+    return refs;
+}
+
+const std::string* ScrollbackArchive::text_of(const Block& block) const {
+    if (cached_first_line_ != block.first_line) {
+        if (!load(block, cached_text_)) {
+            cached_first_line_ = UINT64_MAX;
+            cached_text_.clear();
+            return nullptr;
+        }
+        cached_first_line_ = block.first_line;
+    }
+    return &cached_text_;
+}
+
+std::string ScrollbackArchive::read(std::uint64_t begin, std::uint64_t end) const {
+    begin = std::max(begin, first_line());
+    end = std::min(end, end_line());
+    std::string result;
+    if (begin >= end) {
+        return result;
+    }
+
+    auto block = std::partition_point(blocks_.begin(), blocks_.end(), [begin](const Block& b) {
+        return b.first_line + b.line_count <= begin;
+    });
+    for (; block != blocks_.end() && block->first_line < end; ++block) {
+        if (const std::string* text = text_of(*block)) {
+            const std::string_view lines = slice_lines(*text, block->first_line, begin, end);
+            result.append(lines.data(), lines.size());
+        }
+    }
+    const std::string_view lines = slice_lines(staging_, staging_first_, begin, end);
+    result.append(lines.data(), lines.size());
+    return result;
+}
+
+void ScrollbackArchive::search_lines(std::string_view text, std::uint64_t first_line, std::string_view needle,
+                                     bool case_sensitive, size_t max_results, std::vector<Match>& results) {
+    if (needle.empty() || needle.find('\n') != std::string_view::npos || results.size() >= max_results) {
+        return;
+    }
+    std::string folded_text;
+    std::string folded_needle;
+    std::string_view haystack = text;
+    if (!case_sensitive) {
+        folded_text = folded(text);
+        folded_needle = folded(needle);
+        haystack = folded_text;
+        needle = folded_needle;
+    }
+
+    // One match per line, found oldest first and handed out newest first
+    std::vector<Match> found;
+    size_t line_start = 0;
+    std::uint64_t line = first_line;
+    for (size_t pos = haystack.find(needle); pos != std::string_view::npos; pos = haystack.find(needle, pos)) {
+        for (size_t newline; (newline = haystack.find('\n', line_start)) < pos; line_start = newline + 1) {
+            ++line;
+        }
+        size_t line_end = haystack.find('\n', pos);
+        if (line_end == std::string_view::npos) line_end = haystack.size();
+        found.push_back({line, std::string(text.substr(line_start, line_end - line_start))});
+        pos = line_start = line_end + 1;
+        ++line;
+        if (pos >= haystack.size()) break;
+    }
+    for (auto it = found.rbegin(); it != found.rend() && results.size() < max_results; ++it) {
+        results.push_back(std::move(*it));
+    }
+}
+
+std::vector<ScrollbackArchive::Match> ScrollbackArchive::search(std::string_view needle, bool case_sensitive,
+                                                                size_t max_results) const {
+    std::vector<Match> results;
+    search_lines(staging_, staging_first_, needle, case_sensitive, max_results, results);
+    for (auto block = blocks_.rbegin(); block != blocks_.rend() && results.size() < max_results; ++block) {
+        if (const std::string* text = text_of(*block)) {
+            search_lines(*text, block->first_line, needle, case_sensitive, max_results, results);
+        }
+    }
+    return results;
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,139 @@
+#ifndef COLABB_SCROLLBACK_ARCHIVE_HPP
+#define COLABB_SCROLLBACK_ARCHIVE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Compressed tier of a tab's scrollback, below its LineBuffer.
+ *
+ * Lines evicted from the in-memory buffer are gathered into ~64 KiB blocks,
+ * deflated and written to an anonymous file (unlinked as soon as it's
+ * created, so nothing outlives the tab, even after a crash). Only a small
+ * per-block index stays in memory, so a tab's footprint doesn't grow with
+ * its history; past max_bytes of compressed data the oldest blocks are
+ * dropped and their disk space released. If no file can be created the
+ * blocks are kept in memory under the same limit.
+ *
+ * Lines keep the absolute numbers LineBuffer gave them, so read() and
+ * search() results line up with CommandTracker records. Not thread-safe:
+ * the owning TerminalWidget uses it on the GTK thread; searches on other
+ * threads go through block_refs().
+ */
+class ScrollbackArchive {
+public:
+    explicit ScrollbackArchive(size_t max_bytes = 32 * 1024 * 1024,
+                               std::string directory = default_directory());
+    ~ScrollbackArchive();
+
+    ScrollbackArchive(const ScrollbackArchive&) = delete;
+    ScrollbackArchive& operator=(const ScrollbackArchive&) = delete;
+
+    static std::string default_directory();
+
+    // Complete lines, each ending in '\n', the first numbered first_line.
+    // Numbers are expected to keep increasing; a jump just leaves a gap.
+    void append(std::string_view lines, std::uint64_t first_line);
+    void clear();
+
+    // Lines [begin, end) by absolute number, clipped to the archived ones
+    // and decompressed on demand; each ends in '\n'
+    std::string read(std::uint64_t begin, std::uint64_t end) const;
+
+    struct Match {
+        std::uint64_t line;
+        std::string text; // without its '\n'
+    };
+    // Archived lines containing needle (ASCII case folding unless
+    // case_sensitive), newest first, at most max_results
+    std::vector<Match> search(std::string_view needle, bool case_sensitive, size_t max_results) const;
+    // The same over any run of '\n'-terminated lines (e.g. LineBuffer's),
+    // appending to results until it holds max_results
+    static void search_lines(std::string_view text, std::uint64_t first_line, std::string_view needle,
+                             bool case_sensitive, size_t max_results, std::vector<Match>& results);
+
+    // The backing file, closed once neither the archive nor a BlockRef uses it
+    struct File {
+        explicit File(int fd) : fd(fd) {}
+        ~File();
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+        const int fd;
+    };
+
+    // A sealed block, loadable from any thread while the archive moves on.
+    // Once the archive drops or clears the block, load() fails instead.
+    struct BlockRef {
+        std::uint64_t first_line;
+        std::uint64_t line_count;
+        std::shared_ptr<const File> file;
+        std::uint64_t offset;
+        size_t stored_size;
+        size_t raw_size;
+        std::string data; // copy of the compressed bytes when not in the file
+
+        bool load(std::string& text) const;
+    };
+    // Sealed blocks overlapping lines [begin, end), oldest first
+    std::vector<BlockRef> block_refs(std::uint64_t begin, std::uint64_t end) const;
+    // Lines from here on are still in the open block, not compressed yet
+    std::uint64_t sealed_end() const { return staging_first_; }
+
+    // Oldest archived line and the number following the newest one
+    std::uint64_t first_line() const;
+    std::uint64_t end_line() const { return staging_first_ + staging_lines_; }
+    bool empty() const { return blocks_.empty() && staging_lines_ == 0; }
+
+    size_t raw_bytes() const { return raw_bytes_ + staging_.size(); }
+    size_t stored_bytes() const { return stored_bytes_; }
+    // Heap used by the index, the open block and the decompression cache
+    size_t memory_bytes() const;
+    bool on_disk() const { return file_ != nullptr; }
+
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+private:
+    struct Block {
+        std::uint64_t first_line;
+        std::uint64_t line_count;
+        std::uint64_t offset; // in the file
+        size_t stored_size;
+        size_t raw_size;
+        std::string data; // the compressed bytes when there's no file
+    };
+
+    size_t max_bytes_;
+    std::string directory_;
+    std::shared_ptr<File> file_;
+    bool file_opened_ = false; // created with the first block
+    std::uint64_t file_end_ = 0;
+    std::deque<Block> blocks_;
+    std::string staging_; // newest lines, not compressed yet
+    std::uint64_t staging_first_ = 0;
+    std::uint64_t staging_lines_ = 0;
+    size_t raw_bytes_ = 0;
+    size_t stored_bytes_ = 0;
+
+    // Last block decompressed, for paging through neighbouring lines
+    mutable std::uint64_t cached_first_line_ = UINT64_MAX;
+    mutable std::string cached_text_;
+
+    void open_file();
+    void seal(size_t length, std::uint64_t lines);
+    void drop_oldest();
+    bool load(const Block& block, std::string& text) const;
+    const std::string* text_of(const Block& block) const;
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_SCROLLBACK_ARCHIVE_HPP
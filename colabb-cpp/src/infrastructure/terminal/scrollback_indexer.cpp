@@ -0,0 +1,65 @@
+#include "infrastructure/terminal/scrollback_indexer.hpp"
+
+namespace colabb {
+namespace infrastructure {
+
+ScrollbackIndexer::ScrollbackIndexer()
+    : thread_(&ScrollbackIndexer::run, this) {}
+
+ScrollbackIndexer::~ScrollbackIndexer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+ScrollbackIndexer& ScrollbackIndexer::shared() {
+    static ScrollbackIndexer indexer;
+    return indexer;
+}
+
+void ScrollbackIndexer::submit(std::shared_ptr<TrigramIndex> index, std::string lines, std::uint64_t first_line) {
+    if (!index || lines.empty()) {
+        return;
+    }
+    // Read now: a clear() between here and the worker voids the job
+    const std::uint64_t generation = index->generation();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back({std::move(index), std::move(lines), first_line, generation});
+    }
+    cv_.notify_one();
+}
+
+void ScrollbackIndexer::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+}
+
+void ScrollbackIndexer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (stop_) {
+            return;
+        }
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        job.index->add(job.lines, job.first_line, job.generation);
+        job = Job{};
+
+        lock.lock();
+        busy_ = false;
+        if (jobs_.empty()) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+} // namespace infrastructure
+} // namespace colabb
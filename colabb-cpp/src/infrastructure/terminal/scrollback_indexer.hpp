@@ -0,0 +1,61 @@
+#ifndef COLABB_SCROLLBACK_INDEXER_HPP
+#define COLABB_SCROLLBACK_INDEXER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "infrastructure/terminal/trigram_index.hpp"
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Background thread that feeds captured output into TrigramIndexes.
+ *
+ * Tabs submit each batch of lines they log and return at once; one thread
+ * shared by every tab indexes them in submission order. Jobs hold the index
+ * by shared_ptr, so a tab may close with work still queued.
+ */
+class ScrollbackIndexer {
+public:
+    ScrollbackIndexer();
+    ~ScrollbackIndexer();
+
+    ScrollbackIndexer(const ScrollbackIndexer&) = delete;
+    ScrollbackIndexer& operator=(const ScrollbackIndexer&) = delete;
+
+    // Process-wide instance used by TerminalWidget
+    static ScrollbackIndexer& shared();
+
+    void submit(std::shared_ptr<TrigramIndex> index, std::string lines, std::uint64_t first_line);
+    // Blocks until every job submitted so far has been indexed
+    void wait_idle();
+
+private:
+    struct Job {
+        std::shared_ptr<TrigramIndex> index;
+        std::string lines;
+        std::uint64_t first_line;
+        std::uint64_t generation;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idle_cv_;
+    std::deque<Job> jobs_;
+    bool busy_ = false;
+    bool stop_ = false;
+    std::thread thread_;
+
+    void run();
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_SCROLLBACK_INDEXER_HPP
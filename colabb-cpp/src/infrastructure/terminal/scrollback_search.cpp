@@ -0,0 +1,154 @@
+#include "infrastructure/terminal/scrollback_search.hpp"
+#include <algorithm>
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+// How often a scan checks whether its search was cancelled
+constexpr size_t kCancelCheckLines = 256;
+
+char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string snippet(std::string_view line) {
+    if (line.size() <= ScrollbackSearch::kMaxSnippet) {
+        return std::string(line);
+    }
+    // Don't cut a UTF-8 sequence in half
+    size_t length = ScrollbackSearch::kMaxSnippet;
+    while (length > 0 && (static_cast<unsigned char>(line[length]) & 0xC0) == 0x80) --length;
+    return std::string(line.substr(0, length));
+}
+
+} // namespace
+
+constexpr size_t ScrollbackSearch::kMaxSnippet;
+
+ScrollbackSearch::ScrollbackSearch(size_t threads) {
+    if (threads == 0) {
+        threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 8);
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back(&ScrollbackSearch::run, this);
+    }
+}
+
+ScrollbackSearch::~ScrollbackSearch() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        if (current_) current_->cancelled = true;
+        jobs_.clear();
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+std::uint64_t ScrollbackSearch::start(std::vector<SearchChunk> chunks, LineMatcher matcher, size_t max_hits,
+                                      ResultsCallback callback) {
+    auto search = std::make_shared<Search>();
+    search->matcher = std::move(matcher);
+    search->callback = std::move(callback);
+    search->max_hits = max_hits;
+    search->remaining = chunks.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_) current_->cancelled = true;
+        jobs_.clear();
+        search->id = ++next_id_;
+        current_ = search;
+        for (auto& chunk : chunks) {
+            jobs_.push_back({search, std::move(chunk)});
+        }
+    }
+    if (chunks.empty()) {
+        search->callback(search->id, {}, true);
+        return search->id;
+    }
+    cv_.notify_all();
+    return search->id;
+}
+
+void ScrollbackSearch::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_) current_->cancelled = true;
+    jobs_.clear();
+    current_.reset();
+}
+
+void ScrollbackSearch::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (stop_) {
+            return;
+        }
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        lock.unlock();
+
+        scan(*job.search, job.chunk);
+        job = Job{};
+
+        lock.lock();
+    }
+}
+
+void ScrollbackSearch::scan(Search& search, const SearchChunk& chunk) {
+    std::vector<Hit> hits;
+    std::string loaded;
+    std::string_view text;
+    if (chunk.text) {
+        text = *chunk.text;
+    } else if (chunk.block && !search.cancelled && chunk.block->load(loaded)) {
+        text = loaded; // a block the archive dropped meanwhile just has no hits
+    }
+
+    size_t pos = 0;
+    std::uint64_t line = chunk.first_line;
+    for (; line < chunk.begin && pos < text.size(); ++line) {
+        pos = text.find('\n', pos) + 1;
+    }
+    size_t scanned = 0;
+    while (line < chunk.end && pos < text.size() && search.hits < search.max_hits) {
+        if (++scanned % kCancelCheckLines == 0 && search.cancelled) {
+            return;
+        }
+        size_t end = text.find('\n', pos);
+        if (end == std::string_view::npos) end = text.size();
+        const std::string_view current = text.substr(pos, end - pos);
+        if (search.matcher(current)) {
+            if (search.hits.fetch_add(1) >= search.max_hits) break;
+            hits.push_back({chunk.source, line, snippet(current)});
+        }
+        pos = end + 1;
+        ++line;
+    }
+
+    std::reverse(hits.begin(), hits.end()); // newest first, like the chunks
+    const bool finished = search.remaining.fetch_sub(1) == 1;
+    if (!search.cancelled && (!hits.empty() || finished)) {
+        search.callback(search.id, std::move(hits), finished);
+    }
+}
+
+ScrollbackSearch::LineMatcher ScrollbackSearch::substring_matcher(std::string needle, bool case_sensitive) {
+    if (case_sensitive) {
+        return [needle = std::move(needle)](std::string_view line) {
+            return line.find(needle) != std::string_view::npos;
+        };
+    }
+    std::transform(needle.begin(), needle.end(), needle.begin(), fold);
+    return [needle = std::move(needle)](std::string_view line) {
+        return std::search(line.begin(), line.end(), needle.begin(), needle.end(),
+                           [](char a, char b) { return fold(a) == b; }) != line.end();
+    };
+}
+
+} // namespace infrastructure
+} // namespace colabb
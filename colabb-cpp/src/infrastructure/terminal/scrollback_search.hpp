@@ -0,0 +1,108 @@
+#ifndef COLABB_SCROLLBACK_SEARCH_HPP
+#define COLABB_SCROLLBACK_SEARCH_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "infrastructure/terminal/scrollback_archive.hpp"
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief One unit of search work: a run of captured lines of one source.
+ *
+ * Either a copy of lines taken on the GTK thread (text) or a sealed
+ * archive block, decompressed by the thread that scans it. Only lines
+ * [begin, end) are reported.
+ */
+struct SearchChunk {
+    size_t source;            // caller's index, e.g. of the tab
+    std::uint64_t first_line; // number of the first line of text / block
+    std::uint64_t begin;
+    std::uint64_t end;
+    std::shared_ptr<const std::string> text;
+    std::optional<ScrollbackArchive::BlockRef> block;
+};
+
+/**
+ * @brief Worker pool that searches captured output across tabs.
+ *
+ * start() queues a search's chunks (in the order given, newest output
+ * first) and returns at once; pool threads scan them in parallel and
+ * stream each chunk's hits to the callback. Starting a search cancels the
+ * previous one: its queued chunks are dropped and scans in progress stop
+ * within a few hundred lines, so it can run on every keystroke.
+ */
+class ScrollbackSearch {
+public:
+    struct Hit {
+        size_t source;
+        std::uint64_t line;
+        std::string text; // the line, cut to kMaxSnippet bytes
+    };
+
+    using LineMatcher = std::function<bool(std::string_view line)>;
+    // Called from pool threads, possibly concurrently. finished is set on
+    // the last call of a search that wasn't cancelled (hits may be empty).
+    using ResultsCallback = std::function<void(std::uint64_t search_id, std::vector<Hit> hits, bool finished)>;
+
+    // threads == 0: one per core, between 2 and 8
+    explicit ScrollbackSearch(size_t threads = 0);
+    ~ScrollbackSearch();
+
+    ScrollbackSearch(const ScrollbackSearch&) = delete;
+    ScrollbackSearch& operator=(const ScrollbackSearch&) = delete;
+
+    // Stops after max_hits hits. With no chunks, callback is called here.
+    std::uint64_t start(std::vector<SearchChunk> chunks, LineMatcher matcher, size_t max_hits,
+                        ResultsCallback callback);
+    void cancel();
+
+    // Plain-text matcher; without case_sensitive, ASCII letters are folded
+    static LineMatcher substring_matcher(std::string needle, bool case_sensitive);
+
+    static constexpr size_t kMaxSnippet = 240;
+
+private:
+    struct Search {
+        std::uint64_t id;
+        LineMatcher matcher;
+        ResultsCallback callback;
+        size_t max_hits;
+        std::atomic<bool> cancelled{false};
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> remaining{0};
+    };
+    struct Job {
+        std::shared_ptr<Search> search;
+        SearchChunk chunk;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> jobs_;
+    std::shared_ptr<Search> current_;
+    std::uint64_t next_id_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> threads_;
+
+    void run();
+    static void scan(Search& search, const SearchChunk& chunk);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_SCROLLBACK_SEARCH_HPP
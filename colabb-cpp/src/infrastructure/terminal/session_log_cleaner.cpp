@@ -0,0 +1,97 @@
+#include "infrastructure/terminal/session_log_cleaner.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+std::string process_name(const std::string& pid) {
+    std::ifstream comm("/proc/" + pid + "/comm");
+    std::string name;
+    std::getline(comm, name);
+    return name;
+}
+
+bool all_digits(const std::string& text) {
+    return !text.empty() && std::all_of(text.begin(), text.end(),
+                                        [](unsigned char c) { return std::isdigit(c); });
+}
+
+} // namespace
+
+SessionLogCleaner::SessionLogCleaner(std::string directory)
+    : directory_(std::move(directory)) {}
+
+std::string SessionLogCleaner::default_directory() {
+    // Where the script(1) logs were written; they never honoured XDG_CACHE_HOME
+    const char* home = getenv("HOME");
+    return std::string(home ? home : "/home") + "/.cache/colabb";
+}
+
+bool SessionLogCleaner::parse_owner(const std::string& filename, pid_t& pid) {
+    static const std::string kPrefix = "session_";
+    static const std::string kSuffix = ".log";
+    if (filename.size() <= kPrefix.size() + kSuffix.size() ||
+        filename.compare(0, kPrefix.size(), kPrefix) != 0 ||
+        filename.compare(filename.size() - kSuffix.size(), kSuffix.size(), kSuffix) != 0) {
+        return false;
+    }
+    const std::string middle = filename.substr(kPrefix.size(), filename.size() - kPrefix.size() - kSuffix.size());
+    const size_t separator = middle.find('_');
+    if (separator == std::string::npos || !all_digits(middle.substr(0, separator)) ||
+        !all_digits(middle.substr(separator + 1)) || separator > 9) {
+        return false;
+    }
+    pid = static_cast<pid_t>(std::stol(middle.substr(0, separator)));
+    return pid > 0;
+}
+
+bool SessionLogCleaner::is_running_colabb(pid_t pid) {
+    if (pid == getpid()) {
+        return false; // this process writes no logs: the pid was reused
+    }
+    if (kill(pid, 0) != 0 && errno != EPERM) {
+        return false;
+    }
+    // Alive, but the pid may have been recycled by an unrelated program
+    const std::string name = process_name(std::to_string(pid));
+    return name.empty() || name == process_name("self");
+}
+
+size_t SessionLogCleaner::remove_orphans() const {
+    size_t freed = 0;
+    size_t removed = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(directory_, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        pid_t pid = 0;
+        if (!parse_owner(it->path().filename().string(), pid) || is_running_colabb(pid)) {
+            continue;
+        }
+        std::error_code size_ec;
+        const auto size = it->file_size(size_ec);
+        std::error_code remove_ec;
+        if (fs::remove(it->path(), remove_ec)) {
+            freed += size_ec ? 0 : static_cast<size_t>(size);
+            ++removed;
+        }
+    }
+    if (removed > 0) {
+        std::cout << "Removed " << removed << " orphaned session log(s), "
+                  << freed / (1024 * 1024) << " MiB freed" << std::endl;
+    }
+    return freed;
+}
+
+} // namespace infrastructure
+} // namespace colabb
@@ -0,0 +1,41 @@
+#ifndef COLABB_SESSION_LOG_CLEANER_HPP
+#define COLABB_SESSION_LOG_CLEANER_HPP
+
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Removes session logs left behind by earlier Colabb processes.
+ *
+ * Builds that captured tab output through script(1) wrote
+ * ~/.cache/colabb/session_<pid>_<tab>.log and only deleted it when the tab
+ * closed cleanly, so a crash or kill left it on disk for good. Output now
+ * stays in memory; run this once at startup to reclaim what remains.
+ */
+class SessionLogCleaner {
+public:
+    explicit SessionLogCleaner(std::string directory = default_directory());
+
+    static std::string default_directory();
+
+    // Deletes every session log whose owning process is no longer a running
+    // Colabb. Returns the number of bytes freed.
+    size_t remove_orphans() const;
+
+    // Owner pid from "session_<pid>_<tab>.log"; false for any other name
+    static bool parse_owner(const std::string& filename, pid_t& pid);
+
+private:
+    std::string directory_;
+
+    static bool is_running_colabb(pid_t pid);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_SESSION_LOG_CLEANER_HPP
@@ -0,0 +1,240 @@
+#include "infrastructure/terminal/shell_integration.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+const char* kBashScript = R"SH(# Colabb shell integration for bash: OSC 133 command marks.
+# Loaded with --rcfile, so the user's ~/.bashrc still runs first.
+[ -r ~/.bashrc ] && . ~/.bashrc
+
+if [[ $- == *i* && -z $__colabb_hooks ]]; then
+    __colabb_hooks=1
+    __colabb_at_prompt=0
+    __colabb_running=0
+
+    __colabb_precmd() {
+        local status=$?
+        # Everything until __colabb_prompt_ready belongs to PROMPT_COMMAND
+        __colabb_at_prompt=0
+        if (( __colabb_running )); then
+            printf '\e]133;D;%s\a' "$status"
+            __colabb_running=0
+        fi
+        printf '\e]133;A\a'
+        return $status
+    }
+
+    __colabb_prompt_ready() {
+        __colabb_at_prompt=1
+    }
+
+    __colabb_preexec() {
+        # Only the first command after a prompt; not completions or PROMPT_COMMAND
+        [[ $__colabb_at_prompt == 1 && -z $COMP_LINE && $BASH_COMMAND != __colabb_precmd* ]] || return
+        __colabb_at_prompt=0
+        __colabb_running=1
+        local line
+        line=$(HISTTIMEFORMAT= builtin history 1)
+        if [[ $line =~ ^\ *[0-9]+\*?\ +(.*)$ ]]; then
+            line=${BASH_REMATCH[1]}
+        else
+            line=$BASH_COMMAND
+        fi
+        line=${line//$'\e'/}
+        printf '\e]133;C;cmdline=%s\a' "${line//$'\a'/}"
+    }
+
+    # Ours first, so the exit status is read before the user's entries
+    # change it, and the prompt is only ready after the last of them
+    if [[ $(declare -p PROMPT_COMMAND 2>/dev/null) == "declare -a"* ]]; then
+        PROMPT_COMMAND=(__colabb_precmd "${PROMPT_COMMAND[@]}" __colabb_prompt_ready)
+    else
+        PROMPT_COMMAND=__colabb_precmd$'\n'${PROMPT_COMMAND:+$PROMPT_COMMAND$'\n'}__colabb_prompt_ready
+    fi
+
+    # Keep a DEBUG trap the user already set, running after ours
+    __colabb_trap=$(trap -p DEBUG)
+    if [[ -n $__colabb_trap ]]; then
+        eval "trap -- '__colabb_preexec; ${__colabb_trap#trap -- \'}"
+    else
+        trap '__colabb_preexec' DEBUG
+    fi
+    unset __colabb_trap
+fi
+)SH";
+
+// zsh reads every startup file from $ZDOTDIR: each one here sources the
+// user's counterpart, and .zshrc hands ZDOTDIR back for .zlogin/.zlogout.
+const char* kZshEnv = R"SH(# Colabb shell integration for zsh
+__colabb_zdotdir=$ZDOTDIR
+ZDOTDIR=${COLABB_USER_ZDOTDIR:-$HOME}
+[[ -r $ZDOTDIR/.zshenv ]] && . $ZDOTDIR/.zshenv
+COLABB_USER_ZDOTDIR=$ZDOTDIR
+ZDOTDIR=$__colabb_zdotdir
+)SH";
+
+const char* kZshProfile = R"SH(# Colabb shell integration for zsh
+ZDOTDIR=$COLABB_USER_ZDOTDIR
+[[ -r $ZDOTDIR/.zprofile ]] && . $ZDOTDIR/.zprofile
+ZDOTDIR=$__colabb_zdotdir
+)SH";
+
+const char* kZshRc = R"SH(# Colabb shell integration for zsh: OSC 133 command marks
+ZDOTDIR=$COLABB_USER_ZDOTDIR
+unset __colabb_zdotdir COLABB_USER_ZDOTDIR
+[[ -r $ZDOTDIR/.zshrc ]] && . $ZDOTDIR/.zshrc
+
+if [[ -o interactive ]]; then
+    typeset -gi __colabb_running=0
+
+    __colabb_precmd() {
+        local ret=$?
+        if (( __colabb_running )); then
+            printf '\e]133;D;%s\a' $ret
+            __colabb_running=0
+        fi
+        printf '\e]133;A\a'
+    }
+
+    __colabb_preexec() {
+        __colabb_running=1
+        local cmd=${1//$'\e'/}
+        printf '\e]133;C;cmdline=%s\a' "${cmd//$'\a'/}"
+    }
+
+    # First, so the exit status is read before other hooks change it
+    precmd_functions=(__colabb_precmd $precmd_functions)
+    preexec_functions+=(__colabb_preexec)
+fi
+)SH";
+
+const char* kFishScript = R"SH(# Colabb shell integration for fish: OSC 133 command marks
+status is-interactive; or exit
+set -q COLABB_SHELL_INTEGRATION; or exit
+set -e COLABB_SHELL_INTEGRATION
+
+function __colabb_prompt --on-event fish_prompt
+    printf '\e]133;A\a'
+end
+
+function __colabb_preexec --on-event fish_preexec
+    printf '\e]133;C;cmdline=%s\a' (string join \n -- $argv | string replace -ra '[\e\a]' '' | string collect)
+end
+
+function __colabb_postexec --on-event fish_postexec
+    printf '\e]133;D;%s\a' $status
+end
+)SH";
+
+// Rewrites path only when its content differs; tmp + rename so concurrent
+// instances never see a partial script
+bool write_if_changed(const fs::path& path, const std::string& content) {
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (in) {
+            std::ostringstream current;
+            current << in.rdbuf();
+            if (current.str() == content) {
+                return true;
+            }
+        }
+    }
+    const fs::path tmp = path.string() + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out << content;
+        if (!out) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+std::string env_or(const char* name, const std::string& fallback) {
+    const char* value = getenv(name);
+    return value && *value ? value : fallback;
+}
+
+} // namespace
+
+ShellIntegration::ShellIntegration(std::string script_dir)
+    : script_dir_(std::move(script_dir)) {}
+
+std::string ShellIntegration::default_script_dir() {
+    const char* cache_home = getenv("XDG_CACHE_HOME");
+    if (cache_home) return std::string(cache_home) + "/colabb/shell-integration";
+
+    const char* home = getenv("HOME");
+    if (home) return std::string(home) + "/.cache/colabb/shell-integration";
+
+    return "/tmp/colabb/shell-integration";
+}
+
+bool ShellIntegration::install() {
+    if (installed_) {
+        return true;
+    }
+    const fs::path dir(script_dir_);
+    std::error_code ec;
+    fs::create_directories(dir / "zsh", ec);
+    fs::create_directories(dir / "fish" / "fish" / "vendor_conf.d", ec);
+    installed_ = write_if_changed(dir / "bashrc", kBashScript) &&
+                 write_if_changed(dir / "zsh" / ".zshenv", kZshEnv) &&
+                 write_if_changed(dir / "zsh" / ".zprofile", kZshProfile) &&
+                 write_if_changed(dir / "zsh" / ".zshrc", kZshRc) &&
+                 write_if_changed(dir / "fish" / "fish" / "vendor_conf.d" / "colabb.fish", kFishScript);
+    if (!installed_) {
+        std::cerr << "Failed to write shell integration to " << script_dir_ << std::endl;
+    }
+    return installed_;
+}
+
+bool ShellIntegration::apply(std::vector<std::string>& argv, Environment& env) {
+    if (argv.empty()) {
+        return false;
+    }
+    const std::string shell = fs::path(argv[0]).filename().string();
+    // bash ignores --rcfile in login shells and with extra arguments we
+    // can't reason about, so only a plain interactive bash is wrapped
+    if (shell == "bash" && argv.size() == 1) {
+        if (!install()) return false;
+        argv.push_back("--rcfile");
+        argv.push_back(script_dir_ + "/bashrc");
+        return true;
+    }
+    if (shell == "zsh") {
+        if (!install()) return false;
+        if (const char* zdotdir = getenv("ZDOTDIR")) {
+            env.emplace_back("COLABB_USER_ZDOTDIR", zdotdir);
+        }
+        env.emplace_back("ZDOTDIR", script_dir_ + "/zsh");
+        return true;
+    }
+    if (shell == "fish") {
+        if (!install()) return false;
+        env.emplace_back("XDG_DATA_DIRS",
+                         script_dir_ + "/fish:" + env_or("XDG_DATA_DIRS", "/usr/local/share:/usr/share"));
+        env.emplace_back("COLABB_SHELL_INTEGRATION", "1");
+        return true;
+    }
+    return false;
+}
+
+} // namespace infrastructure
+} // namespace colabb
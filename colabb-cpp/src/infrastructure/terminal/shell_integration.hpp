@@ -0,0 +1,47 @@
+#ifndef COLABB_SHELL_INTEGRATION_HPP
+#define COLABB_SHELL_INTEGRATION_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Hooks that make bash, zsh and fish report OSC 133 command marks.
+ *
+ * The scripts emit, around every command line:
+ *   OSC 133;A                    prompt about to be drawn
+ *   OSC 133;C;cmdline=<command>  command accepted, its output follows
+ *   OSC 133;D;<exit status>      command finished
+ * They are written to a per-user directory and loaded without touching the
+ * user's own startup files: bash through --rcfile (which sources ~/.bashrc
+ * first), zsh through a ZDOTDIR that chains to the user's files, and fish
+ * through a vendor_conf.d snippet on XDG_DATA_DIRS.
+ */
+class ShellIntegration {
+public:
+    using Environment = std::vector<std::pair<std::string, std::string>>;
+
+    explicit ShellIntegration(std::string script_dir = default_script_dir());
+
+    // $XDG_CACHE_HOME/colabb/shell-integration (or ~/.cache/...)
+    static std::string default_script_dir();
+
+    // Rewrites a shell launch so the hooks load. argv[0] selects the shell;
+    // variables to set are appended to env. Returns false, leaving both
+    // untouched, for unsupported shells or if the scripts can't be written.
+    bool apply(std::vector<std::string>& argv, Environment& env);
+
+private:
+    std::string script_dir_;
+    bool installed_ = false;
+
+    bool install();
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_SHELL_INTEGRATION_HPP
@@ -0,0 +1,370 @@
+#include "infrastructure/terminal/trigram_index.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace colabb {
+namespace infrastructure {
+
+namespace {
+
+constexpr unsigned kHashBits = 16;
+constexpr size_t kOpenWords = (size_t{1} << kHashBits) / 64;
+constexpr size_t kMinWords = 8; // 512 bits
+
+unsigned char fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+}
+
+std::uint32_t hash_trigram(std::uint32_t trigram) {
+    return (trigram * 0x9E3779B1u) >> (32 - kHashBits);
+}
+
+// Calls sink(hash) for every trigram of text that doesn't cross a line
+template <typename Sink>
+void for_each_trigram(std::string_view text, Sink&& sink) {
+    std::uint32_t window = 0;
+    int valid = 0;
+    for (const char ch : text) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (c == '\n') {
+            valid = 0;
+            continue;
+        }
+        window = ((window << 8) | fold(c)) & 0xFFFFFFu;
+        if (++valid >= 3) {
+            sink(hash_trigram(window));
+        }
+    }
+}
+
+// Index just past the ']' closing the class opened at pattern[start]
+size_t skip_class(std::string_view pattern, size_t start) {
+    size_t i = start + 1;
+    if (i < pattern.size() && pattern[i] == '^') ++i;
+    if (i < pattern.size() && pattern[i] == ']') ++i; // leading ']' is literal
+    while (i < pattern.size() && pattern[i] != ']') {
+        i += pattern[i] == '\\' ? 2 : 1;
+    }
+    return std::min(i + 1, pattern.size());
+}
+
+// Index just past the ')' closing the group opened at pattern[start]
+size_t skip_group(std::string_view pattern, size_t start) {
+    int depth = 0;
+    size_t i = start;
+    while (i < pattern.size()) {
+        const char c = pattern[i];
+        if (c == '\\') {
+            i += 2;
+            continue;
+        }
+        if (c == '[') {
+            i = skip_class(pattern, i);
+            continue;
+        }
+        if (c == '(') ++depth;
+        if (c == ')' && --depth == 0) return i + 1;
+        ++i;
+    }
+    return pattern.size();
+}
+
+// Index past the argument of the escape \<letter> whose argument starts
+// at pattern[i] (i itself when it takes none)
+size_t skip_escape_argument(std::string_view pattern, char letter, size_t i) {
+    auto skip_braced = [&](char open, char close) {
+        if (i < pattern.size() && pattern[i] == open) {
+            const size_t end = pattern.find(close, i);
+            return end == std::string_view::npos ? pattern.size() : end + 1;
+        }
+        return i;
+    };
+    switch (letter) {
+    case 'x': {
+        const size_t braced = skip_braced('{', '}');
+        if (braced != i) return braced;
+        size_t end = i;
+        while (end < pattern.size() && end < i + 2 && std::isxdigit(static_cast<unsigned char>(pattern[end]))) ++end;
+        return end;
+    }
+    case 'p':
+    case 'P': {
+        const size_t braced = skip_braced('{', '}');
+        return braced != i ? braced : std::min(i + 1, pattern.size());
+    }
+    case 'o':
+        return skip_braced('{', '}');
+    case 'c':
+        return std::min(i + 1, pattern.size());
+    case 'g':
+    case 'k':
+        if (i < pattern.size() && (pattern[i] == '{' || pattern[i] == '<' || pattern[i] == '\'')) {
+            return skip_braced(pattern[i], pattern[i] == '{' ? '}' : pattern[i] == '<' ? '>' : '\'');
+        }
+        if (i < pattern.size() && pattern[i] == '-') ++i;
+        [[fallthrough]];
+    default:
+        // Back-references and octal escapes run over the following digits
+        if (std::isdigit(static_cast<unsigned char>(letter)) || letter == 'g' || letter == 'k') {
+            while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) ++i;
+        }
+        return i;
+    }
+}
+
+} // namespace
+
+constexpr size_t TrigramIndex::kSegmentBytes;
+
+TrigramIndex::TrigramIndex(size_t max_bytes)
+    : max_bytes_(max_bytes)
+    , open_bits_(kOpenWords, 0) {}
+
+void TrigramIndex::add(std::string_view lines, std::uint64_t first_line, std::uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation != generation_.load() || lines.empty() || first_line < open_end_) {
+        return;
+    }
+    if (first_line != open_end_) {
+        seal_locked();
+        if (segments_.empty()) {
+            indexed_begin_ = first_line;
+        }
+        open_begin_ = open_end_ = first_line;
+    }
+
+    for_each_trigram(lines, [this](std::uint32_t hash) {
+        open_bits_[hash >> 6] |= std::uint64_t{1} << (hash & 63);
+    });
+    open_end_ += static_cast<std::uint64_t>(std::count(lines.begin(), lines.end(), '\n')) +
+                 (lines.back() != '\n' ? 1 : 0);
+    open_bytes_ += lines.size();
+    if (open_bytes_ >= kSegmentBytes) {
+        seal_locked();
+    }
+}
+
+void TrigramIndex::seal_locked() {
+    if (open_end_ == open_begin_) {
+        return;
+    }
+
+    // h mod 2^k of a folded filter is h's bit in the full one: halve while
+    // no more than half of the bits end up set
+    std::vector<std::uint64_t> bits = open_bits_;
+    size_t words = bits.size();
+    while (words > kMinWords) {
+        const size_t half = words / 2;
+        size_t set = 0;
+        for (size_t i = 0; i < half; ++i) {
+            set += static_cast<size_t>(__builtin_popcountll(bits[i] | bits[i + half]));
+        }
+        if (set * 2 > half * 64) break;
+        for (size_t i = 0; i < half; ++i) {
+            bits[i] |= bits[i + half];
+        }
+        words = half;
+    }
+    bits.resize(words);
+    bits.shrink_to_fit();
+
+    segments_bytes_ += sizeof(Segment) + words * sizeof(std::uint64_t);
+    segments_.push_back({open_begin_, open_end_, std::move(bits)});
+    while (segments_bytes_ > max_bytes_ && !segments_.empty()) {
+        // Over budget: the oldest lines become unfiltered candidates
+        indexed_begin_ = segments_.front().end;
+        segments_bytes_ -= sizeof(Segment) + segments_.front().bits.size() * sizeof(std::uint64_t);
+        segments_.pop_front();
+    }
+
+    std::fill(open_bits_.begin(), open_bits_.end(), 0);
+    open_begin_ = open_end_;
+    open_bytes_ = 0;
+}
+
+void TrigramIndex::reset_locked() {
+    segments_.clear();
+    segments_bytes_ = 0;
+    indexed_begin_ = 0;
+    std::fill(open_bits_.begin(), open_bits_.end(), 0);
+    open_begin_ = open_end_ = 0;
+    open_bytes_ = 0;
+}
+
+void TrigramIndex::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    reset_locked();
+}
+
+void TrigramIndex::drop_before(std::uint64_t line) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!segments_.empty() && segments_.front().end <= line) {
+        segments_bytes_ -= sizeof(Segment) + segments_.front().bits.size() * sizeof(std::uint64_t);
+        segments_.pop_front();
+    }
+    // Lines before `line` are gone: no need to report them as unindexed
+    const std::uint64_t covered = segments_.empty() ? open_begin_ : segments_.front().begin;
+    indexed_begin_ = std::max(indexed_begin_, std::min(line, covered));
+}
+
+bool TrigramIndex::contains(const std::vector<std::uint64_t>& bits, const std::vector<std::uint32_t>& hashes) {
+    const std::uint32_t mask = static_cast<std::uint32_t>(bits.size() * 64 - 1);
+    return std::all_of(hashes.begin(), hashes.end(), [&](std::uint32_t hash) {
+        const std::uint32_t bit = hash & mask;
+        return (bits[bit >> 6] >> (bit & 63)) & 1;
+    });
+}
+
+std::vector<TrigramIndex::LineRange> TrigramIndex::candidates(const std::vector<std::string>& literals) const {
+    std::vector<std::uint32_t> hashes;
+    for (const auto& literal : literals) {
+        for_each_trigram(literal, [&hashes](std::uint32_t hash) { hashes.push_back(hash); });
+    }
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    if (hashes.empty()) {
+        return {{0, UINT64_MAX}};
+    }
+
+    std::vector<LineRange> ranges;
+    auto push = [&ranges](std::uint64_t begin, std::uint64_t end) {
+        if (begin >= end) return;
+        if (!ranges.empty() && ranges.back().end == begin) {
+            ranges.back().end = end;
+        } else {
+            ranges.push_back({begin, end});
+        }
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    push(0, indexed_begin_);
+    for (const Segment& segment : segments_) {
+        if (contains(segment.bits, hashes)) {
+            push(segment.begin, segment.end);
+        }
+    }
+    if (contains(open_bits_, hashes)) {
+        push(open_begin_, open_end_);
+    }
+    push(open_end_, UINT64_MAX); // still queued for indexing
+    return ranges;
+}
+
+std::vector<std::string> TrigramIndex::required_literals(std::string_view pattern, bool regex, bool case_sensitive) {
+    std::vector<std::string> literals;
+    std::string run;
+    auto flush = [&]() {
+        if (run.size() >= 3) literals.push_back(run);
+        run.clear();
+    };
+    // Inline flags such as (?i) may turn on caseless matching
+    if (regex && pattern.find("(?") != std::string_view::npos) {
+        case_sensitive = false;
+    }
+    auto literal = [&](char c) {
+        if (!case_sensitive && static_cast<unsigned char>(c) >= 0x80) {
+            flush();
+        } else {
+            run += c;
+        }
+    };
+
+    if (!regex) {
+        for (const char c : pattern) {
+            literal(c);
+        }
+        flush();
+        return literals;
+    }
+    if (pattern.find('|') != std::string_view::npos) {
+        return {}; // alternation: no substring is required for sure
+    }
+
+    size_t i = 0;
+    while (i < pattern.size()) {
+        const char c = pattern[i];
+        switch (c) {
+        case '\\': {
+            if (i + 1 >= pattern.size()) {
+                ++i;
+                break;
+            }
+            const char next = pattern[i + 1];
+            i += 2;
+            if (next == 'Q') {
+                // \Q...\E quotes everything in between
+                const size_t end = std::min(pattern.find("\\E", i), pattern.size());
+                for (; i < end; ++i) literal(pattern[i]);
+                i = std::min(end + 2, pattern.size());
+            } else if (std::isalnum(static_cast<unsigned char>(next))) {
+                // \d, \b, \x41, \p{L}, \k<name>, \1...: not text, and some
+                // take an argument that isn't text either
+                flush();
+                i = skip_escape_argument(pattern, next, i);
+            } else {
+                literal(next);
+            }
+            break;
+        }
+        case '[':
+            flush();
+            i = skip_class(pattern, i);
+            break;
+        case '(':
+            flush();
+            i = skip_group(pattern, i);
+            break;
+        case '*':
+        case '?':
+            if (!run.empty()) run.pop_back(); // the previous atom is optional
+            flush();
+            ++i;
+            break;
+        case '{':
+            if (i + 1 < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i + 1]))) {
+                if (!run.empty()) run.pop_back(); // may repeat zero times
+                flush();
+                while (i < pattern.size() && pattern[i] != '}') ++i;
+                ++i;
+            } else {
+                literal(c);
+                ++i;
+            }
+            break;
+        case '+':
+        case '.':
+        case '^':
+        case '$':
+        case ')':
+            flush();
+            ++i;
+            break;
+        default:
+            literal(c);
+            ++i;
+            break;
+        }
+    }
+    flush();
+    return literals;
+}
+
+std::uint64_t TrigramIndex::indexed_end() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return open_end_;
+}
+
+size_t TrigramIndex::segment_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size();
+}
+
+size_t TrigramIndex::memory_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_bytes_ + open_bits_.size() * sizeof(std::uint64_t);
+}
+
+} // namespace infrastructure
+} // namespace colabb
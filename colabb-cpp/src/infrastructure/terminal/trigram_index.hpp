@@ -0,0 +1,91 @@
+#ifndef COLABB_TRIGRAM_INDEX_HPP
+#define COLABB_TRIGRAM_INDEX_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace colabb {
+namespace infrastructure {
+
+/**
+ * @brief Trigram filter over a tab's captured output, by line ranges.
+ *
+ * Lines are grouped into ~32 KiB segments; each keeps the set of its
+ * (ASCII case-folded) trigrams as a hashed bitmap, folded down until about
+ * half its bits are set, so the index costs a few percent of the text it
+ * covers. A query's required literals then rule out every segment missing
+ * one of their trigrams; only the remaining candidate ranges need the real
+ * regex. Hash collisions can only add candidates, never lose a match.
+ *
+ * Thread-safe: a ScrollbackIndexer adds lines in the background while the
+ * GTK thread queries. Lines not indexed yet (or beyond the memory budget)
+ * are always returned as candidates.
+ */
+class TrigramIndex {
+public:
+    struct LineRange {
+        std::uint64_t begin;
+        std::uint64_t end;
+    };
+
+    explicit TrigramIndex(size_t max_bytes = 4 * 1024 * 1024);
+
+    // Complete lines, the first numbered first_line. Ignored when clear()
+    // was called after generation was read (a job from a previous session).
+    void add(std::string_view lines, std::uint64_t first_line, std::uint64_t generation);
+    void add(std::string_view lines, std::uint64_t first_line) { add(lines, first_line, generation()); }
+    void clear();
+    // Forget segments entirely before line (no longer in the history)
+    void drop_before(std::uint64_t line);
+    std::uint64_t generation() const { return generation_.load(); }
+
+    // Line ranges, ascending and disjoint, that may contain every literal;
+    // the tail range runs to UINT64_MAX. No literals: everything.
+    std::vector<LineRange> candidates(const std::vector<std::string>& literals) const;
+
+    // Substrings any match of pattern must contain, at least 3 bytes long
+    // (empty when nothing can be required, e.g. with alternation). Without
+    // case_sensitive, runs stop at non-ASCII bytes, whose folding the index
+    // doesn't model.
+    static std::vector<std::string> required_literals(std::string_view pattern, bool regex, bool case_sensitive);
+
+    // Number following the last indexed line
+    std::uint64_t indexed_end() const;
+    size_t segment_count() const;
+    size_t memory_bytes() const;
+
+    static constexpr size_t kSegmentBytes = 32 * 1024;
+
+private:
+    struct Segment {
+        std::uint64_t begin;
+        std::uint64_t end;
+        std::vector<std::uint64_t> bits; // power-of-two bit count
+    };
+
+    mutable std::mutex mutex_;
+    std::atomic<std::uint64_t> generation_{0};
+    size_t max_bytes_;
+    std::deque<Segment> segments_;
+    size_t segments_bytes_ = 0;
+    std::uint64_t indexed_begin_ = 0; // earlier lines have no segment
+    std::vector<std::uint64_t> open_bits_; // full-width filter of the open segment
+    std::uint64_t open_begin_ = 0;
+    std::uint64_t open_end_ = 0;
+    size_t open_bytes_ = 0;
+
+    void seal_locked();
+    void reset_locked();
+    static bool contains(const std::vector<std::uint64_t>& bits, const std::vector<std::uint32_t>& hashes);
+};
+
+} // namespace infrastructure
+} // namespace colabb
+
+#endif // COLABB_TRIGRAM_INDEX_HPP
@@ -1,21 +1,121 @@
 #include "infrastructure/terminal/vte_terminal.hpp"
-#include <fstream>
-#include <sstream>
-#include <regex>
+#include "infrastructure/terminal/scrollback_indexer.hpp"
+#include "infrastructure/terminal/shell_integration.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
-#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <glib-unix.h>
 #include <unistd.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <filesystem>
+#include <sys/ioctl.h>
 
 namespace colabb {
 namespace infrastructure {
 
+namespace {
+
+// Bytes read from the PTY per main-loop dispatch before yielding to GTK
+constexpr size_t kMaxReadPerDispatch = 256 * 1024;
+
+// How often a flooding tab checks whether the output calmed down
+constexpr guint kFloodCheckIntervalMs = 250;
+
+// Minimum time between two reads of VTE's grid while it keeps changing
+constexpr std::chrono::milliseconds kScreenRefreshInterval(250);
+
+// pcre2.h isn't included for two flags of vte_regex_new_for_search()
+constexpr guint32 kPcre2Caseless = 0x00000008u;
+constexpr guint32 kPcre2Multiline = 0x00000400u; // required by VTE's search
+
+// Rough per-cell cost of VTE's row storage (character + attributes)
+constexpr size_t kScrollbackBytesPerCell = 8;
+
+// Runs in the forked child: make the PTY slave its controlling terminal
+void attach_child_to_pty(gpointer user_data) {
+    const char* slave_name = static_cast<const char*>(user_data);
+    setsid();
+    int slave = open(slave_name, O_RDWR);
+    if (slave < 0) {
+        _exit(127);
+    }
+    ioctl(slave, TIOCSCTTY, 0);
+    dup2(slave, STDIN_FILENO);
+    dup2(slave, STDOUT_FILENO);
+    dup2(slave, STDERR_FILENO);
+    if (slave > STDERR_FILENO) {
+        close(slave);
+    }
+}
+
+void reap_child(GPid pid, gint, gpointer) {
+    g_spawn_close_pid(pid);
+}
+
+// Rows [first, last] of the terminal as plain text, one '\n' per row;
+// g_free() the result
+char* text_of_rows(::VteTerminal* terminal, glong first, glong last) {
+    const glong columns = vte_terminal_get_column_count(terminal);
+#if VTE_CHECK_VERSION(0, 76, 0)
+    return vte_terminal_get_text_range_format(terminal, VTE_FORMAT_TEXT, first, 0, last, columns - 1, nullptr);
+#else
+    return vte_terminal_get_text_range(terminal, first, 0, last, columns - 1, nullptr, nullptr, nullptr);
+#endif
+}
+
+// Whether a terminal row shows the start of a captured line. Blanks are
+// skipped on both sides (tabs become spaces on screen); the row may end
+// early where the line wraps, and the line early if it was cut to a snippet.
+bool row_shows_line(std::string_view row, std::string_view line) {
+    auto skip_blanks = [](std::string_view text, size_t& pos) {
+        while (pos < text.size() && g_ascii_isspace(text[pos])) ++pos;
+        return pos < text.size();
+    };
+    size_t r = 0;
+    size_t l = 0;
+    bool compared = false;
+    while (skip_blanks(row, r) && skip_blanks(line, l)) {
+        if (row[r++] != line[l++]) {
+            return false;
+        }
+        compared = true;
+    }
+    const bool row_left = skip_blanks(row, r);
+    return compared && (!row_left || line.size() >= ScrollbackSearch::kMaxSnippet);
+}
+
+GRegex* compile_search_regex(const std::string& pattern, bool case_sensitive, bool regex) {
+    gchar* escaped = regex ? nullptr : g_regex_escape_string(pattern.c_str(), -1);
+    const int flags = G_REGEX_OPTIMIZE | (case_sensitive ? 0 : G_REGEX_CASELESS);
+    GRegex* compiled = g_regex_new(regex ? pattern.c_str() : escaped, static_cast<GRegexCompileFlags>(flags),
+                                   static_cast<GRegexMatchFlags>(0), nullptr);
+    g_free(escaped);
+    return compiled;
+}
+
+} // namespace
+
 TerminalWidget::TerminalWidget() 
     : vte_widget_(VTE_TERMINAL(vte_terminal_new()))
-    , session_log_path_()
-    , key_press_callback_(nullptr) {
+    , index_(std::make_shared<TrigramIndex>())
+    , pty_master_(-1)
+    , child_pid_(0)
+    , pty_read_source_(0)
+    , pty_write_source_(0)
+    , child_watch_source_(0)
+    , pty_columns_(0)
+    , pty_rows_(0)
+    , elided_lines_(0)
+    , line_shift_(0)
+    , flood_check_source_(0)
+    , screen_dirty_(true)
+    , screen_scrollback_rows_(-1)
+    , screen_top_row_(-1)
+    , key_press_callback_(nullptr)
+    , scrollback_lines_(domain::TerminalProfile::create_default().scrollback_lines)
+    , scrollback_limit_(scrollback_lines_)
+    , last_output_(std::chrono::steady_clock::now()) {
     
     // Set up terminal appearance
     GdkRGBA bg_color, fg_color;
@@ -29,117 +129,482 @@ TerminalWidget::TerminalWidget()
     // Connect key press event
     g_signal_connect(GTK_WIDGET(vte_widget_), "key-press-event",
                      G_CALLBACK(on_key_press_static), this);
+    g_signal_connect(vte_widget_, "contents-changed",
+                     G_CALLBACK(on_contents_changed_static), this);
+    g_signal_connect(vte_widget_, "current-directory-uri-changed",
+                     G_CALLBACK(on_directory_changed_static), this);
+    // Without a VTE-owned PTY, input and terminal replies only reach us here
+    g_signal_connect(vte_widget_, "commit",
+                     G_CALLBACK(on_commit_static), this);
+    g_signal_connect_after(GTK_WIDGET(vte_widget_), "size-allocate",
+                           G_CALLBACK(on_size_allocate_static), this);
+
+    // Older output is compressed rather than lost
+    output_.set_eviction_handler([this](std::string_view lines, std::uint64_t first_line) {
+        archive_.append(lines, first_line);
+        index_->drop_before(archive_.first_line());
+    });
+
+    // Marks are handled mid-chunk, so line numbers match output_ exactly
+    stripper_.set_osc_handler([this](std::string_view payload) {
+        commands_.handle_osc(payload, current_line());
+    });
 }
 
 TerminalWidget::~TerminalWidget() {
-    // Cleanup log file
-    if (!session_log_path_.empty()) {
-        unlink(session_log_path_.c_str());
+    close_pty();
+}
+
+void TerminalWidget::close_pty() {
+    if (pty_read_source_) g_source_remove(pty_read_source_);
+    if (pty_write_source_) g_source_remove(pty_write_source_);
+    if (flood_check_source_) g_source_remove(flood_check_source_);
+    pty_read_source_ = pty_write_source_ = flood_check_source_ = 0;
+    if (child_watch_source_) {
+        // The shell gets SIGHUP below; still reap it once it exits
+        g_source_remove(child_watch_source_);
+        g_child_watch_add(child_pid_, reap_child, nullptr);
+        child_watch_source_ = 0;
     }
+    if (pty_master_ >= 0) {
+        close(pty_master_);
+        pty_master_ = -1;
+    }
+    pending_input_.clear();
 }
 
 void TerminalWidget::spawn_shell(const std::string& shell_path) {
     const char* home = getenv("HOME");
     if (!home) home = "/home";
 
-    // Set up session log per terminal tab to avoid cross-tab context contamination.
-    std::filesystem::path log_dir = std::filesystem::path(home) / ".cache" / "colabb";
-    std::error_code ec;
-    std::filesystem::create_directories(log_dir, ec);
-    session_log_path_ = (log_dir / ("session_" + std::to_string(getpid()) + "_" +
-                                    std::to_string(reinterpret_cast<uintptr_t>(this)) + ".log")).string();
-    unlink(session_log_path_.c_str());
-    
-    // Wrap shell in 'script' command for logging
-    const char* argv[] = {
-        "/usr/bin/script",
-        "-q",
-        "-f",
-        session_log_path_.c_str(),
-        "-c",
-        shell_path.c_str(),
-        nullptr
-    };
-    
-    const char* envp[] = { nullptr };
-    
+    close_pty();
+    stripper_.reset();
+    output_.clear();
+    archive_.clear();
+    index_->clear();
+    commands_.clear();
+    flood_.reset();
+    elided_lines_ = 0;
+    line_shift_ = 0;
+    row_anchors_.clear();
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        g_printerr("Failed to open PTY: %s\n", g_strerror(errno));
+        if (master >= 0) close(master);
+        return;
+    }
+    const char* slave = ptsname(master);
+    std::string slave_name = slave ? slave : "";
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    pty_master_ = master;
+    pty_columns_ = pty_rows_ = 0;
+    sync_pty_size();
+
+    // The profile's shell may carry arguments (e.g. "bash --login")
+    gchar** parsed = nullptr;
     GError* error = nullptr;
-    vte_terminal_spawn_sync(
-        vte_widget_,
-        VTE_PTY_DEFAULT,
-        home,
-        const_cast<char**>(argv),
-        const_cast<char**>(envp),
-        G_SPAWN_DEFAULT,
-        nullptr, nullptr,
-        nullptr,
-        nullptr,
-        &error
-    );
+    if (!g_shell_parse_argv(shell_path.c_str(), nullptr, &parsed, &error)) {
+        g_printerr("Invalid shell command '%s': %s\n", shell_path.c_str(), error->message);
+        g_error_free(error);
+        close_pty();
+        return;
+    }
+    std::vector<std::string> args(parsed, parsed + g_strv_length(parsed));
+    g_strfreev(parsed);
+
+    // What vte_terminal_spawn_* would have set; VTE_VERSION enables vte.sh (OSC 7)
+    gchar** envp = g_get_environ();
+    envp = g_environ_setenv(envp, "TERM", "xterm-256color", TRUE);
+    envp = g_environ_setenv(envp, "COLORTERM", "truecolor", TRUE);
+    const std::string vte_version = std::to_string(vte_get_major_version() * 10000 +
+                                                   vte_get_minor_version() * 100 + vte_get_micro_version());
+    envp = g_environ_setenv(envp, "VTE_VERSION", vte_version.c_str(), TRUE);
+
+    static ShellIntegration shell_integration;
+    ShellIntegration::Environment integration_env;
+    shell_integration.apply(args, integration_env);
+    for (const auto& [name, value] : integration_env) {
+        envp = g_environ_setenv(envp, name.c_str(), value.c_str(), TRUE);
+    }
+
+    std::vector<gchar*> argv;
+    for (auto& arg : args) {
+        argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+
+    g_spawn_async(home, argv.data(), envp,
+                  static_cast<GSpawnFlags>(G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD),
+                  attach_child_to_pty, const_cast<char*>(slave_name.c_str()),
+                  &child_pid_, &error);
+    g_strfreev(envp);
     
     if (error) {
         g_printerr("Failed to spawn shell: %s\n", error->message);
         g_error_free(error);
+        close_pty();
+        return;
+    }
+
+    pty_read_source_ = g_unix_fd_add(pty_master_, static_cast<GIOCondition>(G_IO_IN | G_IO_HUP | G_IO_ERR),
+                                     on_pty_readable_static, this);
+    child_watch_source_ = g_child_watch_add(child_pid_, on_child_watch_static, this);
+}
+
+gboolean TerminalWidget::on_pty_readable_static(gint fd, GIOCondition condition, gpointer user_data) {
+    auto* self = static_cast<TerminalWidget*>(user_data);
+    char buffer[64 * 1024];
+    size_t total = 0;
+    while (total < kMaxReadPerDispatch) {
+        const ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            vte_terminal_feed(self->vte_widget_, buffer, n);
+            const bool flooding = self->flood_.record(static_cast<size_t>(n));
+            if (!flooding && self->elided_lines_ > 0) {
+                self->end_flood(); // marker goes before the lines that follow it
+            }
+            self->clean_chunk_.clear();
+            self->stripper_.feed(buffer, static_cast<size_t>(n), self->clean_chunk_);
+            self->store_output(flooding);
+            self->record_row_anchor();
+            total += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return G_SOURCE_CONTINUE;
+        // EOF or EIO: the last process holding the slave is gone
+        self->pty_read_source_ = 0;
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+void TerminalWidget::store_output(bool flooding) {
+    if (!flooding) {
+        log_lines(clean_chunk_);
+        return;
+    }
+    // Only count: keeps the log (and anything reading it) out of the way
+    const auto lines = static_cast<std::uint64_t>(std::count(clean_chunk_.begin(), clean_chunk_.end(), '\n'));
+    elided_lines_ += lines;
+    line_shift_ += static_cast<std::int64_t>(lines);
+    if (!flood_check_source_) {
+        // Output may simply stop: notice the end of the flood without it
+        flood_check_source_ = g_timeout_add(kFloodCheckIntervalMs, on_flood_check_static, this);
+    }
+}
+
+void TerminalWidget::end_flood() {
+    if (flood_check_source_) {
+        g_source_remove(flood_check_source_);
+        flood_check_source_ = 0;
+    }
+    if (elided_lines_ > 0) {
+        log_lines("[… " + std::to_string(elided_lines_) + " lines elided …]\n");
+        line_shift_ -= 1;
+        elided_lines_ = 0;
+    }
+}
+
+void TerminalWidget::log_lines(std::string_view lines) {
+    if (lines.empty()) {
+        return;
+    }
+    const std::uint64_t first_line = output_.total_lines();
+    output_.append(lines);
+    ScrollbackIndexer::shared().submit(index_, std::string(lines), first_line);
+}
+
+void TerminalWidget::record_row_anchor() {
+    // Mid-flood or on the alternate screen the cursor doesn't follow the log
+    if (flood_.flooding() || in_full_screen_app()) {
+        return;
+    }
+    const std::uint64_t line = current_line();
+    if (!row_anchors_.empty() && row_anchors_.back().first >= line) {
+        return; // the row where the line started is the better anchor
+    }
+    glong column = 0, row = 0;
+    vte_terminal_get_cursor_position(vte_widget_, &column, &row);
+    row_anchors_.emplace_back(line, row);
+
+    // Anchors for rows VTE has dropped map nothing any more
+    GtkAdjustment* adjustment = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(vte_widget_));
+    const glong lower = adjustment ? static_cast<glong>(gtk_adjustment_get_lower(adjustment)) : 0;
+    while (row_anchors_.size() > 1 && row_anchors_[1].second <= lower) {
+        row_anchors_.pop_front();
+    }
+}
+
+gboolean TerminalWidget::on_flood_check_static(gpointer user_data) {
+    auto* self = static_cast<TerminalWidget*>(user_data);
+    if (self->flood_.update()) {
+        return G_SOURCE_CONTINUE;
+    }
+    self->flood_check_source_ = 0;
+    self->end_flood();
+    return G_SOURCE_REMOVE;
+}
+
+std::uint64_t TerminalWidget::current_line() const {
+    // Mid-flood nothing is logged, so marks land at the end of the log
+    if (flood_.flooding()) {
+        return output_.total_lines();
+    }
+    return static_cast<std::uint64_t>(static_cast<std::int64_t>(stripper_.lines_committed()) - line_shift_);
+}
+
+void TerminalWidget::on_commit_static(VteTerminal* terminal, gchar* text, guint size, gpointer user_data) {
+    auto* self = static_cast<TerminalWidget*>(user_data);
+    self->write_to_pty(text, size);
+}
+
+void TerminalWidget::write_to_pty(const char* data, size_t length) {
+    if (pty_master_ < 0) {
+        return;
+    }
+    pending_input_.append(data, length);
+    flush_pending_input();
+}
+
+void TerminalWidget::flush_pending_input() {
+    while (!pending_input_.empty()) {
+        const ssize_t n = write(pty_master_, pending_input_.data(), pending_input_.size());
+        if (n > 0) {
+            pending_input_.erase(0, static_cast<size_t>(n));
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // The shell isn't reading (e.g. a big paste): retry when it drains
+            if (!pty_write_source_) {
+                pty_write_source_ = g_unix_fd_add(pty_master_, G_IO_OUT, on_pty_writable_static, this);
+            }
+            return;
+        } else {
+            pending_input_.clear();
+            return;
+        }
+    }
+}
+
+gboolean TerminalWidget::on_pty_writable_static(gint, GIOCondition, gpointer user_data) {
+    auto* self = static_cast<TerminalWidget*>(user_data);
+    self->pty_write_source_ = 0;
+    self->flush_pending_input();
+    return G_SOURCE_REMOVE;
+}
+
+void TerminalWidget::on_size_allocate_static(GtkWidget*, GdkRectangle*, gpointer user_data) {
+    static_cast<TerminalWidget*>(user_data)->sync_pty_size();
+}
+
+void TerminalWidget::sync_pty_size() {
+    if (pty_master_ < 0) {
+        return;
+    }
+    const glong columns = vte_terminal_get_column_count(vte_widget_);
+    const glong rows = vte_terminal_get_row_count(vte_widget_);
+    if (columns == pty_columns_ && rows == pty_rows_) {
+        return;
+    }
+    pty_columns_ = columns;
+    pty_rows_ = rows;
+    struct winsize size = {};
+    size.ws_col = static_cast<unsigned short>(columns);
+    size.ws_row = static_cast<unsigned short>(rows);
+    ioctl(pty_master_, TIOCSWINSZ, &size); // the kernel signals SIGWINCH
+}
+
+void TerminalWidget::set_process_exit_callback(ProcessExitCallback callback) {
+    process_exit_callback_ = std::move(callback);
+}
+
+void TerminalWidget::on_child_watch_static(GPid pid, gint status, gpointer user_data) {
+    auto* self = static_cast<TerminalWidget*>(user_data);
+    g_spawn_close_pid(pid);
+    self->child_watch_source_ = 0;
+    if (self->process_exit_callback_) {
+        self->process_exit_callback_(status);
     }
 }
 
 std::string TerminalWidget::get_current_line() {
-    // Read from log file
-    std::string log_content = read_log_tail(500);
-    if (log_content.empty()) {
-        return "";
+    if (!stripper_.pending_line().empty()) {
+        return stripper_.pending_line();
     }
-    
-    // Strip ANSI codes
-    std::string clean = strip_ansi_codes(log_content);
-    
-    // Get last line
-    auto lines = std::vector<std::string>();
-    std::istringstream stream(clean);
-    std::string line;
-    while (std::getline(stream, line)) {
+    // Last non-empty line, looking back a bounded number of lines
+    const size_t count = output_.line_count();
+    for (size_t i = count; i > 0 && i + 50 > count; --i) {
+        std::string_view line = output_.line(i - 1);
         if (!line.empty()) {
-            lines.push_back(line);
+            return std::string(line);
         }
     }
-    
-    return lines.empty() ? "" : lines.back();
+    return "";
 }
 
 std::string TerminalWidget::get_context(int num_lines) {
-    std::string log_content = read_log_tail(2000);
-    if (log_content.empty()) {
+    if (num_lines <= 0) {
         return "";
     }
-    
-    std::string clean = strip_ansi_codes(log_content);
-    
-    // Get last N lines
-    auto lines = std::vector<std::string>();
-    std::istringstream stream(clean);
-    std::string line;
-    while (std::getline(stream, line)) {
-        lines.push_back(line);
+    if (in_full_screen_app()) {
+        // Redraws aren't logged; the screen itself is the context
+        return get_screen_text();
     }
-    
-    // Take last num_lines
-    int start = std::max(0, static_cast<int>(lines.size()) - num_lines);
-    std::ostringstream result;
-    for (int i = start; i < static_cast<int>(lines.size()); ++i) {
-        result << lines[i] << "\n";
+    // The line being written counts as the last one
+    const std::string& pending = stripper_.pending_line();
+    const size_t completed = pending.empty() ? num_lines : num_lines - 1;
+    std::string_view lines = get_recent_lines(completed);
+
+    std::string result;
+    result.reserve(lines.size() + pending.size() + 1);
+    result.append(lines.data(), lines.size());
+    if (elided_lines_ > 0) {
+        result += "[… " + std::to_string(elided_lines_) + " lines elided so far …]\n";
     }
-    
-    return result.str();
+    if (!pending.empty()) {
+        result += pending;
+        result += '\n';
+    }
+    return result;
+}
+
+std::string_view TerminalWidget::get_recent_lines(size_t num_lines) const {
+    return output_.last_lines(num_lines);
+}
+
+std::string TerminalWidget::get_screen_text(long scrollback_rows) {
+    scrollback_rows = std::max(0L, scrollback_rows);
+    GtkAdjustment* adjustment = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(vte_widget_));
+    const glong top = adjustment ? static_cast<glong>(gtk_adjustment_get_value(adjustment)) : 0;
+    const glong lower = adjustment ? static_cast<glong>(gtk_adjustment_get_lower(adjustment)) : 0;
+
+    const auto now = std::chrono::steady_clock::now();
+    const bool unchanged = top == screen_top_row_ && scrollback_rows == screen_scrollback_rows_;
+    if (unchanged && (!screen_dirty_ || now - screen_captured_ < kScreenRefreshInterval)) {
+        return screen_text_;
+    }
+
+    const glong rows = vte_terminal_get_row_count(vte_widget_);
+    const glong first = std::max(lower, top - scrollback_rows);
+    char* text = text_of_rows(vte_widget_, first, top + rows - 1);
+
+    // Rows come padded to the terminal width and the screen's bottom is
+    // usually blank: keep only the text
+    screen_text_.clear();
+    size_t pending_blank = 0;
+    for (const char* row = text ? text : ""; *row;) {
+        const char* end = std::strchr(row, '\n');
+        size_t length = end ? static_cast<size_t>(end - row) : std::strlen(row);
+        const char* next = end ? end + 1 : row + length;
+        while (length > 0 && row[length - 1] == ' ') --length;
+        if (length == 0) {
+            ++pending_blank;
+        } else {
+            screen_text_.append(pending_blank, '\n');
+            pending_blank = 0;
+            screen_text_.append(row, length);
+            screen_text_ += '\n';
+        }
+        row = next;
+    }
+    g_free(text);
+
+    screen_dirty_ = false;
+    screen_top_row_ = top;
+    screen_scrollback_rows_ = scrollback_rows;
+    screen_captured_ = now;
+    return screen_text_;
+}
+
+std::string_view TerminalWidget::get_command_output(const CommandRecord& record, size_t max_lines) const {
+    const std::uint64_t end = record.finished ? record.output_end : output_.total_lines();
+    const std::uint64_t begin = std::max(record.output_begin, end - std::min<std::uint64_t>(end, max_lines));
+    return output_.span(begin, end);
+}
+
+std::uint64_t TerminalWidget::history_begin() const {
+    return archive_.empty() ? output_.total_lines() - output_.line_count() : archive_.first_line();
+}
+
+std::vector<SearchChunk> TerminalWidget::search_chunks(const std::vector<std::string>& literals,
+                                                       size_t source) const {
+    std::vector<SearchChunk> chunks;
+    const std::uint64_t in_memory = output_.total_lines() - output_.line_count();
+    const std::uint64_t sealed = std::min(archive_.sealed_end(), in_memory);
+    const auto ranges = index_->candidates(literals);
+    for (auto range = ranges.rbegin(); range != ranges.rend(); ++range) {
+        const std::uint64_t begin = std::max(range->begin, history_begin());
+        const std::uint64_t end = std::min(range->end, history_end());
+        if (begin >= end) {
+            continue;
+        }
+        // Copied now: output_ and the archive's open block change under us
+        if (end > in_memory) {
+            const std::uint64_t from = std::max(begin, in_memory);
+            chunks.push_back({source, from, from, end,
+                              std::make_shared<const std::string>(output_.span(from, end)), std::nullopt});
+        }
+        if (std::min(end, in_memory) > std::max(begin, sealed)) {
+            const std::uint64_t from = std::max(begin, sealed);
+            const std::uint64_t to = std::min(end, in_memory);
+            chunks.push_back({source, from, from, to,
+                              std::make_shared<const std::string>(archive_.read(from, to)), std::nullopt});
+        }
+        // Sealed blocks are only referenced; a pool thread inflates them
+        const std::uint64_t sealed_to = std::min(end, sealed);
+        if (begin >= sealed_to) {
+            continue;
+        }
+        auto refs = archive_.block_refs(begin, sealed_to);
+        for (auto ref = refs.rbegin(); ref != refs.rend(); ++ref) {
+            const std::uint64_t from = std::max(begin, ref->first_line);
+            const std::uint64_t to = std::min(sealed_to, ref->first_line + ref->line_count);
+            if (!chunks.empty() && chunks.back().block && chunks.back().block->first_line == ref->first_line) {
+                chunks.back().begin = from; // another candidate range of the same block
+            } else {
+                chunks.push_back({source, ref->first_line, from, to, nullptr, std::move(*ref)});
+            }
+        }
+    }
+    return chunks;
+}
+
+ScrollbackSearch::LineMatcher TerminalWidget::make_matcher(const std::string& pattern, bool case_sensitive,
+                                                           bool regex) {
+    const bool ascii = std::all_of(pattern.begin(), pattern.end(),
+                                   [](char c) { return static_cast<unsigned char>(c) < 0x80; });
+    if (!regex && (case_sensitive || ascii)) {
+        return ScrollbackSearch::substring_matcher(pattern, case_sensitive);
+    }
+    GRegex* compiled = compile_search_regex(pattern, case_sensitive, regex);
+    if (!compiled) {
+        return nullptr;
+    }
+    // GRegex matching is thread-safe; only the GMatchInfo is per call
+    std::shared_ptr<GRegex> shared(compiled, g_regex_unref);
+    return [shared](std::string_view line) {
+        gchar* repaired = nullptr;
+        if (!g_utf8_validate(line.data(), static_cast<gssize>(line.size()), nullptr)) {
+            repaired = g_utf8_make_valid(line.data(), static_cast<gssize>(line.size()));
+            line = repaired;
+        }
+        const bool matched = g_regex_match_full(shared.get(), line.data(), static_cast<gssize>(line.size()),
+                                                0, static_cast<GRegexMatchFlags>(0), nullptr, nullptr);
+        g_free(repaired);
+        return matched;
+    };
 }
 
 void TerminalWidget::feed_text(const std::string& text) {
-    vte_terminal_feed_child(vte_widget_, text.c_str(), text.length());
+    write_to_pty(text.data(), text.length());
 }
 
 void TerminalWidget::clear_line() {
     // Send Ctrl+U to clear line
     const char ctrl_u = 0x15;
-    vte_terminal_feed_child(vte_widget_, &ctrl_u, 1);
+    write_to_pty(&ctrl_u, 1);
 }
 
 void TerminalWidget::set_key_press_callback(KeyPressCallback callback) {
@@ -154,36 +619,69 @@ gboolean TerminalWidget::on_key_press_static(GtkWidget* widget, GdkEventKey* eve
     return FALSE; // Propagate event
 }
 
-std::string TerminalWidget::read_log_tail(size_t bytes) {
-    if (session_log_path_.empty()) {
-        return "";
+void TerminalWidget::on_contents_changed_static(VteTerminal* terminal, gpointer user_data) {
+    auto* self = static_cast<TerminalWidget*>(user_data);
+    self->last_output_ = std::chrono::steady_clock::now();
+    self->screen_dirty_ = true;
+}
+
+void TerminalWidget::set_directory_changed_callback(DirectoryChangedCallback callback) {
+    directory_changed_callback_ = std::move(callback);
+}
+
+void TerminalWidget::on_directory_changed_static(VteTerminal* terminal, gpointer user_data) {
+    auto* self = static_cast<TerminalWidget*>(user_data);
+    if (self && self->directory_changed_callback_) {
+        std::string path = self->get_current_directory();
+        if (!path.empty()) {
+            self->directory_changed_callback_(path);
+        }
     }
-    
-    std::ifstream file(session_log_path_, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        return "";
+}
+
+size_t TerminalWidget::estimated_scrollback_bytes() const {
+    glong column = 0, row = 0;
+    vte_terminal_get_cursor_position(vte_widget_, &column, &row);
+    const glong rows = std::min<glong>(row + 1, scrollback_limit_ + vte_terminal_get_row_count(vte_widget_));
+    return static_cast<size_t>(std::max<glong>(rows, 0)) *
+           static_cast<size_t>(vte_terminal_get_column_count(vte_widget_)) * kScrollbackBytesPerCell;
+}
+
+size_t TerminalWidget::configured_scrollback_bytes() const {
+    const glong rows = std::max<glong>(scrollback_lines_, 0) + vte_terminal_get_row_count(vte_widget_);
+    return static_cast<size_t>(rows) *
+           static_cast<size_t>(vte_terminal_get_column_count(vte_widget_)) * kScrollbackBytesPerCell;
+}
+
+size_t TerminalWidget::trim_scrollback(size_t target_bytes) {
+    constexpr long kMinScrollback = 200;
+    const size_t before = estimated_scrollback_bytes();
+    if (before <= target_bytes) {
+        return 0;
     }
-    
-    std::streamsize size = file.tellg();
-    if (size == 0) {
-        return "";
+
+    const size_t bytes_per_line =
+        std::max<size_t>(1, static_cast<size_t>(vte_terminal_get_column_count(vte_widget_)) * kScrollbackBytesPerCell);
+    const long lines = std::max<long>(kMinScrollback, static_cast<long>(target_bytes / bytes_per_line));
+    if (lines >= scrollback_limit_) {
+        return 0;
+    }
+
+    scrollback_limit_ = lines;
+    vte_terminal_set_scrollback_lines(vte_widget_, scrollback_limit_);
+    const size_t after = estimated_scrollback_bytes();
+    return before > after ? before - after : 0;
+}
+
+void TerminalWidget::restore_scrollback() {
+    if (scrollback_limit_ != scrollback_lines_) {
+        scrollback_limit_ = scrollback_lines_;
+        vte_terminal_set_scrollback_lines(vte_widget_, scrollback_limit_);
     }
-    
-    // Seek to tail
-    std::streamsize offset = std::max<std::streamsize>(0, size - bytes);
-    file.seekg(offset);
-    
-    std::string content;
-    content.resize(size - offset);
-    file.read(&content[0], size - offset);
-    
-    return content;
 }
 
-std::string TerminalWidget::strip_ansi_codes(const std::string& text) {
-    // Regex to match ANSI escape sequences
-    static const std::regex ansi_regex(R"(\x1B(?:[@-Z\\-_]|\[[0-?]*[ -/]*[@-~]))");
-    return std::regex_replace(text, ansi_regex, "");
+bool TerminalWidget::is_idle(std::chrono::seconds threshold) const {
+    return std::chrono::steady_clock::now() - last_output_ >= threshold;
 }
 
 std::string TerminalWidget::get_current_directory() {
@@ -203,39 +701,67 @@ bool TerminalWidget::search_text(const std::string& pattern, bool case_sensitive
         clear_search();
         return false;
     }
-    
+
+    // VTE only takes regexes: plain text is escaped
+    gchar* escaped = regex ? nullptr : g_regex_escape_string(pattern.c_str(), -1);
+    const char* source = regex ? pattern.c_str() : escaped;
+    const guint32 flags = kPcre2Multiline | (case_sensitive ? 0 : kPcre2Caseless);
     GError* error = nullptr;
-    VteRegex* vte_regex = nullptr;
-    
-    if (regex) {
-        // Create regex for search
-        // Use 0 for default flags, add CASELESS if needed
-        guint32 flags = 0;
-        if (!case_sensitive) {
-            flags = 1; // PCRE2_CASELESS equivalent
-        }
-        
-        vte_regex = vte_regex_new_for_search(pattern.c_str(), pattern.length(), flags, &error);
-        
-        if (error) {
-            g_printerr("Search regex error: %s\n", error->message);
-            g_error_free(error);
-            return false;
-        }
+    VteRegex* vte_regex = vte_regex_new_for_search(source, -1, flags, &error);
+    g_free(escaped);
+    if (error) {
+        g_printerr("Search regex error: %s\n", error->message);
+        g_error_free(error);
+        return false;
     }
-    
-    // Set search parameters
+
     vte_terminal_search_set_regex(vte_widget_, vte_regex, 0);
     vte_terminal_search_set_wrap_around(vte_widget_, TRUE);
-    
-    if (vte_regex) {
-        vte_regex_unref(vte_regex);
-    }
-    
-    // Perform first search
+    vte_regex_unref(vte_regex);
+
     return vte_terminal_search_find_next(vte_widget_);
 }
 
+bool TerminalWidget::scroll_to_history_line(std::uint64_t line, std::string_view text) {
+    // Rows checked on either side of the estimate, for lines that wrapped
+    constexpr glong kRowSearchRadius = 256;
+
+    GtkAdjustment* adjustment = gtk_scrollable_get_vadjustment(GTK_SCROLLABLE(vte_widget_));
+    if (!adjustment || in_full_screen_app() || line >= current_line()) {
+        return false;
+    }
+    glong column = 0, cursor_row = 0;
+    vte_terminal_get_cursor_position(vte_widget_, &column, &cursor_row);
+
+    // The closest anchor at or after the line has the fewest rows between
+    std::pair<std::uint64_t, glong> anchor{current_line(), cursor_row};
+    auto it = std::lower_bound(row_anchors_.begin(), row_anchors_.end(), line,
+                               [](const auto& a, std::uint64_t l) { return a.first < l; });
+    if (it != row_anchors_.end()) {
+        anchor = *it;
+    }
+    const glong expected = anchor.second - static_cast<glong>(anchor.first - line);
+    const glong lower = static_cast<glong>(gtk_adjustment_get_lower(adjustment));
+
+    // Lines that wrapped in between put the row above the estimate
+    for (glong offset = 0; offset <= kRowSearchRadius; ++offset) {
+        for (const glong row : {expected - offset, expected + offset}) {
+            if (row >= lower && row <= cursor_row) {
+                char* shown = text_of_rows(vte_widget_, row, row);
+                const bool found = shown && row_shows_line(shown, text);
+                g_free(shown);
+                if (found) {
+                    const glong rows = vte_terminal_get_row_count(vte_widget_);
+                    gtk_adjustment_set_value(adjustment, static_cast<gdouble>(std::max(lower, row - rows / 2)));
+                    return true;
+                }
+            }
+            if (offset == 0) break;
+        }
+    }
+    return false;
+}
+
 bool TerminalWidget::search_next() {
     return vte_terminal_search_find_next(vte_widget_);
 }
@@ -276,7 +802,9 @@ void TerminalWidget::apply_profile(const domain::TerminalProfile& profile) {
         profile.cursor_blink ? VTE_CURSOR_BLINK_ON : VTE_CURSOR_BLINK_OFF);
         
     // Scrollback
-    vte_terminal_set_scrollback_lines(vte_widget_, profile.scrollback_lines);
+    scrollback_lines_ = profile.scrollback_lines;
+    scrollback_limit_ = scrollback_lines_;
+    vte_terminal_set_scrollback_lines(vte_widget_, scrollback_limit_);
     
     // Shell command update is slightly harder as it's spawn-time usually, 
     // but maybe we store it for next spawn.
@@ -4,14 +4,42 @@
 #include <gtk/gtk.h>
 #include <vte/vte.h>
 #include <string>
+#include <string_view>
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "domain/models/terminal_profile.hpp"
+#include "infrastructure/terminal/ansi_stripper.hpp"
+#include "infrastructure/terminal/command_tracker.hpp"
+#include "infrastructure/terminal/flood_detector.hpp"
+#include "infrastructure/terminal/line_buffer.hpp"
+#include "infrastructure/terminal/scrollback_archive.hpp"
+#include "infrastructure/terminal/scrollback_search.hpp"
+#include "infrastructure/terminal/trigram_index.hpp"
 
 namespace colabb {
 namespace infrastructure {
 
+/**
+ * @brief VTE widget plus the PTY of the shell it runs.
+ *
+ * The PTY master is owned here rather than by VTE: output is read on the
+ * GTK main loop and fed to VTE for display; an AnsiStripper turns the same
+ * bytes into plain lines, kept in a line-indexed in-memory buffer that
+ * get_context()/get_current_line() read; lines it drops move on to a
+ * compressed ScrollbackArchive, so the whole session stays searchable at a
+ * fixed memory cost; a TrigramIndex over the same lines, maintained by the
+ * shared ScrollbackIndexer thread, narrows searches. Keystrokes and VTE's
+ * replies arrive through the "commit" signal and are written back.
+ * Supported shells are started with ShellIntegration hooks, whose OSC 133
+ * marks feed a CommandTracker over the same line numbers. While the shell
+ * floods the tab (cat of a big file, chatty build) lines are only counted,
+ * then logged as a single "N lines elided" marker once the rate drops.
+ */
 class TerminalWidget {
 public:
     TerminalWidget();
@@ -24,6 +52,41 @@ public:
     void spawn_shell(const std::string& shell_path);
     std::string get_current_line();
     std::string get_context(int num_lines = 20);
+    // Last completed output lines without copying; valid until more output
+    // is read on the GTK main loop
+    std::string_view get_recent_lines(size_t num_lines) const;
+
+    // What the user sees: the visible rows plus up to scrollback_rows above
+    // them, read from VTE's grid. Re-read only after contents-changed (or a
+    // scroll) and at most every kScreenRefreshInterval; otherwise the
+    // previous snapshot is returned.
+    std::string get_screen_text(long scrollback_rows = 0);
+    // A full-screen program (vim, htop, less) is on the alternate screen;
+    // get_context() then returns get_screen_text() instead of the output log
+    bool in_full_screen_app() const { return stripper_.alternate_screen(); }
+    // Output is arriving faster than the flood threshold: context is frozen
+    // and predictions should wait
+    bool is_flooding() const { return flood_.flooding(); }
+
+    // Commands seen through shell integration (empty if it isn't loaded)
+    const CommandTracker& commands() const { return commands_; }
+    // Output of a record from commands(), limited to its last max_lines
+    // retained lines; zero-copy, same lifetime as get_recent_lines()
+    std::string_view get_command_output(const CommandRecord& record, size_t max_lines) const;
+
+    // Captured history by absolute line number (as in CommandRecord), from
+    // the compressed archive through the in-memory lines
+    std::uint64_t history_begin() const;
+    std::uint64_t history_end() const { return output_.total_lines(); }
+
+    // The whole history split into ScrollbackSearch work, newest first and
+    // narrowed to the index's candidates for literals (see
+    // TrigramIndex::required_literals); every chunk carries source
+    std::vector<SearchChunk> search_chunks(const std::vector<std::string>& literals, size_t source) const;
+    // Line matcher for ScrollbackSearch with search_text()'s semantics;
+    // empty if pattern isn't a valid regex
+    static ScrollbackSearch::LineMatcher make_matcher(const std::string& pattern, bool case_sensitive, bool regex);
+
     std::string get_current_directory();
     void feed_text(const std::string& text);
     void clear_line();
@@ -35,28 +98,95 @@ public:
     using ProcessExitCallback = std::function<void(int)>;
     void set_process_exit_callback(ProcessExitCallback callback);
 
+    // Fired when the shell reports a new working directory (OSC 7)
+    using DirectoryChangedCallback = std::function<void(const std::string&)>;
+    void set_directory_changed_callback(DirectoryChangedCallback callback);
+
     // Widget access
     GtkWidget* widget() const { return GTK_WIDGET(vte_widget_); }
     
-    // Search functionality
+    // Search functionality. Matches are counted off the GTK thread with
+    // search_chunks() and make_matcher(); see MainWindow.
     bool search_text(const std::string& pattern, bool case_sensitive, bool regex);
+    // Scrolls history line `line` (numbered as in search_chunks()) into
+    // view. text is the line as captured, to confirm the row. Returns false
+    // if VTE no longer holds the line (dropped from its scrollback, cleared,
+    // or on the alternate screen).
+    bool scroll_to_history_line(std::uint64_t line, std::string_view text);
     bool search_next();
     bool search_previous();
     void clear_search();
 
+    // Memory governance: VTE does not expose its buffer size, so usage is
+    // estimated from the rows actually written (capped by the scrollback
+    // limit) times the column count.
+    size_t estimated_scrollback_bytes() const;
+    // Estimate for a full scrollback at the profile's limit: what the tab
+    // may keep without being trimmed
+    size_t configured_scrollback_bytes() const;
+    // Lower the scrollback limit so the estimate fits target_bytes; VTE
+    // drops the oldest lines. Returns the estimated bytes released.
+    size_t trim_scrollback(size_t target_bytes);
+    // Re-apply the profile's scrollback limit after a trim
+    void restore_scrollback();
+    bool is_idle(std::chrono::seconds threshold) const;
+
 private:
     ::VteTerminal* vte_widget_;
-    std::string session_log_path_;
+    AnsiStripper stripper_;
+    LineBuffer output_; // completed plain-text lines
+    ScrollbackArchive archive_; // what output_ dropped
+    std::shared_ptr<TrigramIndex> index_; // over output_ and archive_
+    CommandTracker commands_;
+    FloodDetector flood_;
+    std::string clean_chunk_; // scratch for stripper_ output
+    int pty_master_;
+    GPid child_pid_;
+    guint pty_read_source_;
+    guint pty_write_source_;
+    guint child_watch_source_;
+    std::string pending_input_; // not yet accepted by the PTY
+    glong pty_columns_;
+    glong pty_rows_;
+    std::uint64_t elided_lines_; // counted but not logged in the current flood
+    std::int64_t line_shift_; // stripper_ line numbers minus output_ ones
+    // (log line being written, VTE cursor row) as of each PTY read, oldest
+    // first: maps logged lines back to rows, give or take wrapped lines
+    std::deque<std::pair<std::uint64_t, glong>> row_anchors_;
+    guint flood_check_source_;
+    std::string screen_text_; // last get_screen_text() snapshot
+    bool screen_dirty_;
+    long screen_scrollback_rows_;
+    glong screen_top_row_;
+    std::chrono::steady_clock::time_point screen_captured_;
     KeyPressCallback key_press_callback_;
     ProcessExitCallback process_exit_callback_;
+    DirectoryChangedCallback directory_changed_callback_;
+    long scrollback_lines_;
+    long scrollback_limit_;
+    std::chrono::steady_clock::time_point last_output_;
 
     // Static callback wrapper for GTK
     static gboolean on_key_press_static(GtkWidget* widget, GdkEventKey* event, gpointer user_data);
-    static void on_child_exited_static(VteTerminal* terminal, gint status, gpointer user_data);
+    static void on_contents_changed_static(VteTerminal* terminal, gpointer user_data);
+    static void on_directory_changed_static(VteTerminal* terminal, gpointer user_data);
+    static void on_commit_static(VteTerminal* terminal, gchar* text, guint size, gpointer user_data);
+    static void on_size_allocate_static(GtkWidget* widget, GdkRectangle* allocation, gpointer user_data);
+    static gboolean on_pty_readable_static(gint fd, GIOCondition condition, gpointer user_data);
+    static gboolean on_pty_writable_static(gint fd, GIOCondition condition, gpointer user_data);
+    static void on_child_watch_static(GPid pid, gint status, gpointer user_data);
+    static gboolean on_flood_check_static(gpointer user_data);
     
     // Helper methods
-    std::string read_log_tail(size_t bytes = 2000);
-    std::string strip_ansi_codes(const std::string& text);
+    void write_to_pty(const char* data, size_t length);
+    void flush_pending_input();
+    void sync_pty_size();
+    void close_pty();
+    void store_output(bool flooding);
+    void log_lines(std::string_view lines);
+    void end_flood();
+    void record_row_anchor();
+    std::uint64_t current_line() const;
 };
 
 } // namespace infrastructure
@@ -1,17 +1,51 @@
 #include "ui/main_window.hpp"
+#include "application/service_container.hpp"
 #include "colabb/version.hpp"
+#include "infrastructure/terminal/session_log_cleaner.hpp"
 #include <gtk/gtk.h>
+#include <cstdlib>
 #include <iostream>
 
+namespace {
+
+// One line per component, e.g. "Memory: released 512 KiB (context_cache=120 KiB, ...)"
+void log_memory_report(const colabb::infrastructure::MemoryGovernor& governor, size_t released) {
+    std::cerr << "Memory: released " << released / 1024 << " KiB (";
+    const auto usage = governor.report();
+    for (size_t i = 0; i < usage.size(); ++i) {
+        std::cerr << (i > 0 ? ", " : "") << usage[i].name << "=" << usage[i].bytes / 1024 << " KiB";
+    }
+    std::cerr << ")" << std::endl;
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
     // Initialize GTK
     gtk_init(&argc, &argv);
     
     std::cout << "Colabb Terminal v" << COLABB_VERSION << " (C++ Edition)" << std::endl;
+
+    // Logs of crashed or older instances (tab output now stays in memory)
+    colabb::infrastructure::SessionLogCleaner().remove_orphans();
     
+    // Services shared by every window (one prediction worker, cache, pool)
+    colabb::application::ServiceContainer services;
+
     // Create and show main window
-    colabb::ui::MainWindow window;
+    colabb::ui::MainWindow window(services);
     window.show();
+
+    // Keep caches and idle scrollback within the global memory budget.
+    // Trims are logged; COLABB_DEBUG_MEMORY logs every check.
+    g_timeout_add_seconds(15, [](gpointer user_data) -> gboolean {
+        auto* container = static_cast<colabb::application::ServiceContainer*>(user_data);
+        const size_t released = container->memory().enforce();
+        if (released > 0 || getenv("COLABB_DEBUG_MEMORY")) {
+            log_memory_report(container->memory(), released);
+        }
+        return G_SOURCE_CONTINUE;
+    }, &services);
     
     // Run GTK main loop
     gtk_main();
@@ -1,21 +1,50 @@
 #include "ui/main_window.hpp"
 #include "ui/config_dialog.hpp"
 #include "domain/ai/ai_provider.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <iostream>
 
 namespace colabb {
 namespace ui {
 
 namespace {
+// Retry delay for a query typed while the tab was flooding
+constexpr guint kFloodRetryMs = 500;
+
+// All-tabs search stops listing after this many lines
+constexpr size_t kMaxCrossTabHits = 500;
+// Past this many matching lines the current tab's count shows "N+"
+constexpr size_t kMaxCountedMatches = 10000;
+
 struct PredictionResultPayload {
+    std::weak_ptr<char> alive;
     MainWindow* window;
     std::uint64_t request_id;
-    std::string query;
+    std::string cache_key;
     std::optional<domain::Suggestion> suggestion;
+    application::PredictionService::Outcome outcome;
+};
+
+struct MatchCountPayload {
+    std::weak_ptr<char> alive;
+    MainWindow* window;
+    std::uint64_t search_id;
+    size_t matches;
+    bool finished;
+};
+
+struct CrossTabResultPayload {
+    std::weak_ptr<char> alive;
+    MainWindow* window;
+    std::uint64_t search_id;
+    std::vector<infrastructure::ScrollbackSearch::Hit> hits;
+    bool finished;
 };
 }
 
-MainWindow::MainWindow()
+MainWindow::MainWindow(application::ServiceContainer& services)
     : window_(nullptr)
     , header_bar_(nullptr)
     , vbox_(nullptr)
@@ -25,34 +54,48 @@ MainWindow::MainWindow()
     , suggestion_label_(nullptr)
     , apply_button_(nullptr)
     , icon_image_(nullptr)
+    , services_(services)
+    , settings_manager_(&services.settings())
+    , context_service_(&services.context())
+    , prediction_service_(&services.prediction())
+    , suggestion_cache_(&services.suggestion_cache())
+    , client_id_(services.register_client())
+    , scrollback_component_(0)
     , is_predicting_(false)
     , debounce_timer_id_(0)
     , latest_request_id_(0) {
     
-    settings_manager_ = std::make_unique<infrastructure::SettingsManager>();
-    context_service_ = std::make_unique<infrastructure::ContextService>();
-    
-    // Create AI provider based on config
-    auto ai_provider = create_ai_provider();
-    prediction_service_ = std::make_unique<application::PredictionService>(std::move(ai_provider));
-    
-    // Create suggestion cache
-    suggestion_cache_ = std::make_unique<application::SuggestionCache>();
-    
     // Create search bar
     search_bar_ = std::make_unique<SearchBar>(nullptr);
-    search_bar_->set_search_callback([this](const std::string& query, bool cs, bool regex) {
-        this->on_search_query(query, cs, regex);
+    search_bar_->set_search_callback([this](const std::string& query, bool cs, bool regex, bool all_tabs) {
+        this->on_search_query(query, cs, regex, all_tabs);
     });
     search_bar_->set_navigation_callback([this](bool next) {
         this->on_search_navigate(next);
     });
+    search_bar_->set_result_activated_callback([this](size_t row) {
+        this->on_cross_tab_result_activated(row);
+    });
     
     setup_ui();
+
+    // Idle tabs' scrollback is the first thing given back under pressure.
+    // The scrollback the profiles ask for is reserved on top of the budget,
+    // so it is only trimmed under system pressure, however many tabs are open.
+    scrollback_component_ = services_.memory().register_component(
+        "scrollback:window" + std::to_string(client_id_),
+        application::ServiceContainer::kIdleScrollbackPriority,
+        [this] { return scrollback_usage(); },
+        [this](size_t target) { return trim_idle_scrollback(target); },
+        [this] { return scrollback_reserve(); });
 }
 
 MainWindow::~MainWindow() {
-    // GTK widgets are automatically cleaned up
+    // GTK widgets are automatically cleaned up. The prediction worker is
+    // shared: drop this window's queued requests; results of one in flight
+    // find alive_ expired.
+    prediction_service_->cancel_pending(client_id_);
+    services_.memory().unregister_component(scrollback_component_);
 }
 
 void MainWindow::show() {
@@ -87,7 +130,7 @@ void MainWindow::setup_ui() {
     
     // Create TabManager
     tab_manager_ = std::make_unique<TabManager>(notebook_);
-    tab_manager_->set_settings_manager(settings_manager_.get());
+    tab_manager_->set_settings_manager(settings_manager_);
     tab_manager_->set_tab_created_callback([this](TabManager::TabInfo* tab) {
         this->on_tab_created(tab);
     });
@@ -404,8 +447,8 @@ bool MainWindow::on_key_press(GdkEventKey* event) {
     
     debounce_timer_id_ = g_timeout_add(delay, [](gpointer user_data) -> gboolean {
         auto* self = static_cast<MainWindow*>(user_data);
+        self->debounce_timer_id_ = 0; // process_input_buffer may schedule a retry
         self->process_input_buffer();
-        self->debounce_timer_id_ = 0;
         return G_SOURCE_REMOVE;
     }, this);
     
@@ -440,13 +483,32 @@ void MainWindow::process_input_buffer() {
     
     last_query_ = query;
     
-    // Check cache first
-    auto cached = suggestion_cache_->get(query);
+    // Check cache first. Stale entries are shown right away while a
+    // background request refreshes them.
+    auto cached = suggestion_cache_->lookup(query);
     if (cached) {
-        current_suggestion_ = cached;
+        current_suggestion_ = cached->suggestion;
         show_suggestion_overlay();
-        update_suggestion_ui("💡 " + cached->command + " (cached)", true);
+        update_suggestion_ui(format_suggestion(cached->suggestion.command) +
+                             (cached->stale ? " (cached, may be outdated)" : " (cached)"), true);
         gtk_image_set_from_icon_name(icon_image_, "emoji-objects-symbolic", GTK_ICON_SIZE_MENU);
+        if (cached->needs_revalidation) {
+            revalidate_suggestion(query);
+        }
+        return;
+    }
+
+    // Recently empty or failed: don't call the provider again until the
+    // negative entry expires
+    auto negative = suggestion_cache_->get_negative(query);
+    if (negative) {
+        current_suggestion_ = std::nullopt;
+        show_suggestion_overlay();
+        update_suggestion_ui(negative == application::SuggestionCache::NegativeKind::TransportFailure
+                                 ? "IA no disponible, reintenta en unos segundos"
+                                 : "Sin sugerencias",
+                             false);
+        gtk_image_set_from_icon_name(icon_image_, "dialog-warning-symbolic", GTK_ICON_SIZE_MENU);
         return;
     }
     
@@ -458,18 +520,105 @@ void MainWindow::process_input_buffer() {
         return;
     }
 
-    std::string term_context = terminal->get_context(20);
-    std::string cwd = terminal->get_current_directory();
-    std::string project_context = context_service_->get_context_prompt(cwd);
+    // Mid-flood the context is a blur and the UI thread is busy feeding VTE:
+    // retry the same query once the output calms down
+    if (terminal->is_flooding()) {
+        last_query_.clear();
+        show_suggestion_overlay();
+        update_suggestion_ui("Salida muy rápida, sugerencia en pausa...", false);
+        if (debounce_timer_id_ == 0) {
+            debounce_timer_id_ = g_timeout_add(kFloodRetryMs, [](gpointer user_data) -> gboolean {
+                auto* self = static_cast<MainWindow*>(user_data);
+                self->debounce_timer_id_ = 0;
+                self->process_input_buffer();
+                return G_SOURCE_REMOVE;
+            }, this);
+        }
+        return;
+    }
+
+    request_prediction(query, build_prediction_context(terminal, query));
+}
+
+application::PredictionService::ContextBuilder
+MainWindow::build_prediction_context(infrastructure::TerminalWidget* terminal, const std::string& query) {
+    // Snapshot what only the GTK thread may read; the providers run on the
+    // assembler's pool when the request reaches the prediction worker
+    domain::ContextRequest request;
+    request.query = query;
+    request.cwd = terminal->get_current_directory();
+    request.terminal_output = terminal->get_context(20);
+    if (const auto* last = terminal->commands().last_finished(); last && last->failed()) {
+        request.failed_command = last->command;
+        request.failed_output = std::string(terminal->get_command_output(*last, 40));
+        request.failed_exit_code = *last->exit_code;
+    }
+
+    auto* assembler = &services_.context_assembler();
+    return [assembler, request = std::move(request)] {
+        return assembler->assemble(request).context;
+    };
+}
+
+std::string MainWindow::format_suggestion(const std::string& command) {
+    std::string text = "💡 " + command;
+    auto* terminal = get_current_terminal();
+    if (!terminal) return text;
+
+    // Memory only: the listing was loaded when the shell entered the cwd
+    const auto unknown = services_.directories().unknown_references(terminal->get_current_directory(), command);
+    if (!unknown.empty()) {
+        text += "  ⚠ no encontrado: ";
+        for (size_t i = 0; i < unknown.size(); ++i) {
+            if (i > 0) text += ", ";
+            text += unknown[i];
+        }
+    }
+    return text;
+}
+
+void MainWindow::revalidate_suggestion(const std::string& query) {
+    auto* terminal = get_current_terminal();
+    if (!terminal) return;
 
-    std::string full_context = project_context + "\n\nRecent Terminal Output:\n" + term_context;
-    request_prediction(query, full_context);
+    prediction_service_->predict_async(query, build_prediction_context(terminal, query),
+        [this, alive = std::weak_ptr<char>(alive_), query](std::optional<domain::Suggestion> suggestion,
+                                                            application::PredictionService::Outcome) {
+            g_idle_add([](gpointer user_data) -> gboolean {
+                auto* payload = static_cast<PredictionResultPayload*>(user_data);
+                if (payload->alive.lock()) {
+                    payload->window->on_revalidation_result(payload->cache_key, payload->suggestion);
+                }
+                delete payload;
+                return G_SOURCE_REMOVE;
+            }, new PredictionResultPayload{alive, this, 0, query, suggestion,
+                                           application::PredictionService::Outcome::Suggested});
+        },
+        application::PredictionService::Priority::Background, client_id_);
+}
+
+void MainWindow::on_revalidation_result(const std::string& query,
+                                        std::optional<domain::Suggestion> suggestion) {
+    if (!suggestion) {
+        // Keep serving the stale entry, but let the next stale hit retry
+        suggestion_cache_->abandon_revalidation(query);
+        return;
+    }
+
+    suggestion_cache_->put(query, *suggestion);
+
+    // Swap in the fresh answer if the stale one is still on screen
+    if (!is_predicting_ && current_suggestion_ && query == last_query_) {
+        current_suggestion_ = suggestion;
+        update_suggestion_ui(format_suggestion(suggestion->command), true);
+    }
 }
 
 void MainWindow::request_prediction(const std::string& query,
-                                    const std::string& full_context,
-                                    const std::string& status_text) {
-    prediction_service_->cancel_pending();
+                                    application::PredictionService::ContextBuilder build_context,
+                                    const std::string& status_text,
+                                    bool cache_result) {
+    prediction_service_->cancel_pending(client_id_);
     is_predicting_ = true;
     show_suggestion_overlay();
     update_suggestion_ui(status_text, false);
@@ -478,22 +627,38 @@ void MainWindow::request_prediction(const std::string& query,
     gtk_widget_hide(GTK_WIDGET(icon_image_));
 
     const std::uint64_t request_id = ++latest_request_id_;
-    prediction_service_->predict_async(query, full_context,
-        [this, request_id, query](std::optional<domain::Suggestion> suggestion) {
+    const std::string cache_key = cache_result ? query : std::string();
+    prediction_service_->predict_async(query, std::move(build_context),
+        [this, alive = std::weak_ptr<char>(alive_), request_id, cache_key](
+            std::optional<domain::Suggestion> suggestion, application::PredictionService::Outcome outcome) {
             // This callback runs in worker thread, use g_idle_add for UI update
             g_idle_add([](gpointer user_data) -> gboolean {
                 auto* payload = static_cast<PredictionResultPayload*>(user_data);
-                payload->window->on_prediction_result(
-                    payload->request_id, payload->query, payload->suggestion);
+                if (payload->alive.lock()) {
+                    payload->window->on_prediction_result(
+                        payload->request_id, payload->cache_key, payload->suggestion, payload->outcome);
+                }
                 delete payload;
                 return G_SOURCE_REMOVE;
-            }, new PredictionResultPayload{this, request_id, query, suggestion});
-        });
+            }, new PredictionResultPayload{alive, this, request_id, cache_key, suggestion, outcome});
+        },
+        application::PredictionService::Priority::Interactive, client_id_);
 }
 
 void MainWindow::on_prediction_result(std::uint64_t request_id,
-                                      const std::string& query,
-                                      std::optional<domain::Suggestion> suggestion) {
+                                      const std::string& cache_key,
+                                      std::optional<domain::Suggestion> suggestion,
+                                      application::PredictionService::Outcome outcome) {
+    // Remember empty answers and provider failures even if the UI moved on,
+    // so retyping the query doesn't go back to the network
+    if (!cache_key.empty()) {
+        if (outcome == application::PredictionService::Outcome::Empty) {
+            suggestion_cache_->put_negative(cache_key, application::SuggestionCache::NegativeKind::EmptyAnswer);
+        } else if (outcome == application::PredictionService::Outcome::Failed) {
+            suggestion_cache_->put_negative(cache_key, application::SuggestionCache::NegativeKind::TransportFailure);
+        }
+    }
+
     if (request_id != latest_request_id_) {
         return;
     }
@@ -507,12 +672,12 @@ void MainWindow::on_prediction_result(std::uint64_t request_id,
         current_suggestion_ = suggestion;
         
         // Cache the suggestion
-        if (!query.empty()) {
-            suggestion_cache_->put(query, *suggestion);
+        if (!cache_key.empty()) {
+            suggestion_cache_->put(cache_key, *suggestion);
         }
         
         show_suggestion_overlay();
-        update_suggestion_ui("💡 " + suggestion->command, true);
+        update_suggestion_ui(format_suggestion(suggestion->command), true);
         gtk_image_set_from_icon_name(icon_image_, "emoji-objects-symbolic", GTK_ICON_SIZE_MENU);
     } else {
         current_suggestion_ = std::nullopt;
@@ -545,7 +710,7 @@ void MainWindow::on_apply_suggestion() {
     current_suggestion_ = std::nullopt;
     ++latest_request_id_;
     is_predicting_ = false;
-    prediction_service_->cancel_pending();
+    prediction_service_->cancel_pending(client_id_);
     hide_suggestion_overlay();
     
     // Focus terminal
@@ -553,12 +718,11 @@ void MainWindow::on_apply_suggestion() {
 }
 
 void MainWindow::on_config_clicked() {
-    ConfigDialog dialog(GTK_WINDOW(window_), settings_manager_.get());
+    ConfigDialog dialog(GTK_WINDOW(window_), settings_manager_);
     dialog.run();
     
-    // Recreate AI provider with new config
-    auto ai_provider = create_ai_provider();
-    prediction_service_ = std::make_unique<application::PredictionService>(std::move(ai_provider));
+    // Rebuild the shared AI provider with new config (applies to all windows)
+    services_.reload_ai_provider();
     ++latest_request_id_;
     is_predicting_ = false;
 }
@@ -569,7 +733,7 @@ void MainWindow::on_escape_pressed() {
     current_suggestion_ = std::nullopt;
     ++latest_request_id_;
     is_predicting_ = false;
-    prediction_service_->cancel_pending();
+    prediction_service_->cancel_pending(client_id_);
     hide_suggestion_overlay();
 }
 
@@ -578,27 +742,6 @@ void MainWindow::update_suggestion_ui(const std::string& text, bool enable_butto
     gtk_widget_set_sensitive(GTK_WIDGET(apply_button_), enable_button);
 }
 
-std::unique_ptr<domain::IAIProvider> MainWindow::create_ai_provider() {
-    std::string provider = settings_manager_->get_ai_provider();
-    std::string api_key = settings_manager_->get_api_key(provider);
-    
-    domain::GenericHttpAiProvider::Config config;
-    config.api_key = api_key;
-    
-    if (provider == "openai") {
-        config.endpoint_url = "https://api.openai.com/v1/chat/completions";
-        config.model = "gpt-3.5-turbo";
-        config.system_prompt = "You are a Linux terminal expert. Return ONLY the suggested bash command, without explanations or markdown formatting.";
-    } else {
-        // Default to Groq
-        config.endpoint_url = "https://api.groq.com/openai/v1/chat/completions";
-        config.model = "llama-3.1-8b-instant";
-        config.system_prompt = "Eres un experto en terminal Linux. Devuelve SOLO el comando bash sugerido, sin explicaciones ni formato markdown.";
-    }
-    
-    return std::make_unique<domain::GenericHttpAiProvider>(config);
-}
-
 // Static callbacks
 void MainWindow::on_config_clicked_static(GtkButton* button, gpointer user_data) {
     auto* self = static_cast<MainWindow*>(user_data);
@@ -636,7 +779,7 @@ void MainWindow::on_new_tab_static(GtkButton* button, gpointer user_data) {
 
 void MainWindow::on_new_window() {
     // Create a new instance of MainWindow
-    MainWindow* new_win = new MainWindow();
+    MainWindow* new_win = new MainWindow(services_);
     new_win->show();
 }
 
@@ -683,6 +826,7 @@ void MainWindow::toggle_search() {
     
     if (search_bar_->is_visible()) {
         search_bar_->hide();
+        cancel_history_searches();
         terminal->clear_search();
         gtk_widget_grab_focus(terminal->widget());
     } else {
@@ -690,16 +834,159 @@ void MainWindow::toggle_search() {
     }
 }
 
-void MainWindow::on_search_query(const std::string& query, bool case_sensitive, bool regex) {
+void MainWindow::on_search_query(const std::string& query, bool case_sensitive, bool regex, bool all_tabs) {
     auto* terminal = get_current_terminal();
     if (!terminal) return;
     
+    cancel_history_searches();
     if (query.empty()) {
         terminal->clear_search();
+        search_bar_->set_match_count(std::nullopt);
+        return;
+    }
+
+    if (all_tabs) {
+        terminal->clear_search();
+        start_cross_tab_search(query, case_sensitive, regex);
         return;
     }
     
+    // VTE highlights and scrolls at once; the count follows from the pool
     terminal->search_text(query, case_sensitive, regex);
+    start_match_count(*terminal, query, case_sensitive, regex);
+}
+
+void MainWindow::start_match_count(infrastructure::TerminalWidget& terminal, const std::string& query,
+                                   bool case_sensitive, bool regex) {
+    auto matcher = infrastructure::TerminalWidget::make_matcher(query, case_sensitive, regex);
+    if (!matcher) {
+        search_bar_->set_match_count(std::nullopt); // invalid regex
+        return;
+    }
+
+    const auto literals = infrastructure::TrigramIndex::required_literals(query, regex, case_sensitive);
+    match_count_ = 0;
+    search_bar_->set_match_count(0, true);
+    if (!history_search_) {
+        history_search_ = std::make_unique<infrastructure::ScrollbackSearch>();
+    }
+    // Set before start(): with no chunks the callback runs inside it
+    match_count_id_ = history_search_->start(terminal.search_chunks(literals, 0), std::move(matcher),
+                                             kMaxCountedMatches,
+        [this, alive = std::weak_ptr<char>(alive_)](std::uint64_t search_id,
+                                                    std::vector<infrastructure::ScrollbackSearch::Hit> hits,
+                                                    bool finished) {
+            g_idle_add([](gpointer user_data) -> gboolean {
+                auto* payload = static_cast<MatchCountPayload*>(user_data);
+                if (payload->alive.lock()) {
+                    payload->window->on_match_count(payload->search_id, payload->matches, payload->finished);
+                }
+                delete payload;
+                return G_SOURCE_REMOVE;
+            }, new MatchCountPayload{alive, this, search_id, hits.size(), finished});
+        });
+}
+
+void MainWindow::on_match_count(std::uint64_t search_id, size_t matches, bool finished) {
+    if (search_id != match_count_id_) {
+        return; // superseded while queued
+    }
+    match_count_ += matches;
+    search_bar_->set_match_count(match_count_, !finished || match_count_ >= kMaxCountedMatches);
+}
+
+void MainWindow::start_cross_tab_search(const std::string& query, bool case_sensitive, bool regex) {
+    auto matcher = infrastructure::TerminalWidget::make_matcher(query, case_sensitive, regex);
+    if (!matcher) {
+        search_bar_->set_match_count(std::nullopt); // invalid regex
+        return;
+    }
+
+    // Chunks are copied or referenced here, on the GTK thread; the pool
+    // never touches a terminal. Current tab first, each tab newest first.
+    const auto literals = infrastructure::TrigramIndex::required_literals(query, regex, case_sensitive);
+    std::vector<infrastructure::SearchChunk> chunks;
+    const int current = tab_manager_->get_current_tab_index();
+    const int count = tab_manager_->get_tab_count();
+    for (int n = 0; n < count; ++n) {
+        auto* tab = tab_manager_->get_tab(n == 0 ? current : (n <= current ? n - 1 : n));
+        if (!tab || !tab->terminal) continue;
+        auto tab_chunks = tab->terminal->search_chunks(literals, cross_tab_sources_.size());
+        std::move(tab_chunks.begin(), tab_chunks.end(), std::back_inserter(chunks));
+        cross_tab_sources_.push_back({tab->terminal.get(), tab->title});
+    }
+
+    search_bar_->set_match_count(0, true);
+
+    if (!history_search_) {
+        history_search_ = std::make_unique<infrastructure::ScrollbackSearch>();
+    }
+    // Set before start(): with no chunks the callback runs inside it
+    cross_tab_search_id_ = history_search_->start(std::move(chunks), std::move(matcher), kMaxCrossTabHits,
+        [this, alive = std::weak_ptr<char>(alive_)](std::uint64_t search_id,
+                                                    std::vector<infrastructure::ScrollbackSearch::Hit> hits,
+                                                    bool finished) {
+            // Pool thread: hand the batch to the GTK thread
+            g_idle_add([](gpointer user_data) -> gboolean {
+                auto* payload = static_cast<CrossTabResultPayload*>(user_data);
+                if (payload->alive.lock()) {
+                    payload->window->on_cross_tab_results(payload->search_id, std::move(payload->hits),
+                                                          payload->finished);
+                }
+                delete payload;
+                return G_SOURCE_REMOVE;
+            }, new CrossTabResultPayload{alive, this, search_id, std::move(hits), finished});
+        });
+}
+
+void MainWindow::cancel_history_searches() {
+    if (history_search_) {
+        history_search_->cancel();
+    }
+    // Batches already queued for the GTK thread are dropped
+    match_count_id_ = 0;
+    cross_tab_search_id_ = 0;
+    cross_tab_sources_.clear();
+    cross_tab_hits_.clear();
+    search_bar_->clear_results();
+}
+
+void MainWindow::on_cross_tab_results(std::uint64_t search_id,
+                                      std::vector<infrastructure::ScrollbackSearch::Hit> hits, bool finished) {
+    if (search_id != cross_tab_search_id_) {
+        return; // superseded while queued
+    }
+
+    std::vector<SearchBar::ResultRow> rows;
+    rows.reserve(hits.size());
+    for (auto& hit : hits) {
+        rows.push_back({cross_tab_sources_[hit.source].title + ":" + std::to_string(hit.line + 1), hit.text});
+        cross_tab_hits_.push_back(std::move(hit));
+    }
+    search_bar_->add_results(rows);
+    search_bar_->set_match_count(cross_tab_hits_.size(),
+                                 !finished || cross_tab_hits_.size() >= kMaxCrossTabHits);
+}
+
+void MainWindow::on_cross_tab_result_activated(size_t row) {
+    if (row >= cross_tab_hits_.size()) return;
+    const auto& hit = cross_tab_hits_[row];
+    const CrossTabSource& source = cross_tab_sources_[hit.source];
+
+    // The tab may have closed or moved since the search started
+    for (int i = 0; i < tab_manager_->get_tab_count(); ++i) {
+        auto* tab = tab_manager_->get_tab(i);
+        if (tab && tab->terminal.get() == source.terminal && tab->title == source.title) {
+            tab_manager_->switch_to_tab(i);
+            // Archived lines are only in our history, not in VTE's scrollback
+            if (!tab->terminal->scroll_to_history_line(hit.line, hit.text)) {
+                search_bar_->show_notice("La línea " + std::to_string(hit.line + 1) +
+                                         " ya no está en la terminal");
+            }
+            return;
+        }
+    }
+    search_bar_->show_notice("La pestaña se ha cerrado");
 }
 
 void MainWindow::on_search_navigate(bool next) {
@@ -731,6 +1018,12 @@ void MainWindow::on_tab_created(TabManager::TabInfo* tab) {
     tab->terminal->set_key_press_callback([this](GdkEventKey* event) {
         return this->on_key_press(event);
     });
+
+    // Detect project context off the GTK thread as soon as the shell cd's,
+    // so building a prompt only reads the cache
+    tab->terminal->set_directory_changed_callback([this](const std::string& cwd) {
+        context_service_->prefetch(cwd);
+    });
     
     // Focus the terminal
     gtk_widget_grab_focus(tab->terminal->widget());
@@ -741,6 +1034,42 @@ void MainWindow::on_tab_closed(int index) {
     std::cout << "Tab closed: " << index << std::endl;
 }
 
+size_t MainWindow::scrollback_usage() {
+    size_t total = 0;
+    for (int i = 0; i < tab_manager_->get_tab_count(); ++i) {
+        total += tab_manager_->get_tab(i)->terminal->estimated_scrollback_bytes();
+    }
+    return total;
+}
+
+size_t MainWindow::scrollback_reserve() {
+    size_t total = 0;
+    for (int i = 0; i < tab_manager_->get_tab_count(); ++i) {
+        total += tab_manager_->get_tab(i)->terminal->configured_scrollback_bytes();
+    }
+    return total;
+}
+
+size_t MainWindow::trim_idle_scrollback(size_t target_bytes) {
+    constexpr std::chrono::seconds kIdleAfter(60);
+    const int current = tab_manager_->get_current_tab_index();
+
+    size_t total = scrollback_usage();
+    size_t released = 0;
+    for (int i = 0; i < tab_manager_->get_tab_count() && total > target_bytes; ++i) {
+        auto* terminal = tab_manager_->get_tab(i)->terminal.get();
+        if (i == current || !terminal->is_idle(kIdleAfter)) {
+            continue;
+        }
+        const size_t usage = terminal->estimated_scrollback_bytes();
+        const size_t excess = total - target_bytes;
+        const size_t freed = terminal->trim_scrollback(usage > excess ? usage - excess : 0);
+        total -= std::min(freed, total);
+        released += freed;
+    }
+    return released;
+}
+
 infrastructure::TerminalWidget* MainWindow::get_current_terminal() {
     auto* tab = tab_manager_->get_current_tab();
     return tab ? tab->terminal.get() : nullptr;
@@ -752,7 +1081,7 @@ void MainWindow::on_profiles_clicked_static(GtkMenuItem* item, gpointer user_dat
 }
 
 void MainWindow::on_profiles_clicked() {
-    ProfileDialog dialog(GTK_WINDOW(window_), settings_manager_.get());
+    ProfileDialog dialog(GTK_WINDOW(window_), settings_manager_);
     dialog.run();
     
     // Apply changes (if any) to open tabs
@@ -768,20 +1097,33 @@ void MainWindow::on_explain_error() {
     auto* terminal = get_current_terminal();
     if (!terminal) return;
     
-    // Capture output
-    std::string output = terminal->get_context(40);
+    // Exactly the last failing command's output when shell integration
+    // reports commands; otherwise whatever is on screen
+    std::string output;
+    if (const auto* failed = terminal->commands().last_failed()) {
+        output = "$ " + failed->command + "\n" +
+                 std::string(terminal->get_command_output(*failed, 200)) +
+                 "(exit status " + std::to_string(*failed->exit_code) + ")\n";
+    } else {
+        output = terminal->get_context(40);
+    }
     std::string cwd = terminal->get_current_directory();
-    std::string project_context = context_service_->get_context_prompt(cwd);
+    auto project_context = context_service_->get_cached_context_prompt(cwd);
     
-    std::string prompt = project_context + 
+    std::string prompt = *project_context + 
         "\n\nAnalyze the following terminal output. Explain any errors found and suggest a fix:\n\n" + output;
         
-    request_prediction("Explain Error", prompt, "Analizando error...");
+    // The answer depends on the terminal output, not on the "query": never
+    // cache it, or the next explain would replay it
+    request_prediction("Explain Error", [prompt] { return prompt; }, "Analizando error...", false);
 }
 
 void MainWindow::on_tab_switched(GtkWidget* page, guint page_num) {
     auto* tab = tab_manager_->get_tab(page_num);
     if (!tab) return;
+
+    // A tab coming back into view gets its full scrollback limit again
+    tab->terminal->restore_scrollback();
     
     // Reparent suggestion revealer to new tab's overlay
     if (suggestion_revealer_) {
@@ -2,11 +2,13 @@
 #define COLABB_MAIN_WINDOW_HPP
 
 #include "infrastructure/terminal/vte_terminal.hpp"
+#include "infrastructure/terminal/scrollback_search.hpp"
 #include "infrastructure/config/settings_manager.hpp"
 #include "infrastructure/context/context_service.hpp"
 #include "infrastructure/i18n/translation_manager.hpp"
 #include "ui/profile_dialog.hpp"
 #include "application/prediction_service.hpp"
+#include "application/service_container.hpp"
 #include "application/suggestion_cache.hpp"
 #include "domain/models/suggestion.hpp"
 #include "ui/search_bar.hpp"
@@ -16,12 +18,13 @@
 #include <string>
 #include <optional>
 #include <cstdint>
+#include <vector>
 namespace colabb {
 namespace ui {
 
 class MainWindow {
 public:
-    MainWindow();
+    explicit MainWindow(application::ServiceContainer& services);
     ~MainWindow();
     
     void show();
@@ -41,11 +44,19 @@ private:
     
     // Components
     std::unique_ptr<TabManager> tab_manager_;
-    std::unique_ptr<infrastructure::SettingsManager> settings_manager_;
-    std::unique_ptr<infrastructure::ContextService> context_service_;
-    std::unique_ptr<application::PredictionService> prediction_service_;
-    std::unique_ptr<application::SuggestionCache> suggestion_cache_;
     std::unique_ptr<SearchBar> search_bar_;
+
+    // Shared services (owned by the ServiceContainer, not this window)
+    application::ServiceContainer& services_;
+    infrastructure::SettingsManager* settings_manager_;
+    infrastructure::ContextService* context_service_;
+    application::PredictionService* prediction_service_;
+    application::SuggestionCache* suggestion_cache_;
+    application::PredictionService::OwnerId client_id_;
+    // Expires with the window; results the prediction worker and the
+    // search pool queued on the GTK main loop check it before touching this
+    std::shared_ptr<char> alive_ = std::make_shared<char>();
+    infrastructure::MemoryGovernor::ComponentId scrollback_component_;
     
     // State
     std::string input_buffer_;
@@ -54,6 +65,20 @@ private:
     bool is_predicting_;
     guint debounce_timer_id_;
     std::uint64_t latest_request_id_;
+
+    // History searches, created on first use: the current tab's match count
+    // and the all-tabs search (one at a time). Sources are indexed like the
+    // tabs at the time the search started.
+    struct CrossTabSource {
+        infrastructure::TerminalWidget* terminal;
+        std::string title;
+    };
+    std::unique_ptr<infrastructure::ScrollbackSearch> history_search_;
+    std::uint64_t match_count_id_ = 0;
+    size_t match_count_ = 0;
+    std::uint64_t cross_tab_search_id_ = 0;
+    std::vector<CrossTabSource> cross_tab_sources_;
+    std::vector<infrastructure::ScrollbackSearch::Hit> cross_tab_hits_;
     
     // UI setup
     void setup_ui();
@@ -75,12 +100,23 @@ private:
     
     // Prediction handling
     void process_input_buffer();
+    // cache_key is empty for requests whose answers are not cached
     void on_prediction_result(std::uint64_t request_id,
-                              const std::string& query,
-                              std::optional<domain::Suggestion> suggestion);
+                              const std::string& cache_key,
+                              std::optional<domain::Suggestion> suggestion,
+                              application::PredictionService::Outcome outcome);
     void request_prediction(const std::string& query,
-                            const std::string& full_context,
-                            const std::string& status_text = "Consultando IA...");
+                            application::PredictionService::ContextBuilder build_context,
+                            const std::string& status_text = "Consultando IA...",
+                            bool cache_result = true);
+    void revalidate_suggestion(const std::string& query);
+    void on_revalidation_result(const std::string& query,
+                                std::optional<domain::Suggestion> suggestion);
+    // Deferred context: providers run when the request is dequeued
+    application::PredictionService::ContextBuilder
+    build_prediction_context(infrastructure::TerminalWidget* terminal, const std::string& query);
+    // "💡 command", flagged when it names files the cwd listing lacks
+    std::string format_suggestion(const std::string& command);
     
     // Static callbacks for GTK
     static void on_config_clicked_static(GtkButton* button, gpointer user_data);
@@ -108,15 +144,25 @@ private:
     void on_tab_created(TabManager::TabInfo* tab);
     void on_tab_closed(int index);
     void on_tab_switched(GtkWidget* page, guint page_num);
+    size_t scrollback_usage();
+    size_t scrollback_reserve();
+    size_t trim_idle_scrollback(size_t target_bytes);
     
     // Search handlers
     void toggle_search();
-    void on_search_query(const std::string& query, bool case_sensitive, bool regex);
+    void on_search_query(const std::string& query, bool case_sensitive, bool regex, bool all_tabs);
     void on_search_navigate(bool next);
+    void start_match_count(infrastructure::TerminalWidget& terminal, const std::string& query,
+                           bool case_sensitive, bool regex);
+    void on_match_count(std::uint64_t search_id, size_t matches, bool finished);
+    void start_cross_tab_search(const std::string& query, bool case_sensitive, bool regex);
+    void cancel_history_searches();
+    void on_cross_tab_results(std::uint64_t search_id,
+                              std::vector<infrastructure::ScrollbackSearch::Hit> hits, bool finished);
+    void on_cross_tab_result_activated(size_t row);
 
     // Helper methods
     void update_suggestion_ui(const std::string& text, bool enable_button);
-    std::unique_ptr<domain::IAIProvider> create_ai_provider();
     infrastructure::TerminalWidget* get_current_terminal();
 };
 
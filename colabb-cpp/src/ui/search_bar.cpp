@@ -6,9 +6,13 @@ namespace ui {
 SearchBar::SearchBar(GtkWidget* parent)
     : revealer_(nullptr)
     , search_box_(nullptr)
+    , results_scroller_(nullptr)
+    , results_list_(nullptr)
     , search_entry_(nullptr)
+    , match_label_(nullptr)
     , case_sensitive_(nullptr)
     , regex_mode_(nullptr)
+    , all_tabs_(nullptr)
     , prev_btn_(nullptr)
     , next_btn_(nullptr)
     , close_btn_(nullptr) {
@@ -37,6 +41,12 @@ SearchBar::SearchBar(GtkWidget* parent)
         G_CALLBACK(on_key_press_static), this);
     gtk_box_pack_start(GTK_BOX(search_box_), GTK_WIDGET(search_entry_), FALSE, FALSE, 0);
     
+    // Match count, filled in after each search
+    match_label_ = GTK_LABEL(gtk_label_new(""));
+    gtk_style_context_add_class(gtk_widget_get_style_context(GTK_WIDGET(match_label_)), "dim-label");
+    gtk_widget_set_no_show_all(GTK_WIDGET(match_label_), TRUE);
+    gtk_box_pack_start(GTK_BOX(search_box_), GTK_WIDGET(match_label_), FALSE, FALSE, 0);
+    
     // Previous button
     prev_btn_ = GTK_BUTTON(gtk_button_new_from_icon_name("go-up-symbolic", GTK_ICON_SIZE_BUTTON));
     gtk_widget_set_tooltip_text(GTK_WIDGET(prev_btn_), "Anterior (Shift+F3)");
@@ -61,14 +71,34 @@ SearchBar::SearchBar(GtkWidget* parent)
     g_signal_connect(regex_mode_, "toggled", G_CALLBACK(on_search_changed_static), this);
     gtk_box_pack_start(GTK_BOX(search_box_), GTK_WIDGET(regex_mode_), FALSE, FALSE, 0);
     
+    // All tabs checkbox
+    all_tabs_ = GTK_CHECK_BUTTON(gtk_check_button_new_with_label("Todas"));
+    gtk_widget_set_tooltip_text(GTK_WIDGET(all_tabs_), "Buscar en todas las pestañas");
+    g_signal_connect(all_tabs_, "toggled", G_CALLBACK(on_search_changed_static), this);
+    gtk_box_pack_start(GTK_BOX(search_box_), GTK_WIDGET(all_tabs_), FALSE, FALSE, 0);
+    
     // Close button
     close_btn_ = GTK_BUTTON(gtk_button_new_from_icon_name("window-close-symbolic", GTK_ICON_SIZE_BUTTON));
     gtk_widget_set_tooltip_text(GTK_WIDGET(close_btn_), "Cerrar (Escape)");
     g_signal_connect(close_btn_, "clicked", G_CALLBACK(on_close_clicked_static), this);
     gtk_box_pack_end(GTK_BOX(search_box_), GTK_WIDGET(close_btn_), FALSE, FALSE, 0);
     
+    // Results of an all-tabs search, below the bar
+    results_list_ = GTK_LIST_BOX(gtk_list_box_new());
+    gtk_list_box_set_selection_mode(results_list_, GTK_SELECTION_BROWSE);
+    g_signal_connect(results_list_, "row-activated", G_CALLBACK(on_row_activated_static), this);
+    results_scroller_ = gtk_scrolled_window_new(nullptr, nullptr);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(results_scroller_),
+        GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_min_content_height(GTK_SCROLLED_WINDOW(results_scroller_), 160);
+    gtk_container_add(GTK_CONTAINER(results_scroller_), GTK_WIDGET(results_list_));
+    gtk_widget_set_no_show_all(results_scroller_, TRUE);
+    
     // Add to revealer
-    gtk_container_add(GTK_CONTAINER(revealer_), search_box_);
+    GtkWidget* content = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    gtk_box_pack_start(GTK_BOX(content), search_box_, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(content), results_scroller_, FALSE, FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(revealer_), content);
     
     // Initially hidden
     gtk_revealer_set_reveal_child(GTK_REVEALER(revealer_), FALSE);
@@ -104,12 +134,69 @@ void SearchBar::focus_entry() {
     gtk_widget_grab_focus(GTK_WIDGET(search_entry_));
 }
 
+void SearchBar::set_match_count(std::optional<size_t> count, bool more) {
+    if (!count) {
+        gtk_widget_hide(GTK_WIDGET(match_label_));
+        return;
+    }
+    std::string text;
+    if (*count == 0) {
+        text = more ? "Buscando..." : "Sin resultados";
+    } else if (*count == 1 && !more) {
+        text = "1 coincidencia";
+    } else {
+        text = std::to_string(*count) + (more ? "+" : "") + " coincidencias";
+    }
+    gtk_label_set_text(match_label_, text.c_str());
+    gtk_widget_show(GTK_WIDGET(match_label_));
+}
+
+void SearchBar::show_notice(const std::string& text) {
+    gtk_label_set_text(match_label_, text.c_str());
+    gtk_widget_show(GTK_WIDGET(match_label_));
+}
+
+void SearchBar::clear_results() {
+    GList* rows = gtk_container_get_children(GTK_CONTAINER(results_list_));
+    for (GList* row = rows; row; row = row->next) {
+        gtk_widget_destroy(GTK_WIDGET(row->data));
+    }
+    g_list_free(rows);
+    gtk_widget_set_visible(results_scroller_, all_tabs());
+}
+
+void SearchBar::add_results(const std::vector<ResultRow>& rows) {
+    for (const auto& result : rows) {
+        GtkWidget* row = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 12);
+        gtk_widget_set_margin_start(row, 6);
+        gtk_widget_set_margin_end(row, 6);
+        GtkWidget* location = gtk_label_new(result.location.c_str());
+        gtk_style_context_add_class(gtk_widget_get_style_context(location), "dim-label");
+        gtk_box_pack_start(GTK_BOX(row), location, FALSE, FALSE, 0);
+        GtkWidget* text = gtk_label_new(result.text.c_str());
+        gtk_label_set_ellipsize(GTK_LABEL(text), PANGO_ELLIPSIZE_END);
+        gtk_label_set_xalign(GTK_LABEL(text), 0.0f);
+        gtk_box_pack_start(GTK_BOX(row), text, TRUE, TRUE, 0);
+        gtk_widget_show_all(row);
+        gtk_container_add(GTK_CONTAINER(results_list_), row);
+    }
+}
+
+bool SearchBar::all_tabs() const {
+    return gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(all_tabs_));
+}
+
+void SearchBar::set_result_activated_callback(ResultActivatedCallback callback) {
+    result_activated_callback_ = std::move(callback);
+}
+
 void SearchBar::on_search_changed() {
+    gtk_widget_set_visible(results_scroller_, all_tabs());
     if (search_callback_) {
         std::string query = gtk_entry_get_text(search_entry_);
         bool case_sensitive = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(case_sensitive_));
         bool regex = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(regex_mode_));
-        search_callback_(query, case_sensitive, regex);
+        search_callback_(query, case_sensitive, regex, all_tabs());
     }
 }
 
@@ -150,6 +237,14 @@ void SearchBar::on_close_clicked_static(GtkButton* button, gpointer user_data) {
     self->on_close_clicked();
 }
 
+void SearchBar::on_row_activated_static(GtkListBox*, GtkListBoxRow* row, gpointer user_data) {
+    auto* self = static_cast<SearchBar*>(user_data);
+    const int index = gtk_list_box_row_get_index(row);
+    if (index >= 0 && self->result_activated_callback_) {
+        self->result_activated_callback_(static_cast<size_t>(index));
+    }
+}
+
 gboolean SearchBar::on_key_press_static(GtkWidget* widget, GdkEventKey* event, gpointer user_data) {
     auto* self = static_cast<SearchBar*>(user_data);
     
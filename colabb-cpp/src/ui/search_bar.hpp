@@ -4,6 +4,8 @@
 #include <gtk/gtk.h>
 #include <string>
 #include <functional>
+#include <optional>
+#include <vector>
 
 namespace colabb {
 namespace ui {
@@ -19,27 +21,49 @@ public:
     
     GtkWidget* widget() const { return revealer_; }
     
-    // Callbacks
-    using SearchCallback = std::function<void(const std::string&, bool, bool)>;
+    // Callbacks: query, case sensitive, regex, all tabs
+    using SearchCallback = std::function<void(const std::string&, bool, bool, bool)>;
     using NavigationCallback = std::function<void(bool)>; // true = next, false = prev
+    // Index of the activated row, in the order rows were added
+    using ResultActivatedCallback = std::function<void(size_t)>;
     
     void set_search_callback(SearchCallback callback);
     void set_navigation_callback(NavigationCallback callback);
+    void set_result_activated_callback(ResultActivatedCallback callback);
     
     void focus_entry();
+    // Shows how many matches the current query has; nullopt hides the count.
+    // more: the count is a lower bound (search stopped early or still running)
+    void set_match_count(std::optional<size_t> count, bool more = false);
+    // Shows a short message where the count goes, until the next count
+    void show_notice(const std::string& text);
+
+    // Results of an all-tabs search, streamed in as they're found
+    struct ResultRow {
+        std::string location; // e.g. "Terminal 2:1534"
+        std::string text;
+    };
+    void clear_results();
+    void add_results(const std::vector<ResultRow>& rows);
+    bool all_tabs() const;
     
 private:
     GtkWidget* revealer_;
     GtkWidget* search_box_;
+    GtkWidget* results_scroller_;
+    GtkListBox* results_list_;
     GtkEntry* search_entry_;
+    GtkLabel* match_label_;
     GtkCheckButton* case_sensitive_;
     GtkCheckButton* regex_mode_;
+    GtkCheckButton* all_tabs_;
     GtkButton* prev_btn_;
     GtkButton* next_btn_;
     GtkButton* close_btn_;
     
     SearchCallback search_callback_;
     NavigationCallback navigation_callback_;
+    ResultActivatedCallback result_activated_callback_;
     
     // Event handlers
     void on_search_changed();
@@ -53,6 +77,7 @@ private:
     static void on_prev_clicked_static(GtkButton* button, gpointer user_data);
     static void on_close_clicked_static(GtkButton* button, gpointer user_data);
     static gboolean on_key_press_static(GtkWidget* widget, GdkEventKey* event, gpointer user_data);
+    static void on_row_activated_static(GtkListBox* list, GtkListBoxRow* row, gpointer user_data);
 };
 
 } // namespace ui
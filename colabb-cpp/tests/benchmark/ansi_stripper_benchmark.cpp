@@ -0,0 +1,69 @@
+// Throughput of AnsiStripper against the std::regex_replace it replaced.
+// Not part of the test suite: build target colabb_benchmarks and run it
+// from an optimized build.
+#include "infrastructure/terminal/ansi_stripper.hpp"
+#include <chrono>
+#include <cstdio>
+#include <regex>
+#include <string>
+
+using colabb::infrastructure::AnsiStripper;
+
+namespace {
+
+// Mix of colored prompts, `ls --color` listings, compiler diagnostics and
+// \r-redrawn progress bars, roughly what an interactive tab produces.
+std::string make_corpus(size_t target_bytes) {
+    std::string corpus;
+    int i = 0;
+    while (corpus.size() < target_bytes) {
+        corpus += "\x1b]0;user@host: ~/src/project\x07\x1b[01;32muser@host\x1b[00m:\x1b[01;34m~/src/project\x1b[00m$ make\r\n";
+        corpus += "src/module_" + std::to_string(i) + ".cpp:42:13: \x1b[01;31merror:\x1b[0m expected ';' before '}' token\r\n";
+        corpus += "\x1b[0m\x1b[01;34mbuild\x1b[0m  \x1b[01;32mconfigure\x1b[0m  README.md  src  tests\r\n";
+        for (int p = 0; p <= 100; p += 20) {
+            corpus += "\rDownloading [" + std::string(p / 5, '#') + std::string(20 - p / 5, ' ') + "] " +
+                      std::to_string(p) + "%\x1b[K";
+        }
+        corpus += "\r\n";
+        ++i;
+    }
+    return corpus;
+}
+
+template <typename F>
+double megabytes_per_second(size_t bytes, int iterations, F&& run) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        run();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(bytes) * iterations / (1024.0 * 1024.0) / elapsed.count();
+}
+
+} // namespace
+
+int main() {
+    const std::string corpus = make_corpus(4 * 1024 * 1024);
+    constexpr size_t kChunk = 4096; // typical PTY read size
+    size_t sink = 0;
+
+    static const std::regex ansi_regex(R"(\x1B(?:[@-Z\\-_]|\[[0-?]*[ -/]*[@-~]))");
+    const double regex_rate = megabytes_per_second(corpus.size(), 1, [&] {
+        sink += std::regex_replace(corpus, ansi_regex, "").size();
+    });
+
+    const double stripper_rate = megabytes_per_second(corpus.size(), 20, [&] {
+        AnsiStripper stripper;
+        std::string out;
+        for (size_t offset = 0; offset < corpus.size(); offset += kChunk) {
+            out.clear();
+            stripper.feed(corpus.data() + offset, std::min(kChunk, corpus.size() - offset), out);
+            sink += out.size();
+        }
+    });
+
+    std::printf("corpus:        %.1f MiB\n", corpus.size() / (1024.0 * 1024.0));
+    std::printf("regex_replace: %8.1f MiB/s\n", regex_rate);
+    std::printf("AnsiStripper:  %8.1f MiB/s (%.0fx)\n", stripper_rate, stripper_rate / regex_rate);
+    return sink == 0;
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/ansi_stripper.hpp"
+#include <vector>
+
+using colabb::infrastructure::AnsiStripper;
+
+namespace {
+
+std::string strip(AnsiStripper& stripper, const std::string& raw) {
+    std::string out;
+    stripper.feed(raw.data(), raw.size(), out);
+    return out;
+}
+
+} // namespace
+
+TEST(AnsiStripperTest, RemovesEscapeSequences) {
+    AnsiStripper stripper;
+    EXPECT_EQ(strip(stripper, "\x1b[1;32muser@host\x1b[0m:\x1b[34m~\x1b[0m$ ls\r\n"), "user@host:~$ ls\n");
+    // OSC title (BEL and ST terminated), charset designation, DCS, keypad mode
+    EXPECT_EQ(strip(stripper, "\x1b]0;title\x07" "a\x1b]7;file:///tmp\x1b\\b\x1b(Bc\x1bPq#0;1\x1b\\d\x1b=e\n"),
+              "abcde\n");
+    EXPECT_EQ(strip(stripper, "\x1b[?2004hbell\x07\n"), "bell\n");
+}
+
+TEST(AnsiStripperTest, SequencesSplitAcrossChunks) {
+    AnsiStripper stripper;
+    const std::string raw = "\x1b[31merror\x1b[0m: \x1b]0;make\x07" "failed\n";
+    std::string out;
+    for (char c : raw) {
+        stripper.feed(&c, 1, out);
+    }
+    EXPECT_EQ(out, "error: failed\n");
+}
+
+TEST(AnsiStripperTest, CarriageReturnAndBackspaceRebuildLine) {
+    AnsiStripper stripper;
+    // Progress bar redrawn in place, then cleared with EL
+    EXPECT_EQ(strip(stripper, "10%\r50%\r100%\n"), "100%\n");
+    EXPECT_EQ(strip(stripper, "downloading...\r\x1b[Kdone\n"), "done\n");
+    EXPECT_EQ(strip(stripper, "abcdef\r12\n"), "12cdef\n");
+    EXPECT_EQ(strip(stripper, "lss\b \b -la\n"), "ls -la\n");
+    EXPECT_EQ(strip(stripper, "x\x1b[2K\x1b[1Gok\n"), "ok\n");
+    // Multi-byte characters are overwritten as a whole
+    EXPECT_EQ(strip(stripper, "año\b\bn\n"), "ano\n");
+}
+
+TEST(AnsiStripperTest, PendingLine) {
+    AnsiStripper stripper;
+    EXPECT_EQ(strip(stripper, "line\n$ git sta"), "line\n");
+    EXPECT_EQ(stripper.pending_line(), "$ git sta");
+    stripper.reset();
+    EXPECT_EQ(stripper.pending_line(), "");
+
+    // Output with no newline is flushed instead of growing without bound
+    const std::string long_line(AnsiStripper::kMaxLineLength + 10, 'x');
+    EXPECT_EQ(strip(stripper, long_line).size(), long_line.size() + 1);
+}
+
+TEST(AnsiStripperTest, FindControl) {
+    std::string text(100, 'a');
+    EXPECT_EQ(AnsiStripper::find_control(text.data(), text.size()), 100u);
+    text[37] = '\x1b';
+    EXPECT_EQ(AnsiStripper::find_control(text.data(), text.size()), 37u);
+    text[5] = '\x7f';
+    EXPECT_EQ(AnsiStripper::find_control(text.data(), text.size()), 5u);
+    const std::string utf8 = "ñandú ünïcödé éé";
+    EXPECT_EQ(AnsiStripper::find_control(utf8.data(), utf8.size()), utf8.size());
+}
+
+TEST(AnsiStripperTest, OscHandlerSeesPayloadsInOrder) {
+    AnsiStripper stripper;
+    std::vector<std::pair<std::string, std::uint64_t>> seen;
+    stripper.set_osc_handler([&](std::string_view payload) {
+        seen.emplace_back(std::string(payload), stripper.lines_committed());
+    });
+    const std::string raw = "a\n\x1b]133;C;cmdline=for f in *\ndo echo $f; done\x07" "b\n\x1b]133;D;0\x1b\\";
+    std::string out;
+    for (char c : raw) {
+        stripper.feed(&c, 1, out);
+    }
+    EXPECT_EQ(out, "a\nb\n");
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], (std::pair<std::string, std::uint64_t>{"133;C;cmdline=for f in *\ndo echo $f; done", 1}));
+    EXPECT_EQ(seen[1], (std::pair<std::string, std::uint64_t>{"133;D;0", 2}));
+}
+
+TEST(AnsiStripperTest, AlternateScreenIsNotLogged) {
+    AnsiStripper stripper;
+    EXPECT_EQ(strip(stripper, "$ vim notes.txt\r\n\x1b[?1049h\x1b[?25l\x1b[1;1H~\r\n~\r\n\x1b[24;1H\"notes.txt\" 2L"),
+              "$ vim notes.txt\n");
+    EXPECT_TRUE(stripper.alternate_screen());
+    EXPECT_EQ(stripper.pending_line(), "");
+
+    EXPECT_EQ(strip(stripper, "\x1b[?1049l\x1b[?25h$ ls\r\n"), "$ ls\n");
+    EXPECT_FALSE(stripper.alternate_screen());
+}
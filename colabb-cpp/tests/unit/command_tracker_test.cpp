@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/ansi_stripper.hpp"
+#include "infrastructure/terminal/command_tracker.hpp"
+#include "infrastructure/terminal/line_buffer.hpp"
+#include "infrastructure/terminal/shell_integration.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+using namespace colabb::infrastructure;
+
+namespace {
+
+// Same wiring as TerminalWidget: stripper -> line buffer, marks -> tracker
+struct Tab {
+    AnsiStripper stripper;
+    LineBuffer output;
+    CommandTracker commands;
+
+    Tab() {
+        stripper.set_osc_handler([this](std::string_view payload) {
+            commands.handle_osc(payload, stripper.lines_committed());
+        });
+    }
+
+    void feed(const std::string& raw) {
+        std::string clean;
+        stripper.feed(raw.data(), raw.size(), clean);
+        output.append(clean);
+    }
+};
+
+} // namespace
+
+TEST(CommandTrackerTest, RecordsCommandsFromMarks) {
+    // Shaped like what the bash hooks produce
+    Tab tab;
+    tab.feed("\x1b]133;A\x07$ echo hi\r\n\x1b]133;C;cmdline=echo hi\x07hi\r\n"
+             "\x1b]133;D;0\x07\x1b]133;A\x07$ make\r\n\x1b]133;C;cmdline=make\x07"
+             "cc main.c\r\nmain.c:3: error: expected ';'\r\n\x1b]133;D;2\x07\x1b]133;A\x07$ ");
+
+    ASSERT_TRUE(tab.commands.active());
+    ASSERT_EQ(tab.commands.records().size(), 2u);
+    const CommandRecord& echo = tab.commands.records().front();
+    EXPECT_EQ(echo.command, "echo hi");
+    EXPECT_EQ(echo.exit_code, 0);
+    EXPECT_EQ(tab.output.span(echo.output_begin, echo.output_end), "hi\n");
+
+    const CommandRecord* failed = tab.commands.last_failed();
+    ASSERT_NE(failed, nullptr);
+    EXPECT_EQ(failed, tab.commands.last_finished());
+    EXPECT_EQ(failed->command, "make");
+    EXPECT_EQ(failed->exit_code, 2);
+    EXPECT_EQ(tab.output.span(failed->output_begin, failed->output_end),
+              "cc main.c\nmain.c:3: error: expected ';'\n");
+
+    // A later success doesn't hide the last failure
+    tab.feed("ls\r\n\x1b]133;C;cmdline=ls; true\x07" "a.out\r\n\x1b]133;D;0\x07");
+    EXPECT_EQ(tab.commands.last_finished()->command, "ls; true");
+    EXPECT_EQ(tab.commands.last_failed(), failed);
+}
+
+TEST(CommandTrackerTest, UnreportedExitAndEviction) {
+    CommandTracker tracker(2);
+    EXPECT_FALSE(tracker.handle_osc("7;file:///tmp", 0));
+    EXPECT_FALSE(tracker.active());
+
+    tracker.handle_osc("133;C;cmdline=false", 1);
+    tracker.handle_osc("133;D;1", 2);
+    tracker.handle_osc("133;C;cmdline=sleep 10", 3);
+    EXPECT_FALSE(tracker.last()->finished);
+    tracker.handle_osc("133;A", 5); // interrupted without D
+    EXPECT_TRUE(tracker.last()->finished);
+    EXPECT_FALSE(tracker.last()->exit_code.has_value());
+    EXPECT_EQ(tracker.last()->output_end, 5u);
+    EXPECT_EQ(tracker.last_failed()->command, "false");
+
+    tracker.handle_osc("133;C;cmdline=true", 6);
+    tracker.handle_osc("133;D;0", 7);
+    EXPECT_EQ(tracker.records().size(), 2u);
+    EXPECT_EQ(tracker.last_failed(), nullptr); // evicted
+
+    tracker.clear();
+    EXPECT_EQ(tracker.last(), nullptr);
+    EXPECT_EQ(tracker.last_finished(), nullptr);
+}
+
+TEST(ShellIntegrationTest, RewritesSupportedShells) {
+    const fs::path dir = fs::temp_directory_path() / ("colabb_shell_integration_" + std::to_string(std::rand()));
+    ShellIntegration integration(dir.string());
+
+    std::vector<std::string> argv{"/bin/bash"};
+    ShellIntegration::Environment env;
+    ASSERT_TRUE(integration.apply(argv, env));
+    EXPECT_EQ(argv, (std::vector<std::string>{"/bin/bash", "--rcfile", (dir / "bashrc").string()}));
+    EXPECT_TRUE(fs::exists(dir / "bashrc"));
+
+    argv = {"bash", "--login"};
+    EXPECT_FALSE(integration.apply(argv, env));
+    EXPECT_EQ(argv.size(), 2u);
+
+    argv = {"/usr/bin/zsh"};
+    ASSERT_TRUE(integration.apply(argv, env));
+    ASSERT_FALSE(env.empty());
+    EXPECT_EQ(env.back(), (std::pair<std::string, std::string>{"ZDOTDIR", (dir / "zsh").string()}));
+    EXPECT_TRUE(fs::exists(dir / "zsh" / ".zshrc"));
+
+    env.clear();
+    argv = {"fish"};
+    ASSERT_TRUE(integration.apply(argv, env));
+    EXPECT_EQ(env.front().second.rfind((dir / "fish").string() + ":", 0), 0u);
+    EXPECT_TRUE(fs::exists(dir / "fish" / "fish" / "vendor_conf.d" / "colabb.fish"));
+
+    argv = {"/bin/dash"};
+    EXPECT_FALSE(integration.apply(argv, env));
+    fs::remove_all(dir);
+}
+
+TEST(ShellIntegrationTest, BashHooksKeepUserPromptCommandAndTrap) {
+    if (!fs::exists("/bin/bash")) GTEST_SKIP() << "bash not installed";
+    const fs::path dir = fs::temp_directory_path() / ("colabb_bash_hooks_" + std::to_string(std::rand()));
+    const fs::path home = dir / "home";
+    fs::create_directories(home);
+    // Commands in the user's PROMPT_COMMAND must not be taken for the next command line
+    std::ofstream(home / ".bashrc") << "PROMPT_COMMAND='history -a'\n"
+                                       "trap 'echo \"$BASH_COMMAND\" >> ~/trap.log' DEBUG\n";
+
+    ShellIntegration integration((dir / "hooks").string());
+    std::vector<std::string> argv{"/bin/bash"};
+    ShellIntegration::Environment env;
+    ASSERT_TRUE(integration.apply(argv, env));
+    const std::string command = "printf 'echo one\\nfalse\\necho two\\n' | HOME='" + home.string() +
+                                "' HISTFILE='" + (home / ".history").string() + "' /bin/bash --rcfile '" +
+                                argv.back() + "' -i 2>&1";
+    Tab tab;
+    FILE* pipe = popen(command.c_str(), "r");
+    ASSERT_NE(pipe, nullptr);
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+        tab.feed(std::string(buffer, n));
+    }
+    pclose(pipe);
+
+    const auto& records = tab.commands.records();
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].command, "echo one");
+    EXPECT_EQ(records[0].exit_code, 0);
+    EXPECT_EQ(records[1].command, "false");
+    EXPECT_EQ(records[1].exit_code, 1);
+    EXPECT_EQ(records[2].command, "echo two");
+
+    // The user's DEBUG trap still runs
+    std::ifstream log(home / "trap.log");
+    std::stringstream trapped;
+    trapped << log.rdbuf();
+    EXPECT_NE(trapped.str().find("echo two\n"), std::string::npos);
+    fs::remove_all(dir);
+}
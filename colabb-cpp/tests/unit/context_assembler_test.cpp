@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "application/context_assembler.hpp"
+#include "application/context_providers.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace colabb::application;
+using colabb::domain::ContextRequest;
+using colabb::domain::IContextProvider;
+
+namespace {
+
+class FakeProvider : public IContextProvider {
+public:
+    FakeProvider(std::string name, std::string section, std::chrono::milliseconds delay = {}, bool fail = false)
+        : name_(std::move(name)), section_(std::move(section)), delay_(delay), fail_(fail) {}
+
+    std::string name() const override { return name_; }
+    std::string provide(const ContextRequest&) override {
+        ++calls;
+        std::this_thread::sleep_for(delay_);
+        if (fail_) throw std::runtime_error("boom");
+        return section_;
+    }
+
+    std::atomic<int> calls{0};
+
+private:
+    std::string name_;
+    std::string section_;
+    std::chrono::milliseconds delay_;
+    bool fail_;
+};
+
+} // namespace
+
+TEST(ContextAssemblerTest, SectionsInRegistrationOrder) {
+    ContextAssembler assembler(4, std::chrono::milliseconds(500));
+    assembler.add_provider(std::make_shared<FakeProvider>("a", "A\n", std::chrono::milliseconds(30)));
+    assembler.add_provider(std::make_shared<FakeProvider>("empty", ""));
+    assembler.add_provider(std::make_shared<FakeProvider>("b", "B"));
+
+    auto result = assembler.assemble(ContextRequest{});
+    EXPECT_EQ(result.context, "A\n\nB");
+    EXPECT_TRUE(result.missed.empty());
+}
+
+TEST(ContextAssemblerTest, LateProvidersAreLeftOut) {
+    ContextAssembler assembler(4, std::chrono::milliseconds(50));
+    auto slow = std::make_shared<FakeProvider>("slow", "SLOW", std::chrono::milliseconds(300));
+    assembler.add_provider(std::make_shared<FakeProvider>("fast", "FAST"));
+    assembler.add_provider(slow);
+    assembler.add_provider(std::make_shared<FakeProvider>("broken", "X", std::chrono::milliseconds(0), true));
+
+    const auto start = std::chrono::steady_clock::now();
+    auto result = assembler.assemble(ContextRequest{});
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+    EXPECT_EQ(result.context, "FAST");
+    EXPECT_EQ(result.missed, std::vector<std::string>{"slow"});
+
+    // Still busy with the first request: not started a second time
+    result = assembler.assemble(ContextRequest{});
+    EXPECT_EQ(result.missed, std::vector<std::string>{"slow"});
+    EXPECT_EQ(slow->calls, 1);
+}
+
+TEST(ContextProvidersTest, RecentErrors) {
+    ContextRequest request;
+    request.terminal_output = "$ make\ncc main.c\nmain.c:3: error: expected ';'\nmake: *** [all] Error 1\n"
+                              "$ ls\nmain.c\n$ foo\nbash: foo: command not found\n";
+    RecentErrorsProvider provider(2);
+    EXPECT_EQ(provider.provide(request), "Recent Errors:\n- make: *** [all] Error 1\n- bash: foo: command not found\n");
+
+    request.terminal_output = "$ ls\nmain.c\n";
+    EXPECT_EQ(provider.provide(request), "");
+}
+
+TEST(ContextProvidersTest, ParseHistoryFormats) {
+    EXPECT_EQ(ShellHistoryProvider::parse_history("#1700000000\nls\nls\ngit status\n", 10),
+              (std::vector<std::string>{"ls", "git status"}));
+    EXPECT_EQ(ShellHistoryProvider::parse_history(": 1700000000:0;make test\n: 1700000001:0;make\n", 1),
+              std::vector<std::string>{"make"});
+    EXPECT_EQ(ShellHistoryProvider::parse_history("- cmd: cargo build\n  when: 1700000000\n", 10),
+              std::vector<std::string>{"cargo build"});
+}
+
+TEST(ContextProvidersTest, HistoryFileIsReadAndCached) {
+    const std::string path = "/tmp/colabb_test_history_" + std::to_string(std::rand());
+    {
+        std::ofstream f(path);
+        f << "cd src\nmake\n";
+    }
+    ShellHistoryProvider provider(path, 10);
+    EXPECT_EQ(provider.provide(ContextRequest{}), "Recent Commands:\n- cd src\n- make\n");
+
+    {
+        std::ofstream f(path, std::ios::app);
+        f << "make test\n";
+    }
+    EXPECT_EQ(provider.provide(ContextRequest{}), "Recent Commands:\n- cd src\n- make\n- make test\n");
+    fs::remove(path);
+}
+
+TEST(ContextProvidersTest, LastFailure) {
+    ContextRequest request;
+    LastFailureProvider provider;
+    EXPECT_EQ(provider.provide(request), "");
+
+    request.failed_command = "make";
+    request.failed_output = "main.c:3: error: expected ';'";
+    request.failed_exit_code = 2;
+    EXPECT_EQ(provider.provide(request),
+              "Last Failed Command (exit status 2):\n$ make\nmain.c:3: error: expected ';'\n");
+}
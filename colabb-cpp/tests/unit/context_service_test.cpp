@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 #include "infrastructure/context/context_service.hpp"
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <chrono>
+#include <thread>
 
 namespace fs = std::filesystem;
 using namespace colabb::infrastructure;
@@ -68,12 +71,258 @@ TEST_F(ContextServiceTest, DetectPythonGit) {
     EXPECT_EQ(info.git_branch, "feature/ai");
 }
 
+TEST_F(ContextServiceTest, SubdirectoryFindsProjectRoot) {
+    create_file("CMakeLists.txt");
+    create_dir(".git");
+    create_file(".git/HEAD", "ref: refs/heads/main");
+    create_dir("src/ui");
+
+    ContextService service(false);
+    auto info = service.detect_context(temp_dir_ + "/src/ui");
+
+    ASSERT_EQ(info.build_tools.size(), 1);
+    EXPECT_EQ(info.build_tools[0], "CMake");
+    EXPECT_EQ(info.project_root, temp_dir_);
+    EXPECT_EQ(info.project_name, fs::path(temp_dir_).filename().string());
+    EXPECT_TRUE(info.is_git_repo);
+    EXPECT_EQ(info.git_branch, "main");
+
+    // A sibling reuses the memoized ancestors
+    create_dir("src/app");
+    EXPECT_EQ(service.detect_context(temp_dir_ + "/src/app").project_root, temp_dir_);
+}
+
+TEST_F(ContextServiceTest, AncestorWalkStopsAtGit) {
+    create_file("package.json");
+    create_dir("vendor/lib/.git");
+    create_file("vendor/lib/.git/HEAD", "ref: refs/heads/main");
+    create_dir("vendor/lib/src");
+
+    ContextService service(false);
+    auto info = service.detect_context(temp_dir_ + "/vendor/lib/src");
+
+    EXPECT_TRUE(info.build_tools.empty());
+    EXPECT_EQ(info.project_root, temp_dir_ + "/vendor/lib");
+    EXPECT_TRUE(info.is_git_repo);
+}
+
 TEST_F(ContextServiceTest, PromptGeneration) {
     create_file("package.json");
+    create_file(".nvmrc", "20");
     
     ContextService service;
     std::string prompt = service.get_context_prompt(temp_dir_);
     
     EXPECT_NE(prompt.find("NPM"), std::string::npos);
     EXPECT_NE(prompt.find("JavaScript/TypeScript"), std::string::npos);
+    EXPECT_NE(prompt.find("- Toolchain: Node 20"), std::string::npos);
+}
+
+TEST_F(ContextServiceTest, CachedPromptPrefetchesOnMiss) {
+    create_file("package.json");
+
+    ContextService service(false);
+    // A miss never touches the filesystem: only the directory name is known
+    auto prompt = service.get_cached_context_prompt(temp_dir_);
+    EXPECT_NE(prompt->find(fs::path(temp_dir_).filename().string()), std::string::npos);
+    EXPECT_EQ(prompt->find("NPM"), std::string::npos);
+
+    // ...but it queued a background detection that fills the cache
+    bool filled = false;
+    for (int i = 0; i < 200 && !filled; ++i) {
+        filled = service.get_cached_context_prompt(temp_dir_)->find("NPM") != std::string::npos;
+        if (!filled) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(filled);
+}
+
+TEST_F(ContextServiceTest, PromptSharedByFingerprint) {
+    create_file("Cargo.toml");
+    create_dir("a");
+    create_dir("b");
+
+    ContextService service(false);
+    service.detect_context(temp_dir_ + "/a");
+    service.detect_context(temp_dir_ + "/b");
+
+    // Same project seen from two directories: one rendered string
+    auto first = service.get_cached_context_prompt(temp_dir_ + "/a");
+    auto second = service.get_cached_context_prompt(temp_dir_ + "/b");
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(first.get(), service.get_cached_context_prompt(temp_dir_ + "/a").get());
+    EXPECT_NE(first->find("Cargo"), std::string::npos);
+
+    ContextService::ProjectInfo info = service.detect_context(temp_dir_ + "/a");
+    const auto before = ContextService::fingerprint(info);
+    info.git_modified = 3;
+    EXPECT_NE(ContextService::fingerprint(info), before);
+}
+
+TEST_F(ContextServiceTest, MemoryUsageAndTrim) {
+    create_file("CMakeLists.txt");
+    create_dir("sub");
+
+    ContextService service;
+    EXPECT_EQ(service.memory_usage(), 0u);
+    service.detect_context(temp_dir_);
+    service.detect_context(temp_dir_ + "/sub");
+
+    const size_t used = service.memory_usage();
+    EXPECT_GT(used, 0u);
+    EXPECT_EQ(service.trim_to(0), used);
+    EXPECT_EQ(service.memory_usage(), 0u);
+}
+
+namespace {
+// Polls detect_context until pred holds (inotify delivery is asynchronous)
+template <typename Pred>
+bool eventually(ContextService& service, const std::string& path, Pred pred) {
+    for (int i = 0; i < 200; ++i) {
+        if (pred(service.detect_context(path))) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+}
+
+TEST_F(ContextServiceTest, InotifyInvalidatesOnMarkerFile) {
+    ContextService service;
+    if (!service.is_watching()) GTEST_SKIP() << "inotify unavailable";
+
+    EXPECT_TRUE(service.detect_context(temp_dir_).build_tools.empty());
+    create_file("Cargo.toml");
+
+    EXPECT_TRUE(eventually(service, temp_dir_, [](const ContextService::ProjectInfo& info) {
+        return !info.build_tools.empty() && info.build_tools[0] == "Cargo";
+    }));
+}
+
+TEST_F(ContextServiceTest, InotifyInvalidatesOnAncestorMarker) {
+    create_dir("a/b");
+
+    ContextService service;
+    if (!service.is_watching()) GTEST_SKIP() << "inotify unavailable";
+
+    EXPECT_TRUE(service.detect_context(temp_dir_ + "/a/b").build_tools.empty());
+    create_file("a/go.mod");
+
+    EXPECT_TRUE(eventually(service, temp_dir_ + "/a/b", [](const ContextService::ProjectInfo& info) {
+        return !info.build_tools.empty() && info.build_tools[0] == "Go";
+    }));
+}
+
+TEST_F(ContextServiceTest, InotifyInvalidatesOnCheckout) {
+    create_dir(".git/refs/heads");
+    create_file(".git/HEAD", "ref: refs/heads/main");
+
+    ContextService service;
+    if (!service.is_watching()) GTEST_SKIP() << "inotify unavailable";
+    EXPECT_EQ(service.detect_context(temp_dir_).git_branch, "main");
+
+    // git writes HEAD.lock and renames it over HEAD
+    create_file(".git/HEAD.lock", "ref: refs/heads/feature");
+    fs::rename(temp_dir_ + "/.git/HEAD.lock", temp_dir_ + "/.git/HEAD");
+
+    EXPECT_TRUE(eventually(service, temp_dir_, [](const ContextService::ProjectInfo& info) {
+        return info.git_branch == "feature";
+    }));
+}
+
+TEST_F(ContextServiceTest, InotifyInvalidatesOnNestedBranchRef) {
+    create_dir(".git/refs/heads/feature");
+    create_file(".git/HEAD", "ref: refs/heads/feature/x");
+
+    ContextService service;
+    if (!service.is_watching()) GTEST_SKIP() << "inotify unavailable";
+    EXPECT_EQ(service.detect_context(temp_dir_).git_branch, "feature/x");
+    EXPECT_EQ(service.cache_size(), 1u);
+
+    // A commit on feature/x rewrites refs/heads/feature/x
+    create_file(".git/refs/heads/feature/x.lock", "1111111111111111111111111111111111111111\n");
+    fs::rename(temp_dir_ + "/.git/refs/heads/feature/x.lock", temp_dir_ + "/.git/refs/heads/feature/x");
+
+    bool invalidated = false;
+    for (int i = 0; i < 200 && !invalidated; ++i) {
+        invalidated = service.cache_size() == 0;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(invalidated);
+}
+
+TEST_F(ContextServiceTest, WorktreeEditsRefreshGitStatus) {
+    const std::string git = "git -C " + temp_dir_ + " -c user.name=t -c user.email=t@t "
+                            "-c commit.gpgsign=false ";
+    create_file("f.txt", "1\n");
+    if (std::system((git + "init -q && " + git + "add -A && " + git + "commit -q -m c1 >/dev/null 2>&1").c_str()) != 0) {
+        GTEST_SKIP() << "git unavailable";
+    }
+
+    ContextService service;
+    service.set_git_status_ttl(std::chrono::milliseconds(20));
+    EXPECT_EQ(service.detect_context(temp_dir_).git_modified, 0);
+
+    // Editing a tracked file touches nothing under .git
+    create_file("f.txt", "edited\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_EQ(service.detect_context(temp_dir_).git_modified, 1);
+}
+
+TEST_F(ContextServiceTest, SharedDirectoryListing) {
+    create_file("Cargo.toml");
+
+    DirectoryCache directories;
+    ContextService service;
+    service.set_directory_cache(&directories);
+    if (!service.is_watching()) GTEST_SKIP() << "inotify unavailable";
+
+    // A prefetch loads the listing before detecting
+    service.prefetch(temp_dir_);
+    for (int i = 0; i < 200 && !directories.get(temp_dir_); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_NE(directories.get(temp_dir_), nullptr);
+    ASSERT_EQ(service.detect_context(temp_dir_).build_tools, std::vector<std::string>{"Cargo"});
+
+    // Markers read from the listing still follow changes
+    create_file("go.mod", "module x\n");
+    EXPECT_TRUE(eventually(service, temp_dir_, [](const ContextService::ProjectInfo& info) {
+        return info.build_tools.size() == 2;
+    }));
+}
+
+TEST_F(ContextServiceTest, CacheBoundedByLeastRecentlyUsed) {
+    for (const char* dir : {"a", "b", "c"}) create_dir(dir);
+
+    ContextService service(false);
+    service.set_cache_limits(2, std::chrono::minutes(10));
+    service.detect_context(temp_dir_ + "/a");
+    service.detect_context(temp_dir_ + "/b");
+    service.detect_context(temp_dir_ + "/a"); // hit: a is now newest
+    service.detect_context(temp_dir_ + "/c"); // evicts b
+
+    EXPECT_EQ(service.cache_size(), 2u);
+    auto stats = service.cache_stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 3u);
+    EXPECT_EQ(stats.evicted, 1u);
+    EXPECT_DOUBLE_EQ(stats.hit_rate(), 0.25);
+
+    service.detect_context(temp_dir_ + "/a");
+    EXPECT_EQ(service.cache_stats().hits, 2u);
+    service.detect_context(temp_dir_ + "/b");
+    EXPECT_EQ(service.cache_stats().misses, 4u);
+}
+
+TEST_F(ContextServiceTest, SweepExpiresIdleEntries) {
+    create_dir("a");
+    ContextService service(false);
+    service.set_cache_limits(16, std::chrono::milliseconds(20));
+    service.detect_context(temp_dir_);
+    service.detect_context(temp_dir_ + "/a");
+    EXPECT_EQ(service.sweep_expired(), 0u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_EQ(service.sweep_expired(), 2u);
+    EXPECT_EQ(service.cache_size(), 0u);
+    EXPECT_EQ(service.cache_stats().expired, 2u);
 }
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include "infrastructure/filesystem/directory_cache.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace colabb::infrastructure;
+
+class DirectoryCacheTest : public ::testing::Test {
+protected:
+    std::string temp_dir_;
+
+    void SetUp() override {
+        temp_dir_ = "/tmp/colabb_test_dircache_" + std::to_string(std::rand());
+        fs::create_directories(temp_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(temp_dir_);
+    }
+
+    void create_file(const std::string& name, const std::string& content = "") {
+        fs::create_directories(fs::path(temp_dir_ + "/" + name).parent_path());
+        std::ofstream f(temp_dir_ + "/" + name);
+        f << content;
+    }
+
+    template <typename Pred>
+    static bool eventually(const DirectoryCache& cache, const std::string& dir, Pred pred) {
+        for (int i = 0; i < 200; ++i) {
+            auto listing = cache.get(dir);
+            if (listing && pred(*listing)) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return false;
+    }
+};
+
+TEST_F(DirectoryCacheTest, LoadListsEntriesSorted) {
+    create_file("b.txt", "hello");
+    create_file("a/inner.txt");
+    fs::create_symlink("b.txt", temp_dir_ + "/link");
+
+    DirectoryCache cache(4, 100, false);
+    EXPECT_EQ(cache.get(temp_dir_), nullptr);
+
+    auto listing = cache.load(temp_dir_ + "/");
+    ASSERT_NE(listing, nullptr);
+    ASSERT_EQ(listing->entries.size(), 3u);
+    EXPECT_EQ(listing->entries[0].name, "a");
+    EXPECT_EQ(listing->entries[0].type, DirectoryCache::Type::Directory);
+    EXPECT_EQ(listing->find("b.txt")->size, 5u);
+    EXPECT_EQ(listing->find("link")->type, DirectoryCache::Type::Symlink);
+    EXPECT_EQ(listing->find("missing"), nullptr);
+    EXPECT_EQ(cache.get(temp_dir_), listing);
+
+    EXPECT_EQ(cache.load(temp_dir_ + "/nope"), nullptr);
+}
+
+TEST_F(DirectoryCacheTest, TruncatesLargeDirectories) {
+    for (int i = 0; i < 10; ++i) create_file("f" + std::to_string(i));
+    DirectoryCache cache(4, 5, false);
+    auto listing = cache.load(temp_dir_);
+    EXPECT_TRUE(listing->truncated);
+    EXPECT_EQ(listing->entries.size(), 5u);
+    // Absence can't be proven from a partial listing
+    EXPECT_TRUE(cache.unknown_references(temp_dir_, "cat missing.txt").empty());
+}
+
+TEST_F(DirectoryCacheTest, EvictsLeastRecentlyLoaded) {
+    for (const char* dir : {"x", "y", "z"}) fs::create_directories(temp_dir_ + "/" + dir);
+    DirectoryCache cache(2, 100, false);
+    cache.load(temp_dir_ + "/x");
+    cache.load(temp_dir_ + "/y");
+    cache.load(temp_dir_ + "/x");
+    cache.load(temp_dir_ + "/z");
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_NE(cache.get(temp_dir_ + "/x"), nullptr);
+    EXPECT_EQ(cache.get(temp_dir_ + "/y"), nullptr);
+    EXPECT_GT(cache.memory_usage(), 0u);
+    EXPECT_GT(cache.trim_to(0), 0u);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(DirectoryCacheTest, UnknownReferences) {
+    create_file("main.py");
+    create_file("src/app.cpp");
+    create_file(".env");
+
+    DirectoryCache cache(4, 100, false);
+    EXPECT_TRUE(cache.unknown_references(temp_dir_, "cat mian.py").empty()); // not cached yet
+    cache.load(temp_dir_);
+
+    auto unknown = [&](const std::string& command) { return cache.unknown_references(temp_dir_, command); };
+    EXPECT_TRUE(unknown("python3 main.py --port=8080").empty());
+    EXPECT_TRUE(unknown("g++ ./src/app.cpp -o app.out").empty());
+    EXPECT_TRUE(unknown("source .env && ls *.py").empty());
+    EXPECT_EQ(unknown("python3 mian.py"), std::vector<std::string>{"mian.py"});
+    EXPECT_EQ(unknown("cat main.py lib/util.py | grep x > out.txt 2>&1"), std::vector<std::string>{"lib/util.py"});
+    EXPECT_EQ(unknown("wc -l < input.csv"), std::vector<std::string>{"input.csv"});
+
+    // Destinations and created files are not expected to exist
+    EXPECT_TRUE(unknown("cp main.py backup.py").empty());
+    EXPECT_TRUE(unknown("touch notes.md && mkdir docs/api").empty());
+    EXPECT_TRUE(unknown("ping example.com").empty());
+    EXPECT_TRUE(unknown("git commit -m \"update README.md\"").empty());
+    EXPECT_TRUE(unknown("cat /etc/hosts ../other.txt").empty());
+}
+
+TEST_F(DirectoryCacheTest, InotifyKeepsListingCurrent) {
+    create_file("keep.txt", "1");
+    create_file("gone.txt");
+
+    std::atomic<int> changes{0};
+    DirectoryCache cache;
+    cache.set_change_callback([&changes](const std::string&, const std::string&) { ++changes; });
+    auto first = cache.load(temp_dir_);
+    ASSERT_NE(first, nullptr);
+
+    // Probe whether inotify works here before asserting on it
+    create_file("probe.txt");
+    if (!eventually(cache, temp_dir_, [](const auto& l) { return l.find("probe.txt") != nullptr; })) {
+        GTEST_SKIP() << "inotify unavailable";
+    }
+
+    create_file("new.txt");
+    fs::remove(temp_dir_ + "/gone.txt");
+    create_file("keep.txt", "12345");
+
+    EXPECT_TRUE(eventually(cache, temp_dir_, [](const DirectoryCache::Listing& l) {
+        return l.find("new.txt") && !l.find("gone.txt") && l.find("keep.txt")->size == 5;
+    }));
+    EXPECT_GT(changes, 0);
+    // Readers holding the old snapshot still see it unchanged
+    EXPECT_NE(first->find("gone.txt"), nullptr);
+    // A watched directory is served from memory
+    EXPECT_EQ(cache.load(temp_dir_), cache.get(temp_dir_));
+}
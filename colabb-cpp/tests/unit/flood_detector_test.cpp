@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/flood_detector.hpp"
+
+using colabb::infrastructure::FloodDetector;
+using namespace std::chrono_literals;
+
+TEST(FloodDetectorTest, InteractiveOutputIsNotAFlood) {
+    FloodDetector detector(100 * 1024);
+    auto now = FloodDetector::Clock::time_point{} + 1h;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_FALSE(detector.record(2048, now)); // 2 KiB every 50 ms = 40 KiB/s
+        now += 50ms;
+    }
+}
+
+TEST(FloodDetectorTest, FloodStartsAndDecaysWithHysteresis) {
+    FloodDetector detector(100 * 1024);
+    auto now = FloodDetector::Clock::time_point{} + 1h;
+    EXPECT_FALSE(detector.record(64 * 1024, now));
+    EXPECT_TRUE(detector.record(64 * 1024, now + 10ms));
+    EXPECT_GT(detector.bytes_per_second(), 100u * 1024);
+
+    // Still above half the threshold half a second later
+    EXPECT_TRUE(detector.record(40 * 1024, now + 500ms));
+    // No output at all: the window empties and the flood ends
+    EXPECT_FALSE(detector.update(now + 1600ms));
+    EXPECT_EQ(detector.bytes_per_second(), 0u);
+
+    detector.record(1 << 20, now + 2s);
+    EXPECT_TRUE(detector.flooding());
+    detector.reset();
+    EXPECT_FALSE(detector.flooding());
+}
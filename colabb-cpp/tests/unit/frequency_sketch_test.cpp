@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include "application/frequency_sketch.hpp"
+#include <string>
+
+using namespace colabb::application;
+
+TEST(FrequencySketchTest, CountsIncrements) {
+    FrequencySketch sketch(64);
+    for (int i = 0; i < 5; ++i) {
+        sketch.increment("git status");
+    }
+    sketch.increment("ls -la");
+
+    EXPECT_EQ(sketch.frequency("git status"), 5);
+    EXPECT_EQ(sketch.frequency("ls -la"), 1);
+    EXPECT_EQ(sketch.frequency("never seen"), 0);
+}
+
+TEST(FrequencySketchTest, SaturatesAtFifteen) {
+    FrequencySketch sketch(64);
+    for (int i = 0; i < 40; ++i) {
+        sketch.increment("hot");
+    }
+    EXPECT_EQ(sketch.frequency("hot"), 15);
+}
+
+TEST(FrequencySketchTest, AgingHalvesCounters) {
+    // 16 expected entries -> aging every 160 recorded increments
+    FrequencySketch sketch(16);
+    for (int i = 0; i < 15; ++i) {
+        sketch.increment("hot");
+    }
+    ASSERT_EQ(sketch.frequency("hot"), 15);
+
+    for (int i = 0; sketch.resets() == 0 && i < 1000; ++i) {
+        sketch.increment("noise" + std::to_string(i));
+    }
+
+    EXPECT_EQ(sketch.resets(), 1u);
+    // Saturated counters are at most 7 after halving, whatever the noise hit
+    EXPECT_LE(sketch.frequency("hot"), 7);
+}
+
+TEST(FrequencySketchTest, ClearResetsCounts) {
+    FrequencySketch sketch(16);
+    sketch.increment("a");
+    sketch.clear();
+    EXPECT_EQ(sketch.frequency("a"), 0);
+}
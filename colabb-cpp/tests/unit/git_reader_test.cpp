@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "infrastructure/context/git_reader.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace colabb::infrastructure;
+
+class GitReaderTest : public ::testing::Test {
+protected:
+    std::string temp_dir_;
+
+    void SetUp() override {
+        temp_dir_ = "/tmp/colabb_test_git_" + std::to_string(std::rand());
+        fs::create_directories(temp_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(temp_dir_);
+    }
+
+    void write(const std::string& name, const std::string& content) {
+        fs::create_directories(fs::path(temp_dir_ + "/" + name).parent_path());
+        std::ofstream f(temp_dir_ + "/" + name);
+        f << content;
+    }
+
+    // Runs git in the repo; the tests needing real objects skip without it
+    bool git(const std::string& args) {
+        const std::string cmd = "git -C " + temp_dir_ + "/repo -c user.name=t -c user.email=t@t "
+                                "-c init.defaultBranch=main -c commit.gpgsign=false " + args +
+                                " >/dev/null 2>&1";
+        return std::system(cmd.c_str()) == 0;
+    }
+
+    // git's first output line, e.g. for rev-parse
+    std::string git_output(const std::string& args) {
+        const std::string cmd = "git -C " + temp_dir_ + "/repo " + args + " 2>/dev/null";
+        std::string out;
+        if (FILE* pipe = popen(cmd.c_str(), "r")) {
+            char line[256];
+            if (fgets(line, sizeof(line), pipe)) out = line;
+            pclose(pipe);
+        }
+        while (!out.empty() && out.back() == '\n') out.pop_back();
+        return out;
+    }
+
+    // Deletes a loose object, as if missing from a partial clone
+    void remove_object(const std::string& sha) {
+        fs::remove(temp_dir_ + "/repo/.git/objects/" + sha.substr(0, 2) + "/" + sha.substr(2));
+    }
+
+    bool make_repo() {
+        fs::create_directories(temp_dir_ + "/repo");
+        return git("init -q");
+    }
+};
+
+const std::string kShaA = "1111111111111111111111111111111111111111";
+const std::string kShaB = "2222222222222222222222222222222222222222";
+
+TEST_F(GitReaderTest, NotARepository) {
+    GitReader reader;
+    EXPECT_FALSE(reader.read(temp_dir_).is_repo);
+}
+
+TEST_F(GitReaderTest, ResolvesLooseBeforePackedRefs) {
+    write(".git/HEAD", "ref: refs/heads/main\n");
+    write(".git/packed-refs", "# pack-refs with: peeled\n" + kShaA + " refs/heads/main\n" +
+                              kShaB + " refs/heads/other\n");
+    auto layout = GitReader::locate(temp_dir_);
+    ASSERT_TRUE(layout.has_value());
+
+    EXPECT_EQ(GitReader::resolve_ref(*layout, "HEAD"), kShaA);
+    EXPECT_EQ(GitReader::resolve_ref(*layout, "refs/heads/other"), kShaB);
+
+    write(".git/refs/heads/main", kShaB + "\n");
+    EXPECT_EQ(GitReader::resolve_ref(*layout, "HEAD"), kShaB);
+    EXPECT_EQ(GitReader::resolve_ref(*layout, "refs/heads/missing"), "");
+}
+
+TEST_F(GitReaderTest, FollowsWorktreeGitdirFile) {
+    write("main/.git/HEAD", "ref: refs/heads/main\n");
+    write("main/.git/packed-refs", kShaA + " refs/heads/feature\n");
+    write("main/.git/worktrees/wt/HEAD", "ref: refs/heads/feature\n");
+    write("main/.git/worktrees/wt/commondir", "../..\n");
+    write("wt/.git", "gitdir: ../main/.git/worktrees/wt\n");
+
+    auto layout = GitReader::locate(temp_dir_ + "/wt");
+    ASSERT_TRUE(layout.has_value());
+    EXPECT_EQ(layout->git_dir, temp_dir_ + "/main/.git/worktrees/wt");
+    EXPECT_EQ(layout->common_dir, temp_dir_ + "/main/.git");
+
+    GitReader reader;
+    auto status = reader.read(temp_dir_ + "/wt");
+    EXPECT_TRUE(status.is_repo);
+    EXPECT_EQ(status.branch, "feature");
+    EXPECT_EQ(status.head, kShaA);
+}
+
+TEST_F(GitReaderTest, DetachedHead) {
+    write(".git/HEAD", kShaA + "\n");
+    GitReader reader;
+    auto status = reader.read(temp_dir_);
+    EXPECT_TRUE(status.branch.empty());
+    EXPECT_EQ(status.head, kShaA);
+}
+
+TEST_F(GitReaderTest, CountsStagedAndModified) {
+    if (!make_repo()) GTEST_SKIP() << "git unavailable";
+    write("repo/a.txt", "a\n");
+    write("repo/b.txt", "b\n");
+    write("repo/dir/c.txt", "c\n");
+    ASSERT_TRUE(git("add -A") && git("commit -q -m init"));
+
+    GitReader reader;
+    auto clean = reader.read(temp_dir_ + "/repo");
+    EXPECT_EQ(clean.branch, "main");
+    EXPECT_EQ(clean.staged, 0);
+    EXPECT_EQ(clean.modified, 0);
+
+    write("repo/new.txt", "new\n");
+    ASSERT_TRUE(git("add new.txt") && git("rm -q b.txt"));
+    // Keep the size different so the stat comparison sees the edit
+    write("repo/dir/c.txt", "changed\n");
+
+    auto dirty = reader.read(temp_dir_ + "/repo");
+    EXPECT_EQ(dirty.staged, 2);   // new.txt added, b.txt deleted
+    EXPECT_EQ(dirty.modified, 1); // dir/c.txt
+}
+
+TEST_F(GitReaderTest, UnchangedSubtreesAreNotRead) {
+    if (!make_repo()) GTEST_SKIP() << "git unavailable";
+    write("repo/a/x.txt", "x\n");
+    write("repo/b/deep/y.txt", "y\n");
+    ASSERT_TRUE(git("add -A") && git("commit -q -m init"));
+    const std::string b_tree = git_output("rev-parse HEAD:b");
+    ASSERT_EQ(b_tree.size(), 40u);
+
+    // The index's cache-tree still matches b/, so its tree is never needed
+    write("repo/a/x.txt", "x changed\n");
+    ASSERT_TRUE(git("add a/x.txt"));
+    remove_object(b_tree);
+
+    GitReader reader;
+    auto status = reader.read(temp_dir_ + "/repo");
+    EXPECT_EQ(status.staged, 1);
+    EXPECT_EQ(status.modified, 0);
+}
+
+TEST_F(GitReaderTest, UnreadableTreeLeavesStagedUnknown) {
+    if (!make_repo()) GTEST_SKIP() << "git unavailable";
+    write("repo/a/x.txt", "x\n");
+    write("repo/b.txt", "b\n");
+    ASSERT_TRUE(git("add -A") && git("commit -q -m init"));
+    const std::string a_tree = git_output("rev-parse HEAD:a");
+    ASSERT_EQ(a_tree.size(), 40u);
+
+    write("repo/a/x.txt", "x changed\n");
+    ASSERT_TRUE(git("add a/x.txt"));
+    remove_object(a_tree);
+
+    GitReader reader;
+    EXPECT_EQ(reader.read(temp_dir_ + "/repo").staged, -1);
+}
+
+TEST_F(GitReaderTest, AheadBehindLooseAndPacked) {
+    if (!make_repo()) GTEST_SKIP() << "git unavailable";
+    write("repo/f.txt", "1\n");
+    ASSERT_TRUE(git("add -A") && git("commit -q -m c1") && git("branch base"));
+    for (int i = 2; i <= 3; ++i) {
+        write("repo/f.txt", std::to_string(i) + "\n");
+        ASSERT_TRUE(git("commit -q -am c" + std::to_string(i)));
+    }
+    ASSERT_TRUE(git("checkout -q base"));
+    write("repo/g.txt", "g\n");
+    ASSERT_TRUE(git("add -A") && git("commit -q -m other") && git("checkout -q main"));
+    ASSERT_TRUE(git("config branch.main.remote .") && git("config branch.main.merge refs/heads/base"));
+
+    {
+        GitReader reader;
+        auto status = reader.read(temp_dir_ + "/repo");
+        EXPECT_EQ(status.upstream, "refs/heads/base");
+        EXPECT_EQ(status.ahead, 2);
+        EXPECT_EQ(status.behind, 1);
+    }
+
+    // Same answer once everything lives in a (deltified) pack
+    ASSERT_TRUE(git("gc -q --aggressive"));
+    GitReader reader;
+    auto status = reader.read(temp_dir_ + "/repo");
+    EXPECT_EQ(status.ahead, 2);
+    EXPECT_EQ(status.behind, 1);
+    EXPECT_EQ(status.staged, 0);
+}
+
+TEST_F(GitReaderTest, CachedUntilRefsChange) {
+    if (!make_repo()) GTEST_SKIP() << "git unavailable";
+    write("repo/f.txt", "1\n");
+    ASSERT_TRUE(git("add -A") && git("commit -q -m c1"));
+
+    GitReader reader;
+    const std::string first = reader.read(temp_dir_ + "/repo").head;
+    ASSERT_FALSE(first.empty());
+
+    // mtime granularity: make sure the ref rewrite gets a new stamp
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    write("repo/f.txt", "2\n");
+    ASSERT_TRUE(git("commit -q -am c2"));
+    EXPECT_NE(reader.read(temp_dir_ + "/repo").head, first);
+}
+
+TEST_F(GitReaderTest, WorktreeEditsSeenAfterTtl) {
+    if (!make_repo()) GTEST_SKIP() << "git unavailable";
+    write("repo/f.txt", "1\n");
+    ASSERT_TRUE(git("add -A") && git("commit -q -m c1"));
+
+    GitReader reader;
+    reader.set_worktree_ttl(std::chrono::milliseconds(20));
+    EXPECT_EQ(reader.read(temp_dir_ + "/repo").modified, 0);
+
+    // No .git file changes: only the TTL brings the edit in
+    write("repo/f.txt", "edited\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_EQ(reader.read(temp_dir_ + "/repo").modified, 1);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "infrastructure/context/language_scanner.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+using namespace colabb::infrastructure;
+
+class LanguageScannerTest : public ::testing::Test {
+protected:
+    std::string temp_dir_;
+
+    void SetUp() override {
+        temp_dir_ = "/tmp/colabb_test_scanner_" + std::to_string(std::rand());
+        fs::create_directories(temp_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(temp_dir_);
+    }
+
+    void create_file(const std::string& name, const std::string& content = "") {
+        fs::create_directories(fs::path(temp_dir_ + "/" + name).parent_path());
+        std::ofstream f(temp_dir_ + "/" + name);
+        f << content;
+    }
+
+    static bool contains(const std::vector<std::string>& names, const std::string& name) {
+        return std::find(names.begin(), names.end(), name) != names.end();
+    }
+};
+
+TEST_F(LanguageScannerTest, WeightsByExtension) {
+    create_file("src/a.cpp");
+    create_file("src/b.cpp");
+    create_file("tools/run.sh");
+
+    auto result = LanguageScanner().scan(temp_dir_);
+    ASSERT_FALSE(result.scores.empty());
+    EXPECT_EQ(result.scores[0].first, "C/C++");
+    EXPECT_FALSE(result.partial);
+
+    // Shell scores 0.3 against 2.0 for the sources
+    EXPECT_TRUE(contains(result.languages(0.1), "Shell"));
+    EXPECT_FALSE(contains(result.languages(0.2), "Shell"));
+}
+
+TEST_F(LanguageScannerTest, RespectsDepth) {
+    create_file("main.go");
+    create_file("a/b/c/deep.rs");
+
+    LanguageScanner::Options options;
+    options.max_depth = 1;
+    auto names = LanguageScanner(options).scan(temp_dir_).languages(0.0);
+    EXPECT_TRUE(contains(names, "Go"));
+    EXPECT_FALSE(contains(names, "Rust"));
+
+    options.max_depth = 3;
+    EXPECT_TRUE(contains(LanguageScanner(options).scan(temp_dir_).languages(0.0), "Rust"));
+}
+
+TEST_F(LanguageScannerTest, FollowsGitignore) {
+    create_file(".gitignore", "build/\n*.py\n!keep.py\n");
+    create_file("build/gen.rs");
+    create_file("script.py");
+    create_file("lib/keep.py");
+    create_file("lib/vendor/.gitignore", "*.java\n");
+    create_file("lib/vendor/x.java");
+
+    auto result = LanguageScanner().scan(temp_dir_);
+    auto names = result.languages(0.0);
+    EXPECT_FALSE(contains(names, "Rust"));
+    EXPECT_FALSE(contains(names, "Java"));
+    ASSERT_EQ(result.scores.size(), 1u);
+    EXPECT_EQ(result.scores[0].first, "Python");
+    EXPECT_DOUBLE_EQ(result.scores[0].second, 1.0); // keep.py only
+}
+
+TEST_F(LanguageScannerTest, EntryBudgetGivesPartialResult) {
+    for (int i = 0; i < 50; ++i) {
+        create_file("f" + std::to_string(i) + ".ts");
+    }
+
+    LanguageScanner::Options options;
+    options.max_entries = 10;
+    auto result = LanguageScanner(options).scan(temp_dir_);
+    EXPECT_TRUE(result.partial);
+    EXPECT_EQ(result.entries_scanned, 10u);
+    EXPECT_TRUE(contains(result.languages(0.1), "JavaScript/TypeScript"));
+}
+
+TEST_F(LanguageScannerTest, IgnoreRuleMatching) {
+    LanguageScanner::IgnoreRules rules;
+    rules.parse("# comment\n/out\ndocs/*.md\n**/cache/\nlogs/**\n");
+
+    EXPECT_EQ(rules.match("out", true), 1);
+    EXPECT_EQ(rules.match("src/out", true), -1); // anchored to the root
+    EXPECT_EQ(rules.match("docs/a.md", false), 1);
+    EXPECT_EQ(rules.match("docs/sub/a.md", false), -1);
+    EXPECT_EQ(rules.match("a/b/cache", true), 1);
+    EXPECT_EQ(rules.match("a/b/cache", false), -1); // directory-only
+    EXPECT_EQ(rules.match("logs/2024/x.txt", false), 1);
+}
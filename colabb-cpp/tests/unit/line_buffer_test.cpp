@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/line_buffer.hpp"
+
+using colabb::infrastructure::LineBuffer;
+
+TEST(LineBufferTest, LastLinesIsOneSpan) {
+    LineBuffer buffer(1024);
+    EXPECT_EQ(buffer.last_lines(5), "");
+
+    buffer.append("$ ls\nmain.c\n");
+    buffer.append("Makefile\n");
+    buffer.append("$ make"); // newline added
+    EXPECT_EQ(buffer.line_count(), 4u);
+    EXPECT_EQ(buffer.last_lines(2), "Makefile\n$ make\n");
+    EXPECT_EQ(buffer.last_lines(100), "$ ls\nmain.c\nMakefile\n$ make\n");
+    EXPECT_EQ(buffer.line(1), "main.c");
+    EXPECT_EQ(buffer.line(4), "");
+
+    buffer.append("\n\n");
+    EXPECT_EQ(buffer.line_count(), 6u);
+    EXPECT_EQ(buffer.line(5), "");
+}
+
+TEST(LineBufferTest, DropsOldestLinesOverCapacity) {
+    LineBuffer buffer(20);
+    for (int i = 0; i < 1000; ++i) {
+        buffer.append("line " + std::to_string(i) + "\n");
+        ASSERT_LE(buffer.size(), 20u);
+    }
+    EXPECT_EQ(buffer.total_lines(), 1000u);
+    EXPECT_EQ(buffer.last_lines(2), "line 998\nline 999\n");
+    EXPECT_EQ(buffer.line(buffer.line_count() - 1), "line 999");
+
+    // A line longer than the capacity is still kept on its own
+    buffer.append(std::string(40, 'x') + "\n");
+    EXPECT_EQ(buffer.line_count(), 1u);
+    EXPECT_EQ(buffer.last_lines(3).size(), 41u);
+
+    buffer.clear();
+    EXPECT_EQ(buffer.line_count(), 0u);
+    buffer.append("after\n");
+    EXPECT_EQ(buffer.last_lines(1), "after\n");
+}
+
+TEST(LineBufferTest, SpanByAbsoluteLineNumber) {
+    LineBuffer buffer(10);
+    buffer.append("a\nb\nc\n");
+    EXPECT_EQ(buffer.span(1, 3), "b\nc\n");
+    EXPECT_EQ(buffer.span(2, 100), "c\n");
+
+    buffer.append("dddd\neeee\n"); // a, b and c no longer fit
+    EXPECT_EQ(buffer.total_lines(), 5u);
+    EXPECT_EQ(buffer.span(0, 4), "dddd\n");
+    EXPECT_EQ(buffer.span(0, 2), "");
+}
+
+TEST(LineBufferTest, HandsDroppedLinesToEvictionHandler) {
+    LineBuffer buffer(10);
+    std::string evicted;
+    std::vector<std::uint64_t> first_lines;
+    buffer.set_eviction_handler([&](std::string_view lines, std::uint64_t first_line) {
+        evicted.append(lines.data(), lines.size());
+        first_lines.push_back(first_line);
+    });
+
+    buffer.append("a\nb\nc\n");
+    EXPECT_TRUE(evicted.empty());
+    buffer.append("dddd\neeee\n");
+    EXPECT_EQ(evicted, "a\nb\nc\n");
+    buffer.append("ffff\n");
+    EXPECT_EQ(evicted, "a\nb\nc\ndddd\n");
+    EXPECT_EQ(first_lines, (std::vector<std::uint64_t>{0, 3}));
+
+    buffer.clear(); // discarded, not evicted
+    EXPECT_EQ(evicted, "a\nb\nc\ndddd\n");
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "infrastructure/memory/memory_governor.hpp"
+#include <string>
+#include <vector>
+
+using namespace colabb::infrastructure;
+
+namespace {
+struct FakeComponent {
+    size_t bytes;
+    size_t trim(size_t target) {
+        if (bytes <= target) return 0;
+        size_t freed = bytes - target;
+        bytes = target;
+        return freed;
+    }
+};
+}
+
+class MemoryGovernorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // Keep host memory pressure out of the picture
+        governor_.set_rss_limit(0);
+        governor_.set_psi_threshold(1000.0);
+    }
+
+    MemoryGovernor governor_{1000};
+};
+
+TEST_F(MemoryGovernorTest, ReportsPerComponentUsage) {
+    FakeComponent a{300}, b{200};
+    governor_.register_component("a", 1, [&a] { return a.bytes; }, [&a](size_t t) { return a.trim(t); });
+    governor_.register_component("b", 0, [&b] { return b.bytes; }, [&b](size_t t) { return b.trim(t); });
+
+    auto report = governor_.report();
+    ASSERT_EQ(report.size(), 2u);
+    EXPECT_EQ(report[0].name, "b");
+    EXPECT_EQ(report[0].bytes, 200u);
+    EXPECT_EQ(governor_.total_usage(), 500u);
+}
+
+TEST_F(MemoryGovernorTest, TrimsInPriorityOrder) {
+    FakeComponent scrollback{600}, context{300}, suggestions{400};
+    governor_.register_component("suggestions", 2, [&] { return suggestions.bytes; },
+                                 [&](size_t t) { return suggestions.trim(t); });
+    governor_.register_component("scrollback", 0, [&] { return scrollback.bytes; },
+                                 [&](size_t t) { return scrollback.trim(t); });
+    governor_.register_component("context", 1, [&] { return context.bytes; },
+                                 [&](size_t t) { return context.trim(t); });
+
+    // 1300 bytes against a 1000 budget: only the lowest priority gives way
+    EXPECT_EQ(governor_.enforce(), 300u);
+    EXPECT_EQ(scrollback.bytes, 300u);
+    EXPECT_EQ(context.bytes, 300u);
+    EXPECT_EQ(suggestions.bytes, 400u);
+
+    // Shrinking the budget cascades to the next component
+    governor_.set_budget(500);
+    governor_.enforce();
+    EXPECT_EQ(scrollback.bytes, 0u);
+    EXPECT_EQ(context.bytes, 100u);
+    EXPECT_EQ(suggestions.bytes, 400u);
+}
+
+TEST_F(MemoryGovernorTest, ReservationsExtendTheBudget) {
+    FakeComponent scrollback{2500}, cache{400};
+    size_t reserved = 2000;
+    governor_.register_component("scrollback", 0, [&] { return scrollback.bytes; },
+                                 [&](size_t t) { return scrollback.trim(t); }, [&] { return reserved; });
+    governor_.register_component("cache", 1, [&] { return cache.bytes; },
+                                 [&](size_t t) { return cache.trim(t); });
+    EXPECT_EQ(governor_.effective_budget(), 3000u);
+
+    // 2900 bytes fit the 1000 budget plus the 2000 reserved
+    EXPECT_EQ(governor_.enforce(), 0u);
+    EXPECT_EQ(scrollback.bytes, 2500u);
+
+    // Closing a tab gives its reservation back
+    reserved = 1000;
+    EXPECT_EQ(governor_.enforce(), 900u);
+    EXPECT_EQ(scrollback.bytes, 1600u);
+}
+
+TEST_F(MemoryGovernorTest, UnregisterRemovesComponent) {
+    FakeComponent a{5000};
+    auto id = governor_.register_component("a", 0, [&a] { return a.bytes; },
+                                           [&a](size_t t) { return a.trim(t); });
+    governor_.unregister_component(id);
+    EXPECT_EQ(governor_.enforce(), 0u);
+    EXPECT_EQ(a.bytes, 5000u);
+}
+
+TEST(MemoryGovernorParseTest, Statm) {
+    EXPECT_EQ(MemoryGovernor::parse_statm_rss_pages("10562 2345 812 180 0 4211 0\n"), 2345u);
+    EXPECT_FALSE(MemoryGovernor::parse_statm_rss_pages("").has_value());
+}
+
+TEST(MemoryGovernorParseTest, Psi) {
+    const std::string psi =
+        "some avg10=12.50 avg60=3.00 avg300=1.00 total=12345\n"
+        "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n";
+    auto avg10 = MemoryGovernor::parse_psi_some_avg10(psi);
+    ASSERT_TRUE(avg10.has_value());
+    EXPECT_DOUBLE_EQ(*avg10, 12.5);
+    EXPECT_FALSE(MemoryGovernor::parse_psi_some_avg10("").has_value());
+}
+
+TEST_F(MemoryGovernorTest, ReservedBytesGoOnlyUnderPressure) {
+    FakeComponent scrollback{2000}, cache{1500};
+    governor_.register_component("scrollback", 0, [&] { return scrollback.bytes; },
+                                 [&](size_t t) { return scrollback.trim(t); }, [] { return size_t{2000}; });
+    governor_.register_component("cache", 1, [&] { return cache.bytes; },
+                                 [&](size_t t) { return cache.trim(t); });
+
+    // The cache overflows the budget; the reserved scrollback is kept even
+    // though it sorts first
+    EXPECT_EQ(governor_.enforce(), 500u);
+    EXPECT_EQ(scrollback.bytes, 2000u);
+    EXPECT_EQ(cache.bytes, 1000u);
+
+    // Any RSS is over a 1 byte limit: the target halves to 1500 and the
+    // reservation no longer protects it
+    governor_.set_rss_limit(1);
+    EXPECT_EQ(governor_.enforce(), 1500u);
+    EXPECT_EQ(scrollback.bytes, 500u);
+    EXPECT_EQ(cache.bytes, 1000u);
+}
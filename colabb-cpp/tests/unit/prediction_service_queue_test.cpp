@@ -14,7 +14,7 @@ using namespace colabb::application;
 // Fake provider that would normally perform a prediction. For this test it won't be used.
 class FakeProvider : public IAIProvider {
 public:
-    std::optional<Suggestion> predict(const std::string& prompt, const std::string& context = "") override {
+    std::optional<Suggestion> predict(const std::string&, const std::string& = "") override {
         return Suggestion("fake_cmd", "fake", 1.0f);
     }
     bool validate_connection() override { return true; }
@@ -35,3 +35,124 @@ TEST(PredictionServiceQueueTest, RejectsWhenMaxQueueZero) {
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
     EXPECT_TRUE(called.load());
 }
+
+TEST(PredictionServiceQueueTest, BackgroundRequestsSurviveCancel) {
+    auto provider = std::make_unique<FakeProvider>();
+    PredictionService svc(std::move(provider), 4);
+
+    std::atomic<bool> called{false};
+    svc.predict_async("q", "c", [&called](std::optional<Suggestion> s) {
+        EXPECT_TRUE(s.has_value());
+        called = true;
+    }, PredictionService::Priority::Background);
+    svc.cancel_pending();
+
+    for (int i = 0; i < 100 && !called.load(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_TRUE(called.load());
+}
+
+class FailingProvider : public IAIProvider {
+public:
+    std::optional<Suggestion> predict(const std::string&, const std::string& = "") override {
+        throw ProviderError("HTTP 503");
+    }
+    bool validate_connection() override { return false; }
+};
+
+class EmptyProvider : public IAIProvider {
+public:
+    std::optional<Suggestion> predict(const std::string&, const std::string& = "") override {
+        return std::nullopt;
+    }
+    bool validate_connection() override { return true; }
+};
+
+static PredictionService::Outcome wait_for_outcome(PredictionService& svc) {
+    std::atomic<int> outcome{-1};
+    svc.predict_async("q", "c", [&outcome](std::optional<Suggestion>, PredictionService::Outcome o) {
+        outcome = static_cast<int>(o);
+    });
+    for (int i = 0; i < 100 && outcome.load() < 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return static_cast<PredictionService::Outcome>(outcome.load());
+}
+
+TEST(PredictionServiceQueueTest, ReportsOutcomeKinds) {
+    PredictionService ok(std::make_unique<FakeProvider>(), 4);
+    EXPECT_EQ(wait_for_outcome(ok), PredictionService::Outcome::Suggested);
+
+    PredictionService empty(std::make_unique<EmptyProvider>(), 4);
+    EXPECT_EQ(wait_for_outcome(empty), PredictionService::Outcome::Empty);
+
+    PredictionService failing(std::make_unique<FailingProvider>(), 4);
+    EXPECT_EQ(wait_for_outcome(failing), PredictionService::Outcome::Failed);
+
+    PredictionService full(std::make_unique<FakeProvider>(), 0);
+    EXPECT_EQ(wait_for_outcome(full), PredictionService::Outcome::Rejected);
+}
+
+class SlowProvider : public IAIProvider {
+public:
+    std::optional<Suggestion> predict(const std::string& prompt, const std::string& = "") override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        return Suggestion(prompt);
+    }
+    bool validate_connection() override { return true; }
+};
+
+TEST(PredictionServiceQueueTest, CancelPendingOnlyAffectsOwner) {
+    PredictionService svc(std::make_unique<SlowProvider>(), 8);
+
+    std::atomic<int> owner1_done{0};
+    std::atomic<int> owner2_done{0};
+    // The first request occupies the worker while the rest stay queued
+    svc.predict_async("busy", "", [](std::optional<Suggestion>) {},
+                      PredictionService::Priority::Interactive, 1);
+    for (int i = 0; i < 2; ++i) {
+        svc.predict_async("a", "", [&owner1_done](std::optional<Suggestion>) { ++owner1_done; },
+                          PredictionService::Priority::Interactive, 1);
+        svc.predict_async("b", "", [&owner2_done](std::optional<Suggestion>) { ++owner2_done; },
+                          PredictionService::Priority::Interactive, 2);
+    }
+    svc.cancel_pending(1);
+
+    for (int i = 0; i < 100 && owner2_done.load() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(owner1_done.load(), 0);
+    EXPECT_EQ(owner2_done.load(), 2);
+}
+
+TEST(PredictionServiceQueueTest, CancelPendingForOwnerDropsItsBackgroundRequests) {
+    PredictionService svc(std::make_unique<SlowProvider>(), 8);
+
+    std::atomic<int> owner1_rejected{0};
+    std::atomic<int> owner2_done{0};
+    svc.predict_async("busy", "", [](std::optional<Suggestion>) {},
+                      PredictionService::Priority::Interactive, 1);
+    svc.predict_async("a", "", [&owner1_rejected](std::optional<Suggestion> s, PredictionService::Outcome o) {
+        EXPECT_FALSE(s.has_value());
+        if (o == PredictionService::Outcome::Rejected) ++owner1_rejected;
+    }, PredictionService::Priority::Background, 1);
+    svc.predict_async("b", "", [&owner2_done](std::optional<Suggestion>) { ++owner2_done; },
+                      PredictionService::Priority::Background, 2);
+    svc.cancel_pending(1);
+    EXPECT_EQ(owner1_rejected.load(), 1);
+
+    for (int i = 0; i < 100 && owner2_done.load() < 1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(owner2_done.load(), 1);
+    EXPECT_EQ(owner1_rejected.load(), 1);
+}
+
+TEST(PredictionServiceQueueTest, SetProviderSwapsBackend) {
+    PredictionService svc(std::make_unique<EmptyProvider>(), 4);
+    EXPECT_EQ(wait_for_outcome(svc), PredictionService::Outcome::Empty);
+
+    svc.set_provider(std::make_unique<FakeProvider>());
+    EXPECT_EQ(wait_for_outcome(svc), PredictionService::Outcome::Suggested);
+}
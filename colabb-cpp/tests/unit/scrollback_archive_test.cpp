@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/scrollback_archive.hpp"
+
+using colabb::infrastructure::ScrollbackArchive;
+
+namespace {
+
+// Lines [first, first + count) as a LineBuffer would evict them
+std::string numbered_lines(std::uint64_t first, std::uint64_t count) {
+    std::string lines;
+    for (std::uint64_t i = first; i < first + count; ++i) {
+        lines += "build step " + std::to_string(i) + ": compiling module_" + std::to_string(i % 97) + ".cpp\n";
+    }
+    return lines;
+}
+
+} // namespace
+
+TEST(ScrollbackArchiveTest, PagesBackLinesAcrossBlocks) {
+    ScrollbackArchive archive(64 * 1024 * 1024, testing::TempDir());
+    for (std::uint64_t first = 0; first < 20000; first += 500) {
+        archive.append(numbered_lines(first, 500), first);
+    }
+    EXPECT_EQ(archive.first_line(), 0u);
+    EXPECT_EQ(archive.end_line(), 20000u);
+    EXPECT_TRUE(archive.on_disk());
+
+    // Compressed well below the raw size, with little kept in memory
+    EXPECT_GT(archive.stored_bytes(), 0u);
+    EXPECT_LT(archive.stored_bytes() * 4, archive.raw_bytes());
+    EXPECT_LT(archive.memory_bytes(), 4 * ScrollbackArchive::kBlockSize);
+
+    EXPECT_EQ(archive.read(0, 2), numbered_lines(0, 2));
+    EXPECT_EQ(archive.read(9000, 9003), numbered_lines(9000, 3));
+    EXPECT_EQ(archive.read(100, 19999), numbered_lines(100, 19899)); // blocks and open block
+    EXPECT_EQ(archive.read(19998, 50000), numbered_lines(19998, 2));
+    EXPECT_EQ(archive.read(30000, 30001), "");
+}
+
+TEST(ScrollbackArchiveTest, DropsOldestBlocksOverBudget) {
+    ScrollbackArchive archive(16 * 1024, testing::TempDir());
+    for (std::uint64_t first = 0; first < 100000; first += 1000) {
+        archive.append(numbered_lines(first, 1000), first);
+        ASSERT_LE(archive.stored_bytes(), 32u * 1024);
+    }
+    EXPECT_GT(archive.first_line(), 0u);
+    EXPECT_EQ(archive.end_line(), 100000u);
+    EXPECT_EQ(archive.read(0, 10), "");
+    EXPECT_EQ(archive.read(99990, 100000), numbered_lines(99990, 10));
+    EXPECT_EQ(archive.read(archive.first_line(), archive.first_line() + 1),
+              numbered_lines(archive.first_line(), 1));
+}
+
+TEST(ScrollbackArchiveTest, SearchesNewestFirst) {
+    ScrollbackArchive archive(64 * 1024 * 1024, testing::TempDir());
+    archive.append(numbered_lines(0, 3000), 0);
+    archive.append("Segmentation fault (core dumped)\n", 3000);
+    archive.append(numbered_lines(3001, 3000), 3001);
+    archive.append("segmentation FAULT again\n", 6001);
+
+    auto matches = archive.search("segmentation fault", false, 10);
+    ASSERT_EQ(matches.size(), 2u);
+    EXPECT_EQ(matches[0].line, 6001u);
+    EXPECT_EQ(matches[0].text, "segmentation FAULT again");
+    EXPECT_EQ(matches[1].line, 3000u);
+    EXPECT_EQ(matches[1].text, "Segmentation fault (core dumped)");
+
+    matches = archive.search("Segmentation fault", true, 10);
+    ASSERT_EQ(matches.size(), 1u);
+    EXPECT_EQ(matches[0].line, 3000u);
+
+    matches = archive.search("build step 12", true, 3);
+    ASSERT_EQ(matches.size(), 3u);
+    EXPECT_EQ(matches[0].text.rfind("build step 12", 0), 0u);
+    EXPECT_GT(matches[0].line, matches[1].line);
+    EXPECT_TRUE(archive.search("no such text", false, 10).empty());
+}
+
+TEST(ScrollbackArchiveTest, KeepsBlocksInMemoryWithoutAFile) {
+    ScrollbackArchive archive(64 * 1024 * 1024, "/proc/colabb-no-such-dir");
+    archive.append(numbered_lines(0, 5000), 0);
+    EXPECT_FALSE(archive.on_disk());
+    EXPECT_EQ(archive.read(4000, 4002), numbered_lines(4000, 2));
+
+    archive.clear();
+    EXPECT_TRUE(archive.empty());
+    archive.append("fresh\n", 0);
+    EXPECT_EQ(archive.read(0, 1), "fresh\n");
+}
+
+TEST(ScrollbackArchiveTest, RestartedNumberingStartsOver) {
+    ScrollbackArchive archive(64 * 1024 * 1024, testing::TempDir());
+    archive.append(numbered_lines(0, 5000), 0);
+    archive.append("new session\n", 0);
+    EXPECT_EQ(archive.first_line(), 0u);
+    EXPECT_EQ(archive.end_line(), 1u);
+    EXPECT_EQ(archive.read(0, 10), "new session\n");
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/scrollback_search.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+using colabb::infrastructure::ScrollbackArchive;
+using colabb::infrastructure::ScrollbackSearch;
+using colabb::infrastructure::SearchChunk;
+
+namespace {
+
+std::string numbered_lines(std::uint64_t first, std::uint64_t count) {
+    std::string lines;
+    for (std::uint64_t i = first; i < first + count; ++i) {
+        lines += "step " + std::to_string(i) + ": linking module_" + std::to_string(i % 97) + ".o\n";
+    }
+    return lines;
+}
+
+SearchChunk text_chunk(size_t source, std::uint64_t first_line, std::string text) {
+    const auto lines = static_cast<std::uint64_t>(std::count(text.begin(), text.end(), '\n'));
+    return {source, first_line, first_line, first_line + lines,
+            std::make_shared<const std::string>(std::move(text)), std::nullopt};
+}
+
+// Collects a search's batches until it finishes
+class Collector {
+public:
+    ScrollbackSearch::ResultsCallback callback() {
+        return [this](std::uint64_t id, std::vector<ScrollbackSearch::Hit> hits, bool finished) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ids_.push_back(id);
+            for (auto& hit : hits) hits_.push_back(std::move(hit));
+            finished_ = finished_ || finished;
+            cv_.notify_all();
+        };
+    }
+
+    bool wait_finished() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return cv_.wait_for(lock, std::chrono::seconds(10), [this] { return finished_; });
+    }
+
+    std::vector<ScrollbackSearch::Hit> hits() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+
+    std::vector<std::uint64_t> ids() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ids_;
+    }
+
+    bool finished() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return finished_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<ScrollbackSearch::Hit> hits_;
+    std::vector<std::uint64_t> ids_;
+    bool finished_ = false;
+};
+
+} // namespace
+
+TEST(ScrollbackSearchTest, FindsLinesAcrossSourcesAndArchiveBlocks) {
+    ScrollbackArchive archive(64 * 1024 * 1024, testing::TempDir());
+    for (std::uint64_t first = 0; first < 5000; first += 500) {
+        std::string lines = numbered_lines(first, 500);
+        if (first == 1000) lines += "Segmentation fault (core dumped)\n";
+        archive.append(lines, first + (first > 1000 ? 1 : 0));
+    }
+    ASSERT_TRUE(archive.on_disk());
+    const std::uint64_t fault_line = 1500;
+
+    std::vector<SearchChunk> chunks;
+    chunks.push_back(text_chunk(0, 0, "ls\nsegmentation FAULT here\nok\n"));
+    for (auto& ref : archive.block_refs(0, archive.sealed_end())) {
+        const std::uint64_t first = ref.first_line;
+        const std::uint64_t end = ref.first_line + ref.line_count;
+        chunks.push_back({1, first, first, end, nullptr, std::move(ref)});
+    }
+    ASSERT_GT(chunks.size(), 2u);
+
+    ScrollbackSearch search(4);
+    Collector collector;
+    search.start(chunks, ScrollbackSearch::substring_matcher("Segmentation fault", true), 100,
+                 collector.callback());
+    ASSERT_TRUE(collector.wait_finished());
+    auto hits = collector.hits();
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].source, 1u);
+    EXPECT_EQ(hits[0].line, fault_line);
+    EXPECT_EQ(hits[0].text, "Segmentation fault (core dumped)");
+
+    // Case folding also finds the text chunk's line
+    Collector folded;
+    search.start(chunks, ScrollbackSearch::substring_matcher("segmentation fault", false), 100,
+                 folded.callback());
+    ASSERT_TRUE(folded.wait_finished());
+    hits = folded.hits();
+    ASSERT_EQ(hits.size(), 2u);
+    std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) { return a.source < b.source; });
+    EXPECT_EQ(hits[0].source, 0u);
+    EXPECT_EQ(hits[0].line, 1u);
+    EXPECT_EQ(hits[1].line, fault_line);
+}
+
+TEST(ScrollbackSearchTest, ReportsOnlyTheChunkRangeNewestFirst) {
+    SearchChunk chunk = text_chunk(3, 100, numbered_lines(100, 50));
+    chunk.begin = 110;
+    chunk.end = 120;
+
+    ScrollbackSearch search(2);
+    Collector collector;
+    search.start({chunk}, ScrollbackSearch::substring_matcher("linking", true), 100, collector.callback());
+    ASSERT_TRUE(collector.wait_finished());
+    const auto hits = collector.hits();
+    ASSERT_EQ(hits.size(), 10u);
+    EXPECT_EQ(hits.front().line, 119u);
+    EXPECT_EQ(hits.back().line, 110u);
+    EXPECT_EQ(hits.front().source, 3u);
+}
+
+TEST(ScrollbackSearchTest, StopsAtMaxHits) {
+    std::vector<SearchChunk> chunks;
+    for (std::uint64_t first = 0; first < 10000; first += 1000) {
+        chunks.push_back(text_chunk(0, first, numbered_lines(first, 1000)));
+    }
+
+    ScrollbackSearch search(4);
+    Collector collector;
+    search.start(chunks, ScrollbackSearch::substring_matcher("module_", true), 25, collector.callback());
+    ASSERT_TRUE(collector.wait_finished());
+    EXPECT_EQ(collector.hits().size(), 25u);
+}
+
+TEST(ScrollbackSearchTest, NewSearchCancelsThePreviousOne) {
+    std::vector<SearchChunk> chunks;
+    for (std::uint64_t first = 0; first < 200000; first += 1000) {
+        chunks.push_back(text_chunk(0, first, numbered_lines(first, 1000)));
+    }
+
+    ScrollbackSearch search(2);
+    Collector slow;
+    const auto first_id = search.start(chunks, [](std::string_view line) {
+        std::this_thread::sleep_for(std::chrono::microseconds(5));
+        return line.find("never") != std::string_view::npos;
+    }, 100, slow.callback());
+
+    Collector fast;
+    const auto second_id = search.start({text_chunk(0, 0, "needle\n")},
+                                        ScrollbackSearch::substring_matcher("needle", true), 100,
+                                        fast.callback());
+    EXPECT_NE(first_id, second_id);
+    ASSERT_TRUE(fast.wait_finished());
+    EXPECT_EQ(fast.hits().size(), 1u);
+    EXPECT_EQ(fast.ids(), std::vector<std::uint64_t>{second_id});
+
+    search.cancel();
+    EXPECT_FALSE(slow.finished());
+}
+
+TEST(ScrollbackSearchTest, FinishesAtOnceWithoutChunks) {
+    ScrollbackSearch search(2);
+    Collector collector;
+    search.start({}, ScrollbackSearch::substring_matcher("x", true), 10, collector.callback());
+    EXPECT_TRUE(collector.finished());
+    EXPECT_TRUE(collector.hits().empty());
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/session_log_cleaner.hpp"
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using colabb::infrastructure::SessionLogCleaner;
+
+namespace {
+
+void touch(const fs::path& path, size_t bytes) {
+    std::ofstream(path) << std::string(bytes, 'x');
+}
+
+} // namespace
+
+TEST(SessionLogCleanerTest, ParseOwner) {
+    pid_t pid = 0;
+    EXPECT_TRUE(SessionLogCleaner::parse_owner("session_1234_94823749823.log", pid));
+    EXPECT_EQ(pid, 1234);
+    EXPECT_FALSE(SessionLogCleaner::parse_owner("session_1234.log", pid));
+    EXPECT_FALSE(SessionLogCleaner::parse_owner("session_ab_1.log", pid));
+    EXPECT_FALSE(SessionLogCleaner::parse_owner("session_1_2.log.bak", pid));
+    EXPECT_FALSE(SessionLogCleaner::parse_owner("notes.log", pid));
+}
+
+TEST(SessionLogCleanerTest, RemovesOnlyLogsOfDeadProcesses) {
+    const fs::path dir = fs::temp_directory_path() / ("colabb_session_logs_" + std::to_string(std::rand()));
+    fs::create_directories(dir);
+
+    // A pid that is certainly gone: a reaped child
+    const pid_t dead = fork();
+    if (dead == 0) _exit(0);
+    waitpid(dead, nullptr, 0);
+
+    // A live process running the same program, standing in for another instance
+    const pid_t live = fork();
+    if (live == 0) {
+        pause();
+        _exit(0);
+    }
+
+    touch(dir / ("session_" + std::to_string(dead) + "_1.log"), 1000);
+    touch(dir / ("session_" + std::to_string(getpid()) + "_2.log"), 500); // reused pid
+    touch(dir / ("session_" + std::to_string(live) + "_3.log"), 10);
+    touch(dir / "settings.json", 10);
+
+    EXPECT_EQ(SessionLogCleaner(dir.string()).remove_orphans(), 1500u);
+    EXPECT_TRUE(fs::exists(dir / ("session_" + std::to_string(live) + "_3.log")));
+    EXPECT_TRUE(fs::exists(dir / "settings.json"));
+    EXPECT_EQ(std::distance(fs::directory_iterator(dir), fs::directory_iterator()), 2);
+
+    kill(live, SIGKILL);
+    waitpid(live, nullptr, 0);
+    fs::remove_all(dir);
+}
@@ -2,6 +2,9 @@
 #include "application/suggestion_cache.hpp"
 #include <thread>
 #include <chrono>
+#include <list>
+#include <unordered_map>
+#include <vector>
 
 using namespace colabb::application;
 using namespace colabb::domain;
@@ -86,3 +89,165 @@ TEST_F(SuggestionCacheTest, LRUEviction) {
     auto result1 = cache_.get("key1");
     ASSERT_TRUE(result1.has_value());
 }
+
+TEST_F(SuggestionCacheTest, FrequentEntriesSurviveScan) {
+    SuggestionCache cache(10);
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 5; ++i) {
+            cache.put("hot" + std::to_string(i), Suggestion{"cmd"});
+            cache.get("hot" + std::to_string(i));
+        }
+    }
+
+    // A burst of one-off queries larger than the whole cache
+    for (int i = 0; i < 50; ++i) {
+        cache.put("scan" + std::to_string(i), Suggestion{"cmd"});
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_TRUE(cache.get("hot" + std::to_string(i)).has_value()) << "hot" << i;
+    }
+    EXPECT_GT(cache.stats().rejected_admissions, 0u);
+}
+
+// Replays a recorded-style trace (hot working set interleaved with scans) and
+// compares the hit rate with a plain LRU of the same capacity.
+TEST_F(SuggestionCacheTest, HitRateBeatsLruOnScanTrace) {
+    constexpr size_t kCapacity = 50;
+    std::vector<std::string> trace;
+    int scan_id = 0;
+    for (int round = 0; round < 40; ++round) {
+        for (int i = 0; i < 30; ++i) {
+            trace.push_back("hot" + std::to_string(i));
+        }
+        for (int i = 0; i < 60; ++i) {
+            trace.push_back("scan" + std::to_string(scan_id++));
+        }
+    }
+
+    SuggestionCache cache(kCapacity);
+    for (const auto& q : trace) {
+        if (!cache.get(q)) {
+            cache.put(q, Suggestion{"cmd"});
+        }
+    }
+
+    // Reference LRU
+    std::list<std::string> lru;
+    std::unordered_map<std::string, std::list<std::string>::iterator> index;
+    size_t lru_hits = 0;
+    for (const auto& q : trace) {
+        auto it = index.find(q);
+        if (it != index.end()) {
+            ++lru_hits;
+            lru.splice(lru.begin(), lru, it->second);
+            continue;
+        }
+        lru.push_front(q);
+        index[q] = lru.begin();
+        if (lru.size() > kCapacity) {
+            index.erase(lru.back());
+            lru.pop_back();
+        }
+    }
+    const double lru_rate = static_cast<double>(lru_hits) / trace.size();
+
+    EXPECT_GT(cache.stats().hit_rate(), lru_rate);
+    EXPECT_GT(cache.stats().hit_rate(), 0.25);
+}
+
+TEST_F(SuggestionCacheTest, StaleWhileRevalidate) {
+    SuggestionCache cache(10, std::chrono::milliseconds(20), std::chrono::milliseconds(500));
+    cache.put("list files", Suggestion{"ls -la"});
+
+    auto fresh = cache.lookup("list files");
+    ASSERT_TRUE(fresh.has_value());
+    EXPECT_FALSE(fresh->stale);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+
+    // Past the fresh window: get() misses but lookup() still serves it as stale
+    EXPECT_FALSE(cache.get("list files").has_value());
+    auto stale = cache.lookup("list files");
+    ASSERT_TRUE(stale.has_value());
+    EXPECT_TRUE(stale->stale);
+    EXPECT_TRUE(stale->needs_revalidation);
+    EXPECT_EQ(stale->suggestion.command, "ls -la");
+
+    // Only the first stale hit asks for a refresh
+    auto again = cache.lookup("list files");
+    ASSERT_TRUE(again.has_value());
+    EXPECT_FALSE(again->needs_revalidation);
+
+    // Refresh lands: entry is fresh again
+    cache.put("list files", Suggestion{"ls -lah"});
+    auto refreshed = cache.lookup("list files");
+    ASSERT_TRUE(refreshed.has_value());
+    EXPECT_FALSE(refreshed->stale);
+    EXPECT_EQ(refreshed->suggestion.command, "ls -lah");
+}
+
+TEST_F(SuggestionCacheTest, FailedRevalidationIsRetried) {
+    SuggestionCache cache(10, std::chrono::milliseconds(10), std::chrono::milliseconds(500));
+    cache.put("list files", Suggestion{"ls -la"});
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    ASSERT_TRUE(cache.lookup("list files")->needs_revalidation);
+    EXPECT_FALSE(cache.lookup("list files")->needs_revalidation);
+
+    // The refresh failed: the next stale hit asks again, once
+    cache.abandon_revalidation("list files");
+    EXPECT_TRUE(cache.lookup("list files")->needs_revalidation);
+    EXPECT_FALSE(cache.lookup("list files")->needs_revalidation);
+}
+
+TEST_F(SuggestionCacheTest, ExpiresAfterStaleWindow) {
+    SuggestionCache cache(10, std::chrono::milliseconds(10), std::chrono::milliseconds(10));
+    cache.put("key", Suggestion{"cmd"});
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    EXPECT_FALSE(cache.lookup("key").has_value());
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST_F(SuggestionCacheTest, NegativeEntriesUseSeparateTtls) {
+    SuggestionCache cache(10);
+    cache.set_negative_ttls(std::chrono::milliseconds(500), std::chrono::milliseconds(20));
+
+    cache.put_negative("no answer", SuggestionCache::NegativeKind::EmptyAnswer);
+    cache.put_negative("Provider Down", SuggestionCache::NegativeKind::TransportFailure);
+
+    EXPECT_EQ(cache.get_negative("no answer"), SuggestionCache::NegativeKind::EmptyAnswer);
+    EXPECT_EQ(cache.get_negative("provider down"), SuggestionCache::NegativeKind::TransportFailure);
+    EXPECT_FALSE(cache.get("no answer").has_value());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+
+    // Failures expire quickly so the provider is retried soon
+    EXPECT_FALSE(cache.get_negative("provider down").has_value());
+    EXPECT_TRUE(cache.get_negative("no answer").has_value());
+}
+
+TEST_F(SuggestionCacheTest, PositiveAnswerClearsNegativeEntry) {
+    cache_.put_negative("key", SuggestionCache::NegativeKind::TransportFailure);
+    cache_.put("key", Suggestion{"cmd"});
+    EXPECT_FALSE(cache_.get_negative("key").has_value());
+    EXPECT_TRUE(cache_.get("key").has_value());
+}
+
+TEST_F(SuggestionCacheTest, ByteBudgetBoundsFootprint) {
+    SuggestionCache cache(100);
+    for (int i = 0; i < 50; ++i) {
+        cache.put("key" + std::to_string(i), Suggestion{std::string(200, 'x')});
+    }
+    const size_t full = cache.memory_usage();
+    EXPECT_GT(full, 50u * 200u);
+
+    cache.set_max_bytes(full / 2);
+    EXPECT_LE(cache.memory_usage(), full / 2);
+    EXPECT_LT(cache.size(), 50u);
+
+    size_t freed = cache.trim_to(0);
+    EXPECT_GT(freed, 0u);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.memory_usage(), 0u);
+}
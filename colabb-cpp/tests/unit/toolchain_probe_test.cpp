@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "infrastructure/context/toolchain_probe.hpp"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+using namespace colabb::infrastructure;
+
+class ToolchainProbeTest : public ::testing::Test {
+protected:
+    std::string temp_dir_;
+
+    void SetUp() override {
+        temp_dir_ = "/tmp/colabb_test_toolchain_" + std::to_string(std::rand());
+        fs::create_directories(temp_dir_);
+    }
+
+    void TearDown() override {
+        fs::remove_all(temp_dir_);
+    }
+
+    void create_file(const std::string& name, const std::string& content) {
+        fs::create_directories(fs::path(temp_dir_ + "/" + name).parent_path());
+        std::ofstream f(temp_dir_ + "/" + name);
+        f << content;
+    }
+
+    static std::string find(const std::vector<ToolchainProbe::Entry>& entries, const std::string& tool) {
+        for (const auto& [name, version] : entries) {
+            if (name == tool) return version;
+        }
+        return "";
+    }
+};
+
+TEST_F(ToolchainProbeTest, Parsers) {
+    EXPECT_EQ(ToolchainProbe::parse_rust_toolchain("[toolchain]\nchannel = \"1.76.0\"\n"), "1.76.0");
+    EXPECT_EQ(ToolchainProbe::parse_rust_toolchain("nightly-2024-01-01\n"), "nightly-2024-01-01");
+    EXPECT_EQ(ToolchainProbe::parse_pyvenv_version("home = /usr/bin\nversion = 3.11.4\n"), "3.11.4");
+    EXPECT_EQ(ToolchainProbe::parse_pyvenv_version("version_info = 3.10.2.final.0\n"), "3.10.2");
+    EXPECT_EQ(ToolchainProbe::parse_go_version("module x\n\ngo 1.21\n"), "1.21");
+    EXPECT_EQ(ToolchainProbe::parse_go_version("module x\ngo 1.21\ntoolchain go1.22.1\n"), "1.22.1");
+}
+
+TEST_F(ToolchainProbeTest, NearestVersionFilesUpToRoot) {
+    create_file(".nvmrc", "20\n");
+    create_file(".python-version", "3.12.1\n");
+    create_file("svc/.venv/pyvenv.cfg", "version = 3.11.4\n");
+    create_file("svc/api/rust-toolchain.toml", "[toolchain]\nchannel = \"stable\"\n");
+
+    ToolchainProbe probe;
+    probe.set_process_probes_enabled(false);
+    bool pending = true;
+    auto entries = probe.probe(temp_dir_ + "/svc/api", temp_dir_, {}, &pending);
+
+    EXPECT_FALSE(pending);
+    EXPECT_EQ(find(entries, "Python"), "3.11.4 (venv .venv)"); // the venv beats .python-version
+    EXPECT_EQ(find(entries, "Node"), "20");
+    EXPECT_EQ(find(entries, "Rust"), "stable");
+
+    // Outside the project root nothing is inherited
+    EXPECT_TRUE(probe.probe(temp_dir_ + "/svc/api", temp_dir_ + "/svc/api", {}).size() == 1);
+}
+
+TEST_F(ToolchainProbeTest, RereadsWhenMtimeChanges) {
+    create_file(".nvmrc", "18\n");
+    ToolchainProbe probe;
+    probe.set_process_probes_enabled(false);
+    EXPECT_EQ(find(probe.probe(temp_dir_, "", {}), "Node"), "18");
+
+    create_file(".nvmrc", "20\n");
+    fs::last_write_time(temp_dir_ + "/.nvmrc", fs::last_write_time(temp_dir_ + "/.nvmrc") + std::chrono::seconds(1));
+    EXPECT_EQ(find(probe.probe(temp_dir_, "", {}), "Node"), "20");
+}
+
+TEST_F(ToolchainProbeTest, ProcessProbeRunsInBackground) {
+    // A fake compiler so the test does not depend on the host toolchain
+    create_file("bin/fakecc", "#!/bin/sh\necho 'fakecc 9.9'\n");
+    fs::permissions(temp_dir_ + "/bin/fakecc", fs::perms::owner_all);
+    setenv("CXX", (temp_dir_ + "/bin/fakecc").c_str(), 1);
+
+    std::atomic<int> ready{0};
+    ToolchainProbe probe([&ready] { ++ready; });
+    bool pending = false;
+    auto first = probe.probe(temp_dir_, "", {"C/C++"}, &pending);
+    EXPECT_TRUE(pending);
+    EXPECT_EQ(find(first, "Compiler"), "");
+
+    for (int i = 0; i < 400 && ready == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(ready, 1);
+    auto second = probe.probe(temp_dir_, "", {"C/C++"}, &pending);
+    EXPECT_FALSE(pending);
+    EXPECT_EQ(find(second, "Compiler"), "fakecc 9.9");
+    unsetenv("CXX");
+}
+
+TEST_F(ToolchainProbeTest, CompilerWithArgumentsAndQuoteInPath) {
+    // Neither a quote in the path nor arguments in $CXX go through a shell
+    create_file("it's/fakecc", "#!/bin/sh\necho \"fakecc 1.0 $*\"\n");
+    fs::permissions(temp_dir_ + "/it's/fakecc", fs::perms::owner_all);
+    setenv("CXX", (temp_dir_ + "/it's/fakecc -m32").c_str(), 1);
+
+    std::atomic<int> ready{0};
+    ToolchainProbe probe([&ready] { ++ready; });
+    probe.probe(temp_dir_, "", {"C/C++"});
+    for (int i = 0; i < 400 && ready == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(ready, 1);
+    EXPECT_EQ(find(probe.probe(temp_dir_, "", {"C/C++"}), "Compiler"), "fakecc 1.0 -m32 --version");
+    unsetenv("CXX");
+}
+
+TEST_F(ToolchainProbeTest, FailedProbeIsRetried) {
+    // Fails until the flag file exists; the binary itself never changes
+    create_file("bin/flakycc", "#!/bin/sh\n[ -e \"" + temp_dir_ + "/ok\" ] || exit 1\necho 'flakycc 2.0'\n");
+    fs::permissions(temp_dir_ + "/bin/flakycc", fs::perms::owner_all);
+    setenv("CXX", (temp_dir_ + "/bin/flakycc").c_str(), 1);
+
+    std::atomic<int> ready{0};
+    ToolchainProbe probe([&ready] { ++ready; });
+    probe.set_failed_probe_retry(std::chrono::milliseconds(50));
+    auto wait_ready = [&ready](int count) {
+        for (int i = 0; i < 400 && ready < count; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return ready >= count;
+    };
+
+    probe.probe(temp_dir_, "", {"C/C++"});
+    ASSERT_TRUE(wait_ready(1));
+    EXPECT_EQ(find(probe.probe(temp_dir_, "", {"C/C++"}), "Compiler"), "");
+
+    create_file("ok", "");
+    std::this_thread::sleep_for(std::chrono::milliseconds(80));
+    bool pending = false;
+    probe.probe(temp_dir_, "", {"C/C++"}, &pending);
+    EXPECT_TRUE(pending);
+    ASSERT_TRUE(wait_ready(2));
+    EXPECT_EQ(find(probe.probe(temp_dir_, "", {"C/C++"}), "Compiler"), "flakycc 2.0");
+    unsetenv("CXX");
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "infrastructure/terminal/scrollback_indexer.hpp"
+#include "infrastructure/terminal/trigram_index.hpp"
+
+using colabb::infrastructure::ScrollbackIndexer;
+using colabb::infrastructure::TrigramIndex;
+
+namespace {
+
+using Literals = std::vector<std::string>;
+
+// One ~32 KiB segment per call, all lines numbered from first_line
+std::string segment_text(int segment) {
+    std::string text;
+    for (int i = 0; text.size() < TrigramIndex::kSegmentBytes; ++i) {
+        text += "[" + std::to_string(segment) + "." + std::to_string(i) + "] compiling unit_" +
+                std::to_string(segment) + "_" + std::to_string(i % 50) + ".o\n";
+    }
+    return text;
+}
+
+std::uint64_t count_lines(const std::string& text) {
+    return static_cast<std::uint64_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+bool covers(const std::vector<TrigramIndex::LineRange>& ranges, std::uint64_t line) {
+    return std::any_of(ranges.begin(), ranges.end(), [line](const TrigramIndex::LineRange& range) {
+        return range.begin <= line && line < range.end;
+    });
+}
+
+} // namespace
+
+TEST(TrigramIndexTest, NarrowsToSegmentsHoldingTheLiteral) {
+    TrigramIndex index;
+    std::uint64_t line = 0;
+    std::uint64_t needle_line = 0;
+    for (int segment = 0; segment < 40; ++segment) {
+        std::string text = segment_text(segment);
+        if (segment == 17) {
+            needle_line = line + count_lines(text);
+            text += "Segmentation fault (core dumped)\n";
+        }
+        index.add(text, line);
+        line += count_lines(text);
+    }
+    EXPECT_EQ(index.indexed_end(), line);
+    EXPECT_GE(index.segment_count(), 39u);
+    EXPECT_LT(index.memory_bytes(), 40 * TrigramIndex::kSegmentBytes / 4);
+
+    const auto ranges = index.candidates({"segmentation FAULT"});
+    EXPECT_TRUE(covers(ranges, needle_line));
+    EXPECT_TRUE(covers(ranges, line)); // lines not indexed yet
+    std::uint64_t candidate_lines = 0;
+    for (const auto& range : ranges) {
+        if (range.end != UINT64_MAX) candidate_lines += range.end - range.begin;
+    }
+    EXPECT_LT(candidate_lines, line / 4);
+
+    // Nothing to narrow on
+    const auto all = index.candidates({});
+    ASSERT_EQ(all.size(), 1u);
+    EXPECT_EQ(all[0].begin, 0u);
+    EXPECT_EQ(all[0].end, UINT64_MAX);
+}
+
+TEST(TrigramIndexTest, NeverLosesAMatchingLine) {
+    TrigramIndex index;
+    std::vector<std::string> lines;
+    std::uint64_t first = 0;
+    for (int segment = 0; segment < 12; ++segment) {
+        const std::string text = segment_text(segment);
+        index.add(text, first);
+        first += count_lines(text);
+        for (size_t pos = 0; pos < text.size();) {
+            const size_t end = text.find('\n', pos);
+            lines.push_back(text.substr(pos, end - pos));
+            pos = end + 1;
+        }
+    }
+    for (const std::string query : {"unit_7_4", "[3.1", "UNIT_11_49.o", "ing unit_0_"}) {
+        const auto ranges = index.candidates({query});
+        std::string folded_query = query;
+        std::transform(folded_query.begin(), folded_query.end(), folded_query.begin(), ::tolower);
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (lines[i].find(folded_query) != std::string::npos) {
+                ASSERT_TRUE(covers(ranges, i)) << query << " at line " << i;
+            }
+        }
+    }
+}
+
+TEST(TrigramIndexTest, ClearVoidsJobsFromThePreviousSession) {
+    TrigramIndex index;
+    const std::uint64_t old_generation = index.generation();
+    index.add("old session output\n", 0);
+    index.clear();
+    index.add("stale job\n", 1, old_generation);
+    EXPECT_EQ(index.indexed_end(), 0u);
+
+    index.add("new session output\n", 0);
+    EXPECT_EQ(index.indexed_end(), 1u);
+}
+
+TEST(TrigramIndexTest, OldLinesBeyondTheBudgetStayCandidates) {
+    TrigramIndex index(1024); // room for a handful of (small) segment filters
+    std::uint64_t line = 0;
+    for (int segment = 0; segment < 20; ++segment) {
+        const std::string text = segment_text(segment);
+        index.add(text, line);
+        line += count_lines(text);
+        ASSERT_LE(index.memory_bytes(), 1024u + 8192u); // plus the open segment's filter
+    }
+    const auto ranges = index.candidates({"no such text anywhere"});
+    ASSERT_FALSE(ranges.empty());
+    EXPECT_EQ(ranges.front().begin, 0u);
+    EXPECT_GT(ranges.front().end, 0u); // the unindexed head
+
+    index.drop_before(line - 10);
+    const auto after = index.candidates({"no such text anywhere"});
+    EXPECT_GE(after.front().end, ranges.front().end);
+}
+
+TEST(TrigramIndexTest, RequiredLiteralsOfPatterns) {
+    EXPECT_EQ(TrigramIndex::required_literals("Segmentation fault", false, true), Literals{"Segmentation fault"});
+    EXPECT_EQ(TrigramIndex::required_literals("ab", false, true), Literals{});
+    EXPECT_EQ(TrigramIndex::required_literals("error: .* not found", true, true),
+              (Literals{"error: ", " not found"}));
+    EXPECT_EQ(TrigramIndex::required_literals("colou?r", true, true), Literals{"colo"});
+    EXPECT_EQ(TrigramIndex::required_literals("\\bfatal\\b", true, true), Literals{"fatal"});
+    EXPECT_EQ(TrigramIndex::required_literals("[0-9]+ errors?", true, true), Literals{" error"});
+    EXPECT_EQ(TrigramIndex::required_literals("(abc)?defg", true, true), Literals{"defg"});
+    EXPECT_EQ(TrigramIndex::required_literals("a{0,3}bcd", true, true), Literals{"bcd"});
+    EXPECT_EQ(TrigramIndex::required_literals("main\\.cpp", true, true), Literals{"main.cpp"});
+    EXPECT_EQ(TrigramIndex::required_literals("\\x{41}BCD", true, true), Literals{"BCD"});
+    EXPECT_EQ(TrigramIndex::required_literals("\\x41BCD", true, true), Literals{"BCD"});
+    EXPECT_EQ(TrigramIndex::required_literals("\\Qa.b*c\\E", true, true), Literals{"a.b*c"});
+    EXPECT_EQ(TrigramIndex::required_literals("(\\w+)=\\1abc", true, true), Literals{"abc"});
+    EXPECT_EQ(TrigramIndex::required_literals("warning|error", true, true), Literals{});
+    // Caseless matching folds more than ASCII: stop at non-ASCII bytes
+    EXPECT_EQ(TrigramIndex::required_literals("año xyz", false, false), Literals{"o xyz"});
+    EXPECT_EQ(TrigramIndex::required_literals("año xyz", false, true), Literals{"año xyz"});
+}
+
+TEST(ScrollbackIndexerTest, IndexesInTheBackground) {
+    ScrollbackIndexer indexer;
+    auto index = std::make_shared<TrigramIndex>();
+    std::uint64_t line = 0;
+    for (int segment = 0; segment < 8; ++segment) {
+        std::string text = segment_text(segment);
+        indexer.submit(index, text, line);
+        line += count_lines(text);
+    }
+    indexer.submit(index, "make: *** [all] Error 2\n", line);
+    indexer.wait_idle();
+    EXPECT_EQ(index->indexed_end(), line + 1);
+    EXPECT_TRUE(covers(index->candidates({"Error 2"}), line));
+
+    // A closed tab's index outlives its queued jobs
+    auto orphan = std::make_shared<TrigramIndex>();
+    indexer.submit(orphan, segment_text(0), 0);
+    orphan.reset();
+    indexer.wait_idle();
+}